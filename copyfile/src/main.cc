@@ -16,7 +16,6 @@
 #include <iostream>
 
 #include "usages.h"
-#include "copyfile.h"
 
 int main(const int argc, const char* argv[]) {
   try {
@@ -12,6 +12,10 @@
  * Referencias:
  * Enlaces de interés
  */
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <libgen.h>
 #include <filesystem>
@@ -20,8 +24,306 @@
 #include <sstream>
 #include <exception>
 
+#include "batch_copy.h"
+#include "compare.h"
+#include "fanout.h"
+#include "copy_service.h"
+#include "pack.h"
+#include "resume.h"
+#include "scope_exit.h"
+#include "throttle.h"
+#include "watch.h"
 #include "usages.h"
-#include "copyfile.h"
+
+namespace {
+
+// Copia en curso, para poder cancelarla desde el manejador de SIGINT y SIGTERM
+const CopyHandle* current_copy = nullptr;
+
+// Comparación, copia a varios destinos o copia con "-" en curso, para poder cancelarla desde el
+// manejador de SIGINT y SIGTERM
+CopyProgress* current_progress = nullptr;
+
+// Vigilancia en curso, para poder pararla desde el manejador de SIGINT y SIGTERM
+TreeWatcher* current_watcher = nullptr;
+
+/**
+ * @brief Manejador de SIGINT y SIGTERM: cancela la copia en curso, que borra el destino a medias
+ *        (o, con --resume, lo deja junto a su diario para reanudarla), la copia de --fanout o con
+ *        "-", la comparación de --compare o la vigilancia de --watch.
+ */
+void CancelCopy(int) {
+  if (current_copy != nullptr) current_copy->Cancel();
+  if (current_progress != nullptr) current_progress->is_cancelled = true;
+  if (current_watcher != nullptr) current_watcher->Stop();
+}
+
+/**
+ * @brief Imprime los errores de los archivos que no se han podido copiar.
+ * @param errors Ruta de cada archivo y su error.
+ * @throw std::runtime_error Si hay algún error.
+ */
+void ReportErrors(const std::vector<std::pair<std::string, std::exception_ptr>>& errors) {
+  for (const auto& [path, error] : errors) {
+    try {
+      std::rethrow_exception(error);
+    } catch (const std::exception& exception) {
+      std::cerr << path << ": ";
+      PrintException(exception);
+    }
+  }
+  if (!errors.empty()) throw std::runtime_error(std::to_string(errors.size()) + " files could not be copied");
+}
+
+/**
+ * @brief Muestra la velocidad media conseguida con --bwlimit.
+ * @param rate_limiter Limitador de las copias (si es nulo no se muestra nada).
+ */
+void ReportRate(const std::shared_ptr<RateLimiter>& rate_limiter) {
+  if (rate_limiter == nullptr) return;
+  std::cout << "Average rate: " << FormatRate(rate_limiter->GetAchievedRate()) << " (limit "
+            << FormatRate(rate_limiter->GetRate()) << ")\n";
+}
+
+/**
+ * @brief Copia o mueve un solo archivo. SIGINT y SIGTERM cancelan la copia.
+ * @param request Copia a realizar.
+ */
+void RunSingleCopy(const CopyRequest& request) {
+  // La copia se hace en un hilo de fastcopy; este hilo solo espera y atiende las señales
+  CopyService copy_service(1, 1);
+  CopyHandle copy = copy_service.Submit(request);
+  current_copy = &copy;
+  auto forget_copy = ScopeExit([] {
+    current_copy = nullptr;
+  });
+  struct sigaction action{};
+  action.sa_handler = CancelCopy;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  copy.Wait();
+  ReportRate(request.rate_limiter);
+}
+
+/**
+ * @brief Mueve varios archivos a un directorio.
+ * @param sources Rutas de origen.
+ * @param dst_path Directorio de destino.
+ * @param options Límite de velocidad y prioridad de E/S (lo demás no se usa al mover).
+ */
+void RunBatchMove(const std::vector<std::string>& sources, const std::string& dst_path,
+                  const BatchCopyOptions& options) {
+  CopyPlan plan = PlanCopy(sources, dst_path, false);
+  CopyService copy_service;
+  std::vector<CopyHandle> moves;
+  for (const auto& file : plan.files) {
+    moves.push_back(copy_service.Submit(CopyRequest{ file.source_path, file.destination_path, CopyOperation::kMove,
+                                                     true, 0, options.rate_limiter, options.io_priority }));
+  }
+  std::vector<std::pair<std::string, std::exception_ptr>> errors;
+  for (const auto& move : moves) {
+    try {
+      move.Wait();
+    } catch (...) {
+      errors.emplace_back(move.GetRequest().source_path, std::current_exception());
+    }
+  }
+  ReportRate(options.rate_limiter);
+  ReportErrors(errors);
+}
+
+/**
+ * @brief Copia varios archivos, o directorios enteros con -r, y muestra cuánto se ha ahorrado
+ *        deduplicando.
+ * @param sources Rutas de origen.
+ * @param dst_path Ruta de destino (un directorio si hay varios orígenes).
+ * @param recursive Si se copian los directorios.
+ * @param options Opciones de la copia.
+ * @param jobs Número máximo de copias a la vez.
+ */
+void RunBatchCopy(const std::vector<std::string>& sources, const std::string& dst_path, bool recursive,
+                  const BatchCopyOptions& options, size_t jobs) {
+  CopyPlan plan = PlanCopy(sources, dst_path, recursive);
+  CopyService copy_service(jobs, jobs + 1);
+  BatchCopyStats stats = RunCopyPlan(plan, options, copy_service);
+  if (options.dedup != DedupMode::kNone) {
+    std::cout << stats.files << " files, " << stats.bytes_copied << " bytes copied, " << stats.bytes_saved
+              << " bytes saved (" << stats.hardlinks << " hardlinks, " << stats.reflinks << " reflinks)\n";
+  }
+  ReportRate(options.rate_limiter);
+  ReportErrors(stats.errors);
+}
+
+/**
+ * @brief Empaqueta un directorio en la salida estándar o desempaqueta la entrada estándar en él.
+ * @param path Directorio a empaquetar o de destino.
+ * @param pack true para empaquetar, false para desempaquetar.
+ */
+void RunPack(const std::string& path, bool pack) {
+  if (!pack) {
+    UnpackTree(STDIN_FILENO, path);
+    return;
+  }
+  if (isatty(STDOUT_FILENO)) throw std::runtime_error("Refusing to write a pack stream to a terminal");
+  PackStats stats = PackTree(path, STDOUT_FILENO);
+  if (stats.changed_files > 0) {
+    std::cerr << "WARNING: " << stats.changed_files << " files shrank while being packed (padded with zeros)\n";
+  }
+}
+
+/**
+ * @brief Copia desde la entrada estándar o hacia la salida estándar ("-"). SIGINT y SIGTERM
+ *        cancelan la copia y borran el destino si es un archivo.
+ * @param src_path Origen o "-".
+ * @param dst_path Destino o "-".
+ * @param rate_limiter Límite de velocidad (puede ser nulo).
+ */
+void RunStreamCopy(const std::string& src_path, const std::string& dst_path,
+                   const std::shared_ptr<RateLimiter>& rate_limiter) {
+  CopyProgress progress;
+  progress.rate_limiter = rate_limiter.get();
+  current_progress = &progress;
+  auto forget_progress = ScopeExit([] {
+    current_progress = nullptr;
+  });
+  struct sigaction action{};
+  action.sa_handler = CancelCopy;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  CopyStream(src_path, dst_path, nullptr, &progress);
+  // La salida estándar puede ser la propia copia, así que la velocidad se muestra en la de error
+  if (rate_limiter != nullptr) {
+    std::cerr << "Average rate: " << FormatRate(rate_limiter->GetAchievedRate()) << " (limit "
+              << FormatRate(rate_limiter->GetRate()) << ")\n";
+  }
+}
+
+/**
+ * @brief Copia un archivo a varios destinos leyéndolo una sola vez. SIGINT y SIGTERM cancelan
+ *        la copia y borran todos los destinos.
+ * @param src_path Archivo de origen.
+ * @param dst_paths Destinos.
+ * @param copy_attributes Si se copian los atributos del origen.
+ * @param rate_limiter Límite de velocidad de la lectura (puede ser nulo).
+ * @throw std::runtime_error Si algún destino no se ha podido copiar.
+ */
+void RunFanout(const std::string& src_path, const std::vector<std::string>& dst_paths, bool copy_attributes,
+               const std::shared_ptr<RateLimiter>& rate_limiter) {
+  CopyProgress progress;
+  progress.rate_limiter = rate_limiter.get();
+  current_progress = &progress;
+  auto forget_progress = ScopeExit([] {
+    current_progress = nullptr;
+  });
+  struct sigaction action{};
+  action.sa_handler = CancelCopy;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  FanoutStats stats = CopyToMany(src_path, dst_paths, copy_attributes, &progress);
+  ReportRate(rate_limiter);
+  ReportErrors(stats.errors);
+}
+
+/**
+ * @brief Compara dos archivos, o dos árboles con -r, y muestra cada diferencia y la velocidad.
+ *        SIGINT y SIGTERM cancelan la comparación.
+ * @param first_path Primer archivo o directorio.
+ * @param second_path Segundo archivo o directorio.
+ * @param recursive Si se comparan directorios.
+ * @param jobs Número de archivos que se comparan a la vez.
+ * @throw std::runtime_error Si alguna ruta no se ha podido comparar. Si son distintos sale con EXIT_FAILURE.
+ */
+void RunCompare(const std::string& first_path, const std::string& second_path, bool recursive, size_t jobs) {
+  CopyProgress progress;
+  current_progress = &progress;
+  auto forget_progress = ScopeExit([] {
+    current_progress = nullptr;
+  });
+  struct sigaction action{};
+  action.sa_handler = CancelCopy;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  auto start = std::chrono::steady_clock::now();
+  CompareStats stats = ComparePaths(first_path, second_path, recursive, jobs, &progress);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  for (const auto& result : stats.differences) {
+    switch (result.difference) {
+      case Difference::kContents:
+        std::cout << result.first_path << " " << result.second_path << " differ at offset "
+                  << result.difference_offset << "\n";
+        break;
+      case Difference::kLength:
+        std::cout << result.first_path << " " << result.second_path << " differ at offset "
+                  << result.difference_offset << " (end of the shorter file)\n";
+        break;
+      case Difference::kType:
+        std::cout << result.first_path << " " << result.second_path << " are not the same type of file\n";
+        break;
+      case Difference::kSymlinkTarget:
+        std::cout << result.first_path << " " << result.second_path << " point to different targets\n";
+        break;
+      case Difference::kOnlyInFirst:
+        std::cout << "Only in " << first_path << ": " << result.first_path << "\n";
+        break;
+      case Difference::kOnlyInSecond:
+        std::cout << "Only in " << second_path << ": " << result.second_path << "\n";
+        break;
+      case Difference::kNone:
+        break;
+    }
+  }
+  double seconds = std::max(elapsed.count(), 1e-9);
+  std::cout << stats.files << " files compared, " << stats.differences.size() << " differences, "
+            << stats.bytes_read << " bytes read in " << elapsed.count() << " s ("
+            << FormatRate(stats.bytes_read / seconds) << ")\n";
+  if (!stats.errors.empty()) {
+    for (const auto& [path, error] : stats.errors) {
+      try {
+        std::rethrow_exception(error);
+      } catch (const std::exception& exception) {
+        std::cerr << path << ": ";
+        PrintException(exception);
+      }
+    }
+    throw std::runtime_error(std::to_string(stats.errors.size()) + " files could not be compared");
+  }
+  // Como cmp y diff, el estado de salida indica si son distintos
+  if (!stats.differences.empty()) exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Mantiene un directorio igual que otro hasta recibir SIGINT o SIGTERM, y al terminar
+ *        muestra cuántos cambios se han copiado y con qué latencia.
+ * @param src_path Directorio de origen.
+ * @param dst_path Directorio de destino.
+ */
+void RunWatch(const std::string& src_path, const std::string& dst_path) {
+  TreeWatcher watcher(src_path, dst_path, kDefaultSettleTime, [](const std::string& path, std::exception_ptr error) {
+    try {
+      std::rethrow_exception(error);
+    } catch (const std::exception& exception) {
+      std::cerr << path << ": ";
+      PrintException(exception);
+    }
+  });
+  current_watcher = &watcher;
+  auto forget_watcher = ScopeExit([] {
+    current_watcher = nullptr;
+  });
+  struct sigaction action{};
+  action.sa_handler = CancelCopy;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  watcher.Run();
+  const WatchStats& stats = watcher.GetStats();
+  std::cout << stats.events << " events, " << stats.copies << " files copied, " << stats.removals << " removed, "
+            << stats.rescans << " rescans (" << stats.overflows << " queue overflows), " << stats.errors << " errors\n";
+  std::cout << "Event to copy latency (ms): p50 " << stats.LatencyPercentile(50) << ", p90 "
+            << stats.LatencyPercentile(90) << ", p99 " << stats.LatencyPercentile(99) << ", max "
+            << stats.LatencyPercentile(100) << "\n";
+}
+
+}  // namespace
 
 /**
  * @brief Imprime el uso del programa
@@ -33,16 +335,35 @@ void Usage(const int argc, const char* argv[]) {
   try {
     if (args.size() > 1 && (args[1] == "--help" || args[1] == "-h")) {
       std::cout << "      -- Copyfile --" << std::endl;
-      std::cout << "HOW TO USE: " << args[0] << "[src] [dst]\n\n";
-      std::cout << "[src]: The file to be copied\n";
-      std::cout << "[dst]: The destination file where the file will be copied\n";
+      std::cout << "HOW TO USE: " << args[0] << " [src]... [dst]\n\n";
+      std::cout << "[src]: The files (or directories, with -r) to be copied\n";
+      std::cout << "[dst]: The destination file, or the directory if there are several sources\n";
+      std::cout << "A single [src] or [dst] can be - for the standard input or output (use ./- for\n";
+      std::cout << "a file named -), e.g. producer | " << args[0] << " - out.bin\n";
       std::cout << "\nPARAMETERS\n\n";
       std::cout << "-h: Shows this message\n";
       std::cout << "-m: Move the file instead of copying it\n";
-      std::cout << "-a: Copy the attributes of the original file\n\n";
+      std::cout << "-a: Copy the attributes of the original file and keep hardlinks\n";
+      std::cout << "-r: Copy directories recursively\n";
+      std::cout << "--dedup[=reflink|hardlink]: Copy identical files once and reflink (default)\n";
+      std::cout << "                            or hardlink the rest\n";
+      std::cout << "-j N: Copy at most N files at the same time (4 by default)\n";
+      std::cout << "--order=disk|input: Copy in disk order (default) or in the given order\n";
+      std::cout << "--resume[=N]: Keep a journal next to each destination and save a checkpoint\n";
+      std::cout << "              every N MiB (64 by default); if the copy is interrupted, running\n";
+      std::cout << "              it again continues from the last checkpoint\n";
+      std::cout << "--bwlimit=RATE: Copy at most RATE bytes per second in total (K, M and G suffixes)\n";
+      std::cout << "--ionice=idle|best-effort:N: I/O priority of the copies (N from 0 to 7)\n";
+      std::cout << "--fanout [src] [dst]...: Copy the file [src] to every [dst], reading it only once\n";
+      std::cout << "--compare [first] [second]: Check whether two files (or directories, with -r)\n";
+      std::cout << "                            are identical and show where they differ\n";
+      std::cout << "--watch [src] [dst]: Keep [dst] equal to the directory [src], copying changes as\n";
+      std::cout << "                    they happen, until Ctrl+C\n";
+      std::cout << "--pack [dir]: Write [dir] as a stream to the standard output\n";
+      std::cout << "--unpack [dir]: Extract a stream from the standard input into [dir]\n\n";
       exit(EXIT_SUCCESS);
     } 
-    if (argc > 4 ) {
+    if (argc < 3) {
       std::filesystem::path exe_path = args[0];
       std::stringstream error_message;
       error_message << exe_path.filename().generic_string() << ": Invalid number of arguments!";
@@ -76,34 +397,128 @@ void PrintException(const std::exception& error) {
 void Program(const int argc, const char* argv[]) {
   std::vector<std::string> args(argv, argv + argc);
   try {
-    bool copy_attributes = false, move_file = false;
-    for (const auto& parameter : args) {
+    std::string exe_name = std::filesystem::path(args[0]).filename().generic_string();
+    bool copy_attributes = false, move_file = false, recursive = false, pack = false, unpack = false;
+    bool watch = false, compare = false, fanout = false;
+    DedupMode dedup = DedupMode::kNone;
+    CopyOrder order = CopyOrder::kDisk;
+    size_t jobs = 4;
+    uint64_t checkpoint_bytes = 0;
+    std::shared_ptr<RateLimiter> rate_limiter;
+    int io_priority = 0;
+    std::vector<std::string> paths;
+    for (size_t i = 1; i < args.size(); ++i) {
+      const auto& parameter = args[i];
       if (parameter == "-a") {
         copy_attributes = true;
-        continue;
-      }
-      if (parameter == "-m") {
+      } else if (parameter == "-m") {
         move_file = true;
-        continue;
+      } else if (parameter == "-r") {
+        recursive = true;
+      } else if (parameter == "--dedup" || parameter == "--dedup=reflink") {
+        dedup = DedupMode::kReflink;
+      } else if (parameter == "--dedup=hardlink") {
+        dedup = DedupMode::kHardlink;
+      } else if (parameter == "--order=input" || parameter == "--order=disk") {
+        order = parameter == "--order=input" ? CopyOrder::kInput : CopyOrder::kDisk;
+      } else if (parameter == "-j" ||
+                 (parameter.size() > 2 && parameter.rfind("-j", 0) == 0 &&
+                  parameter.find_first_not_of("0123456789", 2) == std::string::npos)) {
+        // Solo "-j N" o "-jN": cualquier otro argumento que empiece por "-j" es una ruta
+        std::string value = parameter.size() > 2 ? parameter.substr(2) : (i + 1 < args.size() ? args[++i] : "");
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || std::stoul(value) == 0) {
+          throw std::runtime_error(exe_name + ": -j needs a positive number of copies");
+        }
+        jobs = std::stoul(value);
+      } else if (parameter == "--resume" || parameter.rfind("--resume=", 0) == 0) {
+        checkpoint_bytes = kDefaultCheckpointBytes;
+        if (parameter != "--resume") {
+          std::string value = parameter.substr(9);
+          if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || std::stoull(value) == 0) {
+            throw std::runtime_error(exe_name + ": --resume needs a positive number of MiB");
+          }
+          checkpoint_bytes = std::stoull(value) * 1024 * 1024;
+        }
+      } else if (parameter.rfind("--bwlimit=", 0) == 0) {
+        rate_limiter = std::make_shared<RateLimiter>(ParseRate(parameter.substr(10)));
+      } else if (parameter.rfind("--ionice=", 0) == 0) {
+        io_priority = ParseIoPriority(parameter.substr(9));
+      } else if (parameter == "--fanout") {
+        fanout = true;
+      } else if (parameter == "--compare") {
+        compare = true;
+      } else if (parameter == "--watch") {
+        watch = true;
+      } else if (parameter == "--pack") {
+        pack = true;
+      } else if (parameter == "--unpack") {
+        unpack = true;
+      } else {
+        paths.push_back(parameter);
       }
-      if (copy_attributes && move_file) {
-        std::filesystem::path exe_path = args[0];
-        std::stringstream error;
-        error << exe_path.filename().generic_string() << ": You can not use flags -m and -a simultaneously";
-        throw std::runtime_error(error.str());
+    }
+    if (copy_attributes && move_file) {
+      throw std::runtime_error(exe_name + ": You can not use flags -m and -a simultaneously");
+    }
+    if (move_file && (recursive || dedup != DedupMode::kNone)) {
+      throw std::runtime_error(exe_name + ": You can not use flag -m with -r or --dedup");
+    }
+    if (move_file && checkpoint_bytes > 0) {
+      throw std::runtime_error(exe_name + ": You can not use flags -m and --resume simultaneously");
+    }
+    if (pack || unpack) {
+      if (pack && unpack) throw std::runtime_error(exe_name + ": You can not use --pack and --unpack simultaneously");
+      if (paths.size() != 1) throw std::runtime_error(exe_name + ": --pack and --unpack take one directory");
+      RunPack(paths[0], pack);
+      return;
+    }
+    if (fanout) {
+      if (move_file || paths.size() < 2) throw std::runtime_error(exe_name + ": --fanout takes a file and its destinations");
+      RunFanout(paths[0], std::vector<std::string>(paths.begin() + 1, paths.end()), copy_attributes, rate_limiter);
+      return;
+    }
+    if (compare) {
+      if (move_file || paths.size() != 2) throw std::runtime_error(exe_name + ": --compare takes two files or directories");
+      RunCompare(paths[0], paths[1], recursive, jobs);
+      return;
+    }
+    if (watch) {
+      if (move_file || paths.size() != 2) throw std::runtime_error(exe_name + ": --watch takes a source and a destination directory");
+      RunWatch(paths[0], paths[1]);
+      return;
+    }
+    if (paths.size() == 2 && (paths[0] == kStandardStream || paths[1] == kStandardStream)) {
+      if (move_file || copy_attributes || recursive || dedup != DedupMode::kNone || checkpoint_bytes > 0) {
+        throw std::runtime_error(exe_name + ": You can not use -m, -a, -r, --dedup or --resume with -");
       }
+      RunStreamCopy(paths[0], paths[1], rate_limiter);
+      return;
     }
-    int shift = 0;
-    if (argc == 4) shift += 1;
-    bool preserve_all = false;
-    if (copy_attributes) preserve_all = true;
-    std::string src_path = argv[1 + shift];
-    std::string dst_path = argv[2 + shift];
-    if (move_file) MoveFile(src_path, dst_path);
-    else CopyFile(src_path, dst_path, preserve_all);
+    if (paths.size() < 2) throw std::runtime_error(exe_name + ": Missing file operand!");
+    std::string dst_path = paths.back();
+    paths.pop_back();
+    BatchCopyOptions options;
+    options.preserve_all = copy_attributes;
+    options.dedup = dedup;
+    // Con -a se conservan los enlaces duros como cp -a; al deduplicar se aprovechan siempre
+    options.preserve_links = copy_attributes || dedup != DedupMode::kNone;
+    options.order = order;
+    options.checkpoint_bytes = checkpoint_bytes;
+    options.rate_limiter = rate_limiter;
+    options.io_priority = io_priority;
+    if (paths.size() == 1 && !recursive && dedup == DedupMode::kNone) {
+      RunSingleCopy(CopyRequest{ paths[0], dst_path, move_file ? CopyOperation::kMove : CopyOperation::kCopy,
+                                 copy_attributes, checkpoint_bytes, rate_limiter, io_priority });
+    } else if (move_file) {
+      RunBatchMove(paths, dst_path, options);
+    } else {
+      RunBatchCopy(paths, dst_path, recursive, options, jobs);
+    }
+  } catch (const CopyCancelled&) {
+    throw;
   } catch(...) {
     std::stringstream error;
     error << "Try " << args[0] << " --help for more information";
     std::throw_with_nested(std::runtime_error(error.str()));
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,198 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: copy_bench.cc
+ * @brief: benchmark of the copy engines, of read versus mmap comparison and of planned writes
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "fastcopy.h"
+#include "unique_handle.h"
+#include "write_plan.h"
+
+// Copias simultáneas con las que se mide la fragmentación
+constexpr size_t kConcurrentCopies = 4;
+
+/**
+ * @brief Crea el archivo de prueba con datos aleatorios.
+ * @param path Ruta del archivo.
+ * @param size Tamaño en bytes.
+ */
+void CreateFile(const std::string& path, uint64_t size) {
+  UniqueFd fd = OpenFile(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  std::vector<uint8_t> data(kCopyBufferSize);
+  std::mt19937 random(42);
+  for (uint64_t written = 0; written < size; written += data.size()) {
+    for (auto& byte : data) byte = static_cast<uint8_t>(random());
+    WriteFile(fd.Get(), data.data(), std::min<uint64_t>(data.size(), size - written));
+  }
+  fsync(fd.Get());
+}
+
+/**
+ * @brief Saca un archivo de la caché de páginas para que se lea del disco.
+ */
+void DropCache(const std::string& path) {
+  UniqueFd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (fd) posix_fadvise(fd.Get(), 0, 0, POSIX_FADV_DONTNEED);
+}
+
+/**
+ * @brief Compara dos archivos leyéndolos a buffers, como se hacía antes de MmapCompare.
+ */
+bool ReadCompare(int first_fd, int second_fd) {
+  std::vector<uint8_t> first_buffer(kCopyBufferSize);
+  std::vector<uint8_t> second_buffer(kCopyBufferSize);
+  while (true) {
+    ssize_t first_read = ReadFile(first_fd, first_buffer);
+    ssize_t second_read = ReadFile(second_fd, second_buffer);
+    if (first_read != second_read || std::memcmp(first_buffer.data(), second_buffer.data(), first_read) != 0) {
+      return false;
+    }
+    if (first_read == 0) return true;
+  }
+}
+
+/**
+ * @brief Mide una operación y devuelve el resultado en JSON.
+ * @param bytes Bytes que procesa la operación, para calcular la velocidad.
+ */
+template <typename Operation>
+std::string Measure(uint64_t bytes, Operation operation) {
+  auto start = std::chrono::steady_clock::now();
+  operation();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::stringstream json;
+  json << std::fixed << std::setprecision(3);
+  json << "{\"seconds\": " << elapsed.count() << ", \"throughput_mb_s\": " << bytes / elapsed.count() / (1024 * 1024)
+       << "}";
+  return json.str();
+}
+
+/**
+ * @brief Copia el archivo de prueba con un motor, partiendo de la caché vacía.
+ */
+std::string BenchCopy(const std::string& source, const std::string& destination, CopyEngine engine, uint64_t size) {
+  DropCache(source);
+  UniqueFd source_fd = OpenFile(source, O_RDONLY);
+  UniqueFd destination_fd = OpenFile(destination, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  std::vector<uint8_t> buffer(kCopyBufferSize);
+  return Measure(size, [&] {
+    CopyContents(source_fd.Get(), destination_fd.Get(), engine, &buffer);
+    fdatasync(destination_fd.Get());
+  });
+}
+
+/**
+ * @brief Compara el archivo de prueba con su copia, leyendo o proyectando, con la caché vacía.
+ */
+std::string BenchCompare(const std::string& source, const std::string& destination, bool use_mmap, uint64_t size) {
+  DropCache(source);
+  DropCache(destination);
+  UniqueFd first_fd = OpenFile(source, O_RDONLY);
+  UniqueFd second_fd = OpenFile(destination, O_RDONLY);
+  bool is_equal = false;
+  std::string json = Measure(2 * size, [&] {
+    if (!use_mmap || !MmapCompare(first_fd.Get(), second_fd.Get(), is_equal)) {
+      is_equal = ReadCompare(first_fd.Get(), second_fd.Get());
+    }
+  });
+  if (!is_equal) throw std::runtime_error("The copy differs from the source");
+  return json;
+}
+
+/**
+ * @brief Copia a la vez varias veces el archivo de prueba, dejando que el destino crezca
+ *        escritura a escritura o con PlannedCopy, y mide la velocidad total y la fragmentación
+ *        media (extents por destino). Las copias simultáneas son las que más fragmentan.
+ */
+std::string BenchFragmentation(const std::string& source, size_t files, bool planned, uint64_t size) {
+  DropCache(source);
+  std::vector<std::thread> copies;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < files; ++i) {
+    copies.emplace_back([&source, i, planned] {
+      UniqueFd source_fd = OpenFile(source, O_RDONLY);
+      UniqueFd destination_fd = OpenFile(source + ".frag" + std::to_string(i), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (planned) {
+        PlannedCopy(source_fd.Get(), destination_fd.Get());
+      } else {
+        CopyContents(source_fd.Get(), destination_fd.Get(), CopyEngine::kKernel);
+      }
+      fsync(destination_fd.Get());
+    });
+  }
+  for (auto& copy : copies) copy.join();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  uint64_t extents = 0;
+  for (size_t i = 0; i < files; ++i) {
+    std::string destination = source + ".frag" + std::to_string(i);
+    extents += CountExtents(OpenFile(destination, O_RDONLY).Get());
+    std::filesystem::remove(destination);
+  }
+  std::stringstream json;
+  json << std::fixed << std::setprecision(3);
+  json << "{\"seconds\": " << elapsed.count() << ", \"throughput_mb_s\": "
+       << files * size / elapsed.count() / (1024 * 1024) << ", \"extents_per_file\": "
+       << static_cast<double>(extents) / files << "}";
+  return json.str();
+}
+
+int main(const int argc, const char* argv[]) {
+  try {
+    std::string source = argc > 1 ? argv[1] : "/tmp/copy_bench";
+    uint64_t size = (argc > 2 ? std::atoll(argv[2]) : 512) * 1024 * 1024;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 2;
+    std::string destination = source + ".copy";
+    struct stat source_stat{};
+    if (stat(source.c_str(), &source_stat) < 0 || static_cast<uint64_t>(source_stat.st_size) != size) {
+      CreateFile(source, size);
+    }
+
+    // Se repiten todos los motores en cada ronda para no favorecer al primero
+    const std::pair<const char*, CopyEngine> engines[] = {
+      { "kernel", CopyEngine::kKernel }, { "mmap", CopyEngine::kMmap }, { "read_write", CopyEngine::kReadWrite } };
+    std::string json = "{\n  \"size\": " + std::to_string(size);
+    for (int round = 1; round <= rounds; ++round) {
+      for (const auto& [name, engine] : engines) {
+        json += ",\n  \"copy_" + std::string(name) + "_" + std::to_string(round) + "\": " +
+                BenchCopy(source, destination, engine, size);
+      }
+      json += ",\n  \"compare_read_" + std::to_string(round) + "\": " + BenchCompare(source, destination, false, size);
+      json += ",\n  \"compare_mmap_" + std::to_string(round) + "\": " + BenchCompare(source, destination, true, size);
+      json += ",\n  \"concurrent_unplanned_" + std::to_string(round) + "\": " +
+              BenchFragmentation(source, kConcurrentCopies, false, size);
+      json += ",\n  \"concurrent_planned_" + std::to_string(round) + "\": " +
+              BenchFragmentation(source, kConcurrentCopies, true, size);
+    }
+    json += "\n}\n";
+    std::cout << json;
+    std::filesystem::remove(destination);
+  } catch (const std::exception& error) {
+    std::cerr << "copy_bench: " << error.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,150 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: schedule_bench.cc
+ * @brief: benchmark of bulk copies in input order versus disk order
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+#include "batch_copy.h"
+
+/**
+ * @brief Crea los archivos de prueba. Se escriben en un orden y se nombran con una permutación
+ *        aleatoria, así que el orden por nombre (el que daría un usuario) salta por el disco.
+ * @param directory Directorio donde se crean.
+ * @param files Número de archivos.
+ * @param file_size Tamaño de cada archivo.
+ */
+void CreateFiles(const std::string& directory, size_t files, size_t file_size) {
+  std::filesystem::create_directories(directory);
+  std::vector<size_t> names(files);
+  std::iota(names.begin(), names.end(), 0);
+  std::shuffle(names.begin(), names.end(), std::mt19937(42));
+  std::vector<uint8_t> data(file_size);
+  std::mt19937 random(7);
+  for (auto& byte : data) byte = static_cast<uint8_t>(random());
+  for (size_t name : names) {
+    std::stringstream path;
+    path << directory << "/" << std::setw(8) << std::setfill('0') << name;
+    int fd = open(path.str().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::system_error(errno, std::system_category(), path.str());
+    WriteFile(fd, data.data(), data.size());
+    // fsync para que el sistema de archivos asigne ya los bloques, en el orden de creación
+    fsync(fd);
+    close(fd);
+  }
+}
+
+/**
+ * @brief Saca los archivos de la caché de páginas para que la copia tenga que leer del disco.
+ *        No necesita privilegios, a diferencia de /proc/sys/vm/drop_caches.
+ */
+void DropCache(const std::vector<CopyEntry>& files) {
+  for (const auto& file : files) {
+    int fd = open(file.source_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) continue;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+/**
+ * @brief Distancia total que recorre el cabezal leyendo los archivos en un orden: la suma de los
+ *        saltos entre el primer extent de cada archivo y el del anterior.
+ */
+uint64_t SeekDistance(const std::vector<size_t>& order, const std::vector<uint64_t>& offsets) {
+  uint64_t distance = 0;
+  for (size_t i = 1; i < order.size(); ++i) {
+    uint64_t previous = offsets[order[i - 1]];
+    uint64_t current = offsets[order[i]];
+    distance += current > previous ? current - previous : previous - current;
+  }
+  return distance;
+}
+
+/**
+ * @brief Copia el directorio de prueba en un orden y devuelve el resultado en JSON.
+ */
+std::string BenchOrder(const std::string& source, const std::string& destination, CopyOrder order,
+                       size_t threads, uint64_t seek_distance) {
+  std::filesystem::remove_all(destination);
+  CopyPlan plan = PlanCopy({ source }, destination, true);
+  std::sort(plan.files.begin(), plan.files.end(), [](const CopyEntry& first, const CopyEntry& second) {
+    return first.source_path < second.source_path;
+  });
+  DropCache(plan.files);
+  BatchCopyOptions options;
+  options.order = order;
+  CopyService copy_service(threads, threads + 1);
+  auto start = std::chrono::steady_clock::now();
+  BatchCopyStats stats = RunCopyPlan(plan, options, copy_service);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  if (!stats.errors.empty()) std::rethrow_exception(stats.errors.front().second);
+  std::stringstream json;
+  json << std::fixed << std::setprecision(3);
+  json << "{\"seconds\": " << elapsed.count()
+       << ", \"throughput_mb_s\": " << stats.bytes_copied / elapsed.count() / (1024 * 1024)
+       << ", \"seek_distance_mb\": " << seek_distance / (1024.0 * 1024) << "}";
+  return json.str();
+}
+
+int main(const int argc, const char* argv[]) {
+  try {
+    std::string directory = argc > 1 ? argv[1] : "/tmp/schedule_bench";
+    size_t files = argc > 2 ? std::atoi(argv[2]) : 2000;
+    size_t file_size = argc > 3 ? std::atoi(argv[3]) : 256 * 1024;
+    size_t threads = argc > 4 ? std::atoi(argv[4]) : 4;
+    std::string source = directory + "/src";
+    std::string destination = directory + "/dst";
+    if (!std::filesystem::exists(source)) CreateFiles(source, files, file_size);
+
+    // Saltos del cabezal en cada orden, calculados con las mismas posiciones que usa la copia
+    CopyPlan plan = PlanCopy({ source }, destination, true);
+    std::sort(plan.files.begin(), plan.files.end(), [](const CopyEntry& first, const CopyEntry& second) {
+      return first.source_path < second.source_path;
+    });
+    std::vector<struct stat> file_stats(plan.files.size());
+    for (size_t i = 0; i < plan.files.size(); ++i) StatxFile(plan.files[i].source_path, file_stats[i]);
+    std::vector<size_t> input_order(plan.files.size());
+    std::iota(input_order.begin(), input_order.end(), 0);
+    std::vector<uint64_t> offsets;
+    std::vector<size_t> disk_order = ScheduleByDisk(plan.files, file_stats, input_order, offsets);
+
+    // Se repite cada orden dos veces, alternándolos, para no favorecer al primero
+    std::string json = "{\n  \"files\": " + std::to_string(plan.files.size()) +
+                       ", \"file_size\": " + std::to_string(file_size) + ", \"threads\": " + std::to_string(threads);
+    for (int round = 1; round <= 2; ++round) {
+      json += ",\n  \"input_order_" + std::to_string(round) + "\": " +
+              BenchOrder(source, destination, CopyOrder::kInput, threads, SeekDistance(input_order, offsets));
+      json += ",\n  \"disk_order_" + std::to_string(round) + "\": " +
+              BenchOrder(source, destination, CopyOrder::kDisk, threads, SeekDistance(disk_order, offsets));
+    }
+    json += "\n}\n";
+    std::cout << json;
+    std::filesystem::remove_all(destination);
+  } catch (const std::exception& error) {
+    std::cerr << "schedule_bench: " << error.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: batch_copy.h
+ * @brief: batch and recursive copies with content deduplication
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef BATCH_COPY_H
+#define BATCH_COPY_H
+
+#include <sys/stat.h>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "copy_service.h"
+
+/**
+ * @brief Qué se hace con los archivos idénticos a otro ya copiado
+ * [+] kNone = se copian todos
+ * [+] kReflink = se clonan con FICLONE (comparten bloques hasta que se modifican); si el
+ *                sistema de archivos no lo admite se copian
+ * [+] kHardlink = se crean como enlaces duros al primero
+ */
+enum class DedupMode { kNone, kReflink, kHardlink };
+
+/**
+ * @brief Orden en el que se lanzan las copias
+ * [+] kInput = el orden en el que se han dado los archivos
+ * [+] kDisk = por dispositivo, posición física del primer extent (FIEMAP) e inodo, para que
+ *             los discos giratorios y NFS lean casi secuencialmente
+ */
+enum class CopyOrder { kInput, kDisk };
+
+/**
+ * @brief Archivo regular a copiar, con la ruta de destino ya resuelta
+ */
+struct CopyEntry {
+  std::string source_path;
+  std::string destination_path;
+};
+
+/**
+ * @brief Todo lo que hay que crear para copiar varias rutas a la vez
+ * [+] directories = directorios a crear, cada uno después de su padre, con su origen
+ * [+] symlinks = enlaces simbólicos a crear (origen, destino)
+ * [+] files = archivos regulares a copiar
+ */
+struct CopyPlan {
+  std::vector<CopyEntry> directories;
+  std::vector<CopyEntry> symlinks;
+  std::vector<CopyEntry> files;
+};
+
+/**
+ * @brief Opciones de una copia por lotes
+ * [+] preserve_all = si se preservan los atributos del origen
+ * [+] dedup = qué hacer con los archivos de contenido idéntico
+ * [+] preserve_links = si los archivos que son el mismo inodo en el origen (enlaces duros)
+ *                      se crean como enlaces duros en el destino
+ * [+] order = orden en el que se lanzan las copias; cuántas van a la vez lo decide el CopyService
+ * [+] checkpoint_bytes = si no es 0, cada archivo se copia de forma reanudable (ver CopyRequest)
+ * [+] rate_limiter = si no es nulo, límite de velocidad compartido por todas las copias
+ * [+] io_priority = si no es 0, prioridad de E/S de las copias (ver ParseIoPriority)
+ */
+struct BatchCopyOptions {
+  bool preserve_all = false;
+  DedupMode dedup = DedupMode::kNone;
+  bool preserve_links = false;
+  CopyOrder order = CopyOrder::kDisk;
+  uint64_t checkpoint_bytes = 0;
+  std::shared_ptr<RateLimiter> rate_limiter;
+  int io_priority = 0;
+};
+
+/**
+ * @brief Resultado de una copia por lotes
+ * [+] files = archivos regulares creados en el destino
+ * [+] bytes_copied = bytes escritos copiando
+ * [+] bytes_saved = bytes que no se han escrito gracias a los enlaces duros y los reflinks
+ * [+] hardlinks = archivos creados como enlace duro
+ * [+] reflinks = archivos clonados con reflink
+ * [+] errors = archivos que no se han podido copiar, con su error
+ */
+struct BatchCopyStats {
+  uint64_t files = 0;
+  uint64_t bytes_copied = 0;
+  uint64_t bytes_saved = 0;
+  uint64_t hardlinks = 0;
+  uint64_t reflinks = 0;
+  std::vector<std::pair<std::string, std::exception_ptr>> errors;
+};
+
+CopyPlan PlanCopy(const std::vector<std::string>& sources, const std::string& destination, bool recursive);
+BatchCopyStats RunCopyPlan(const CopyPlan& plan, const BatchCopyOptions& options, CopyService& copy_service);
+bool StatxFile(const std::string& path, struct stat& file_stat);
+uint64_t FirstExtentOffset(const std::string& path);
+std::vector<size_t> ScheduleByDisk(const std::vector<CopyEntry>& files, const std::vector<struct stat>& file_stats,
+                                   const std::vector<size_t>& indices, std::vector<uint64_t>& offsets);
+size_t ReadFull(int fd, std::vector<uint8_t>& buffer);
+uint64_t HashFileContents(int fd, std::vector<uint8_t>& buffer);
+bool HaveSameContents(int first_fd, int second_fd, std::vector<uint8_t>& first_buffer,
+                      std::vector<uint8_t>& second_buffer);
+
+#endif
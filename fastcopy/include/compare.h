@@ -0,0 +1,75 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: compare.h
+ * @brief: comparison of files and directory trees
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fastcopy.h"
+
+/**
+ * @brief En qué se diferencian dos rutas
+ * [+] kNone = son iguales
+ * [+] kContents = el contenido es distinto a partir de difference_offset
+ * [+] kLength = uno de los archivos es el principio del otro; difference_offset es el
+ *               tamaño del más corto
+ * [+] kType = no son del mismo tipo (archivo, directorio, enlace simbólico...)
+ * [+] kSymlinkTarget = los dos son enlaces simbólicos pero apuntan a sitios distintos
+ * [+] kOnlyInFirst = la ruta solo existe en el primer árbol
+ * [+] kOnlyInSecond = la ruta solo existe en el segundo árbol
+ */
+enum class Difference { kNone, kContents, kLength, kType, kSymlinkTarget, kOnlyInFirst, kOnlyInSecond };
+
+/**
+ * @brief Resultado de comparar dos rutas
+ * [+] first_path = ruta en el primer árbol
+ * [+] second_path = ruta en el segundo árbol
+ * [+] difference = en qué se diferencian
+ * [+] difference_offset = primer byte distinto (con kContents y kLength)
+ */
+struct CompareResult {
+  std::string first_path;
+  std::string second_path;
+  Difference difference = Difference::kNone;
+  uint64_t difference_offset = 0;
+};
+
+/**
+ * @brief Resultado de comparar dos árboles
+ * [+] files = pares de archivos regulares comparados
+ * [+] bytes_read = bytes leídos entre los dos lados
+ * [+] differences = rutas distintas, ordenadas por la ruta del primer árbol
+ * [+] errors = rutas que no se han podido comparar, con su error
+ */
+struct CompareStats {
+  uint64_t files = 0;
+  uint64_t bytes_read = 0;
+  std::vector<CompareResult> differences;
+  std::vector<std::pair<std::string, std::exception_ptr>> errors;
+};
+
+size_t FindFirstDifference(const uint8_t* first, const uint8_t* second, size_t size);
+CompareResult CompareFiles(const std::string& first_path, const std::string& second_path,
+                           std::vector<uint8_t>& first_buffer, std::vector<uint8_t>& second_buffer,
+                           CopyProgress* progress = nullptr);
+CompareStats ComparePaths(const std::string& first_path, const std::string& second_path, bool recursive,
+                          size_t threads = 4, CopyProgress* progress = nullptr);
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: content_hash.h
+ * @brief: vectorized non-cryptographic hash of file contents
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Hash no criptográfico del contenido de un archivo, al estilo de xxHash32 pero con
+ *        ocho acumuladores independientes que avanzan a la vez sobre bloques de 32 bytes.
+ *        Solo sirve para descartar contenidos distintos: los iguales se comparan byte a byte.
+ *        El resultado no depende de cómo se trocean los datos entre llamadas a Update.
+ */
+class ContentHasher {
+ public:
+  /**
+   * @brief Añade datos al hash.
+   * @param data Datos.
+   * @param size Número de bytes.
+   */
+  void Update(const uint8_t* data, size_t size) {
+    length_ += size;
+    // Primero se completa el bloque que quedó a medias en la llamada anterior
+    if (pending_size_ > 0) {
+      size_t needed = std::min(sizeof(Lanes) - pending_size_, size);
+      std::memcpy(pending_ + pending_size_, data, needed);
+      pending_size_ += needed;
+      data += needed;
+      size -= needed;
+      if (pending_size_ < sizeof(Lanes)) return;
+      Mix(pending_);
+      pending_size_ = 0;
+    }
+    size_t stripes = size / sizeof(Lanes);
+    for (size_t i = 0; i < stripes; ++i) Mix(data + i * sizeof(Lanes));
+    pending_size_ = size - stripes * sizeof(Lanes);
+    std::memcpy(pending_, data + stripes * sizeof(Lanes), pending_size_);
+  }
+
+  uint64_t Final() const {
+    uint64_t tail = 0;
+    for (size_t i = 0; i < pending_size_; ++i) tail = (tail ^ pending_[i]) * kPrime64;
+    uint64_t hash = length_ * kPrime64;
+    for (size_t i = 0; i < 8; ++i) {
+      hash ^= lanes_[i];
+      hash = ((hash << 27) | (hash >> 37)) * kPrime64;
+    }
+    hash ^= tail;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+ private:
+  // Ocho palabras de 32 bits que el compilador trata como un registro vectorial (SSE/AVX)
+  using Lanes = uint32_t __attribute__((vector_size(32)));
+
+  static constexpr uint32_t kPrime1 = 2654435761u;
+  static constexpr uint32_t kPrime2 = 2246822519u;
+  static constexpr uint64_t kPrime64 = 0x9e3779b97f4a7c15ull;
+
+  void Mix(const uint8_t* stripe) {
+    Lanes input;
+    std::memcpy(&input, stripe, sizeof(Lanes));
+    lanes_ += input * kPrime2;
+    lanes_ = (lanes_ << 13) | (lanes_ >> 19);
+    lanes_ *= kPrime1;
+  }
+
+  Lanes lanes_ = { kPrime1, kPrime2, 1, 2, 3, 4, 5, 6 };
+  uint8_t pending_[sizeof(Lanes)];
+  size_t pending_size_ = 0;
+  uint64_t length_ = 0;
+};
+
+#endif
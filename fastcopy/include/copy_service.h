@@ -0,0 +1,120 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: copy_service.h
+ * @brief: asynchronous copy and move service
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef COPY_SERVICE_H
+#define COPY_SERVICE_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "fastcopy.h"
+#include "io_pool.h"
+#include "throttle.h"
+
+/**
+ * @brief Operación que realiza un trabajo de copia
+ */
+enum class CopyOperation { kCopy, kMove };
+
+/**
+ * @brief Estructura con un trabajo de copia
+ * [+] source_path = ruta del archivo de origen
+ * [+] destination_path = ruta de destino (si es un directorio, el archivo conserva su nombre)
+ * [+] operation = copiar o mover
+ * [+] preserve_all = si se preservan los atributos del origen (al mover siempre se preservan)
+ * [+] checkpoint_bytes = si no es 0, la copia se puede reanudar (ResumableCopyFile) y se guarda
+ *                        un punto de control cada checkpoint_bytes bytes
+ * [+] rate_limiter = si no es nulo, limita la velocidad; varias copias pueden compartirlo
+ * [+] io_priority = si no es 0, prioridad de E/S del hilo mientras copia (ver ParseIoPriority)
+ */
+struct CopyRequest {
+  std::string source_path;
+  std::string destination_path;
+  CopyOperation operation = CopyOperation::kCopy;
+  bool preserve_all = false;
+  uint64_t checkpoint_bytes = 0;
+  std::shared_ptr<RateLimiter> rate_limiter;
+  int io_priority = 0;
+};
+
+/**
+ * @brief Referencia a un trabajo enviado a CopyService. Se puede copiar; todas las copias
+ *        se refieren al mismo trabajo. Una referencia construida por defecto no es válida.
+ */
+class CopyHandle {
+ public:
+  CopyHandle() = default;
+
+  bool IsDone() const;
+  int Wait() const;
+  void Cancel() const;
+
+  inline bool IsValid() const { return state_ != nullptr; }
+  inline const CopyRequest& GetRequest() const { return state_->request; }
+  inline uint64_t GetBytesCopied() const { return state_->progress.bytes_copied; }
+  inline uint64_t GetTotalBytes() const { return state_->progress.total_bytes; }
+
+ private:
+  friend class CopyService;
+
+  /**
+   * @brief Estado compartido entre las referencias y el hilo que hace la copia
+   */
+  struct State {
+    CopyRequest request;
+    CopyProgress progress;
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool is_done = false;
+    std::exception_ptr error;
+  };
+
+  explicit CopyHandle(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+  std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief Función a la que se llama desde el hilo de trabajo cuando acaba una copia,
+ *        con el error si ha fallado o se ha cancelado (nulo si ha ido bien).
+ */
+using CopyCallback = std::function<void(const CopyHandle& handle, std::exception_ptr error)>;
+
+/**
+ * @brief Servicio de copias asíncronas: cada trabajo se ejecuta en un IoPool con un buffer
+ *        prestado por un BufferPool, así que las copias simultáneas comparten los hilos y la
+ *        memoria. Al destruirse espera a que terminen los trabajos pendientes.
+ */
+class CopyService {
+ public:
+  explicit CopyService(size_t threads = 4, size_t max_buffers = 5);
+
+  CopyHandle Submit(CopyRequest request, CopyCallback on_complete = nullptr);
+
+  inline int GetEventFd() const { return pool_.GetEventFd(); }
+  inline void ClearEvents() { pool_.ClearEvents(); }
+
+ private:
+  void Run(const CopyHandle& handle, const CopyCallback& on_complete);
+
+  // El pool va después de los buffers para que sus hilos terminen antes de destruirlos
+  BufferPool buffers_;
+  IoPool pool_;
+};
+
+#endif
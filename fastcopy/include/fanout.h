@@ -0,0 +1,46 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: fanout.h
+ * @brief: copy of one file to several destinations reading it once
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef FANOUT_H
+#define FANOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fastcopy.h"
+
+// Capacidad que se pide para la tubería de cada destino: lo que puede quedarse atrás un destino
+// lento antes de frenar a los demás (sin privilegios el kernel la limita a pipe-max-size)
+constexpr size_t kFanoutWindowSize = 4ul * 1024 * 1024;
+
+/**
+ * @brief Resultado de una copia a varios destinos
+ * [+] destinations = rutas finales de los destinos, en el orden dado
+ * [+] bytes_read = bytes leídos del origen (una sola vez para todos los destinos)
+ * [+] errors = destinos que han fallado, con su error; se borran y los demás se copian enteros
+ */
+struct FanoutStats {
+  std::vector<std::string> destinations;
+  uint64_t bytes_read = 0;
+  std::vector<std::pair<std::string, std::exception_ptr>> errors;
+};
+
+FanoutStats CopyToMany(const std::string& src_path, const std::vector<std::string>& dst_paths, bool preserve_all,
+                       CopyProgress* progress = nullptr);
+
+#endif
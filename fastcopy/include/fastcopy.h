@@ -0,0 +1,90 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: fastcopy.h
+ * @brief: file copy and move functions shared by the shell and copyfile
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef FASTCOPY_H
+#define FASTCOPY_H
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class RateLimiter;
+
+/**
+ * @brief Estructura con el progreso de una copia, que se puede consultar desde otro hilo
+ * [+] bytes_copied = bytes copiados hasta el momento
+ * [+] total_bytes = tamaño del archivo de origen
+ * [+] is_cancelled = si se ha pedido cancelar la copia; se comprueba entre bloque y bloque
+ * [+] rate_limiter = si no es nulo, limita la velocidad de la copia (se puede compartir entre copias)
+ */
+struct CopyProgress {
+  std::atomic<uint64_t> bytes_copied{0};
+  std::atomic<uint64_t> total_bytes{0};
+  std::atomic<bool> is_cancelled{false};
+  RateLimiter* rate_limiter = nullptr;
+};
+
+/**
+ * @brief Excepción de una copia cancelada. No se anida dentro de otras excepciones
+ *        para que quien la cancela pueda distinguirla de un error.
+ */
+class CopyCancelled : public std::runtime_error {
+ public:
+  CopyCancelled() : std::runtime_error("Copy cancelled") {}
+};
+
+// Tamaño de los bloques con los que se copian los archivos
+constexpr size_t kCopyBufferSize = 1ul * 1024 * 1024;
+
+// Tamaño de las ventanas con las que se proyectan los archivos en memoria
+constexpr size_t kMmapWindowSize = 64ul * 1024 * 1024;
+
+// Ruta que en CopyStream indica la entrada estándar (como origen) o la salida estándar (como destino)
+constexpr const char* kStandardStream = "-";
+
+/**
+ * @brief Método con el que se copia el contenido de un archivo
+ * [+] kKernel = copy_file_range, splice o sendfile (ver KernelCopy)
+ * [+] kMmap = escribiendo desde una proyección en memoria del origen (ver MmapCopy)
+ * [+] kReadWrite = por bloques con read y write en un buffer
+ */
+enum class CopyEngine { kKernel, kMmap, kReadWrite };
+
+ssize_t ReadFile(const int fd, std::vector<uint8_t>& buffer, size_t max_bytes = SIZE_MAX);
+void WriteFile(int fd, const uint8_t* data, size_t size);
+bool KernelCopy(int source_fd, int destination_fd, CopyProgress* progress = nullptr);
+void ReadWriteCopy(int source_fd, int destination_fd, std::vector<uint8_t>& buffer, CopyProgress* progress = nullptr);
+bool MmapCopy(int source_fd, int destination_fd, CopyProgress* progress = nullptr);
+void CopyContents(int source_fd, int destination_fd, CopyEngine engine, std::vector<uint8_t>* buffer = nullptr,
+                  CopyProgress* progress = nullptr);
+bool MmapCompare(int first_fd, int second_fd, bool& is_equal);
+void CopyAttributes(const std::string& destination_path, const struct stat& source_stat);
+std::string ResolveDestination(const std::string& source_path, const std::string& destination_path,
+                               const struct stat& source_stat);
+struct stat StatSource(const std::string& source_path);
+
+// COPY AND MOVE FUNCTIONS
+void CopyFile(const std::string& src_path, const std::string& dst_path, bool preserve_all,
+              std::vector<uint8_t>* buffer = nullptr, CopyProgress* progress = nullptr);
+void CopyStream(const std::string& src_path, const std::string& dst_path, std::vector<uint8_t>* buffer = nullptr,
+                CopyProgress* progress = nullptr);
+void MoveFile(const std::string& src_path, const std::string& dst_path,
+              std::vector<uint8_t>* buffer = nullptr, CopyProgress* progress = nullptr);
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: io_pool.h
+ * @brief: I/O worker pool and shared buffer pool
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef IO_POOL_H
+#define IO_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Conjunto de buffers compartidos por todas las copias. Como mucho hay
+ *        max_buffers reservados a la vez; si están todos en uso, Acquire espera.
+ */
+class BufferPool {
+ public:
+  /**
+   * @brief Buffer prestado por el pool. Se devuelve al destruirse.
+   */
+  class Lease {
+   public:
+    Lease(BufferPool& pool, std::unique_ptr<std::vector<uint8_t>> buffer) : pool_(&pool), buffer_(std::move(buffer)) {}
+    Lease(Lease&& other) = default;
+    Lease& operator=(Lease&& other) = default;
+    ~Lease() { if (buffer_) pool_->Release(std::move(buffer_)); }
+    inline std::vector<uint8_t>& Buffer() { return *buffer_; }
+   private:
+    BufferPool* pool_;
+    std::unique_ptr<std::vector<uint8_t>> buffer_;
+  };
+
+  BufferPool(size_t buffer_size, size_t max_buffers) : buffer_size_(buffer_size), max_buffers_(max_buffers) {}
+
+  Lease Acquire();
+
+ private:
+  void Release(std::unique_ptr<std::vector<uint8_t>> buffer);
+
+  size_t buffer_size_;
+  size_t max_buffers_;
+  size_t allocated_buffers_ = 0;
+  std::vector<std::unique_ptr<std::vector<uint8_t>>> free_buffers_;
+  std::mutex mutex_;
+  std::condition_variable buffer_released_;
+};
+
+/**
+ * @brief Pool de hilos para las operaciones de E/S (las copias de CopyService).
+ *        Los hilos se crean con la primera tarea. Cada vez que termina una tarea se escribe
+ *        en un eventfd, que el programa puede vigilar desde su bucle de eventos.
+ */
+class IoPool {
+ public:
+  explicit IoPool(size_t threads);
+  ~IoPool();
+  IoPool(const IoPool&) = delete;
+  IoPool& operator=(const IoPool&) = delete;
+
+  std::shared_future<int> Submit(std::function<int()> task);
+  void ClearEvents();
+
+  inline int GetEventFd() const { return event_fd_; }
+  inline size_t GetThreads() const { return threads_count_; }
+
+ private:
+  void WorkerLoop();
+
+  size_t threads_count_;
+  int event_fd_;
+  bool is_stopping_ = false;
+  std::vector<std::thread> threads_;
+  std::deque<std::packaged_task<int()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+};
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: pack.h
+ * @brief: streaming pack and unpack of directory trees
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef PACK_H
+#define PACK_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Formato del flujo (los enteros van en little-endian):
+ *   cabecera: "FCPACK1\n"
+ *   registro: tipo (1 byte: 'D' directorio, 'F' archivo, 'L' enlace simbólico, 'E' fin),
+ *             modo (u32), mtime en segundos (i64) y nanosegundos (u32),
+ *             longitud de la ruta (u32) y la ruta, relativa al directorio empaquetado
+ *   'F' sigue con el tamaño (u64) y el contenido; 'L' con la longitud del destino (u32) y el destino
+ *   'E' es solo el byte de tipo
+ */
+
+/**
+ * @brief Resultado de empaquetar o desempaquetar
+ * [+] directories = directorios
+ * [+] files = archivos regulares
+ * [+] symlinks = enlaces simbólicos
+ * [+] bytes = bytes de contenido de los archivos
+ * [+] changed_files = archivos que han encogido mientras se empaquetaban (se rellenan con ceros)
+ */
+struct PackStats {
+  uint64_t directories = 0;
+  uint64_t files = 0;
+  uint64_t symlinks = 0;
+  uint64_t bytes = 0;
+  uint64_t changed_files = 0;
+};
+
+// Tamaño de los buffers del flujo: muchos archivos pequeños caben en una sola escritura
+constexpr size_t kPackBufferSize = 4ul * 1024 * 1024;
+
+PackStats PackTree(const std::string& source_path, int output_fd);
+PackStats UnpackTree(int input_fd, const std::string& destination_path);
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: resume.h
+ * @brief: resumable copies of large files with a checkpoint journal
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef RESUME_H
+#define RESUME_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fastcopy.h"
+
+// Bytes copiados entre dos puntos de control si no se indica otra cosa
+constexpr uint64_t kDefaultCheckpointBytes = 64ull * 1024 * 1024;
+
+// Extensión del diario que se guarda junto al archivo de destino mientras no termina la copia
+constexpr const char* kJournalSuffix = ".fcjournal";
+
+void ResumableCopyFile(const std::string& src_path, const std::string& dst_path, bool preserve_all,
+                       uint64_t checkpoint_bytes = kDefaultCheckpointBytes, std::vector<uint8_t>* buffer = nullptr,
+                       CopyProgress* progress = nullptr);
+
+#endif
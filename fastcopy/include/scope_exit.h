@@ -0,0 +1,36 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 29 Nov 2022
+ * @file: scope_exit.h
+ * @brief: scope_exit class
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef SCOPE_EXIT_H
+#define SCOPE_EXIT_H
+
+#include <utility>
+
+/**
+ * @brief Ejecuta una función al salir del ámbito. Es una plantilla sobre el tipo de la función
+ *        (normalmente una lambda), así que no reserva memoria ni pasa por una llamada indirecta
+ *        como std::function. Se crea con auto guard = ScopeExit([...] { ... });
+ */
+template <typename Function>
+class ScopeExit {
+ public:
+  explicit ScopeExit(Function scope_exit) : scope_exit_(std::move(scope_exit)) { }
+  ~ScopeExit() { scope_exit_(); }
+  ScopeExit(const ScopeExit&) = delete;
+  ScopeExit& operator=(const ScopeExit&) = delete;
+ private:
+  Function scope_exit_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: throttle.h
+ * @brief: bandwidth limiting and I/O priority of copies
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef THROTTLE_H
+#define THROTTLE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "fastcopy.h"
+
+/**
+ * @brief Limita los bytes por segundo de una o varias copias (las que compartan el limitador)
+ *        con un cubo de fichas. Las copias piden permiso después de cada bloque y, si se han
+ *        adelantado, esperan lo justo para volver al ritmo. Los bloques se mantienen pequeños
+ *        (GetChunkSize) para que las esperas sean de unas decenas de milisegundos y no a saltos.
+ */
+class RateLimiter {
+ public:
+  explicit RateLimiter(uint64_t bytes_per_second);
+
+  void Acquire(uint64_t bytes);
+  double GetAchievedRate();
+
+  inline uint64_t GetRate() const { return rate_; }
+  inline size_t GetChunkSize() const { return chunk_size_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  std::mutex mutex_;
+  uint64_t rate_;
+  size_t chunk_size_;
+  // Fichas disponibles en bytes; negativo si las copias van por delante del ritmo
+  double tokens_;
+  Clock::time_point last_refill_;
+  Clock::time_point start_;
+  uint64_t total_bytes_ = 0;
+  bool is_started_ = false;
+};
+
+void ThrottleCopy(const CopyProgress* progress, uint64_t bytes);
+size_t ThrottledChunkSize(const CopyProgress* progress, size_t size);
+uint64_t ParseRate(const std::string& rate);
+std::string FormatRate(double bytes_per_second);
+int ParseIoPriority(const std::string& priority);
+int SetThreadIoPriority(int priority);
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: unique_handle.h
+ * @brief: RAII handles for file descriptors, directory descriptors and memory mappings
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef UNIQUE_HANDLE_H
+#define UNIQUE_HANDLE_H
+
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Dueño único de un recurso del sistema (descriptor, proyección de memoria...). Lo libera
+ *        al destruirse, solo si es válido: un open fallido (-1) nunca llega a cerrarse. Se puede
+ *        mover pero no copiar. Traits indica el tipo del recurso y cómo se libera, sin funciones
+ *        virtuales ni std::function, así que ocupa lo mismo que el propio recurso.
+ *        Traits debe tener:
+ *        [+] Handle = tipo del recurso
+ *        [+] static Handle Invalid() = valor que no es un recurso
+ *        [+] static bool IsValid(const Handle&) = si es un recurso
+ *        [+] static void Close(const Handle&) = libera el recurso
+ */
+template <typename Traits>
+class UniqueHandle {
+ public:
+  using Handle = typename Traits::Handle;
+
+  UniqueHandle() = default;
+  explicit UniqueHandle(Handle handle) : handle_(handle) {}
+  ~UniqueHandle() { Reset(); }
+
+  UniqueHandle(const UniqueHandle&) = delete;
+  UniqueHandle& operator=(const UniqueHandle&) = delete;
+  UniqueHandle(UniqueHandle&& other) noexcept : handle_(other.Release()) {}
+  UniqueHandle& operator=(UniqueHandle&& other) noexcept {
+    if (this != &other) Reset(other.Release());
+    return *this;
+  }
+
+  inline const Handle& Get() const { return handle_; }
+  inline bool IsValid() const { return Traits::IsValid(handle_); }
+  inline explicit operator bool() const { return IsValid(); }
+
+  /**
+   * @brief Deja de ser dueño del recurso sin liberarlo.
+   *
+   * @return El recurso.
+   */
+  Handle Release() {
+    return std::exchange(handle_, Traits::Invalid());
+  }
+
+  /**
+   * @brief Libera el recurso actual (si es válido) y pasa a ser dueño de otro.
+   * @param handle Nuevo recurso (por defecto, ninguno).
+   */
+  void Reset(Handle handle = Traits::Invalid()) {
+    Handle previous = std::exchange(handle_, handle);
+    if (Traits::IsValid(previous)) Traits::Close(previous);
+  }
+
+ private:
+  Handle handle_ = Traits::Invalid();
+};
+
+/**
+ * @brief Descriptor de archivo
+ */
+struct FdTraits {
+  using Handle = int;
+  static constexpr int Invalid() { return -1; }
+  static constexpr bool IsValid(int fd) { return fd >= 0; }
+  static void Close(int fd) { close(fd); }
+};
+
+/**
+ * @brief Descriptor de un directorio abierto con O_DIRECTORY. Se cierra igual que cualquier
+ *        descriptor, pero es otro tipo para que no se pueda pasar donde se espera un archivo.
+ */
+struct DirFdTraits : FdTraits {};
+
+/**
+ * @brief Proyección de un archivo en memoria
+ * [+] address = dirección de la proyección (MAP_FAILED si no hay)
+ * [+] size = bytes proyectados
+ */
+struct Mapping {
+  void* address;
+  size_t size;
+
+  inline const uint8_t* Data() const { return static_cast<const uint8_t*>(address); }
+};
+
+struct MappingTraits {
+  using Handle = Mapping;
+  static Mapping Invalid() { return Mapping{ MAP_FAILED, 0 }; }
+  static bool IsValid(const Mapping& mapping) { return mapping.address != MAP_FAILED; }
+  static void Close(const Mapping& mapping) { munmap(mapping.address, mapping.size); }
+};
+
+using UniqueFd = UniqueHandle<FdTraits>;
+using UniqueDirFd = UniqueHandle<DirFdTraits>;
+using UniqueMapping = UniqueHandle<MappingTraits>;
+
+UniqueFd OpenFile(const std::string& path, int flags, mode_t mode = 0);
+UniqueFd OpenFileAt(const UniqueDirFd& directory, const std::string& name, int flags, mode_t mode = 0);
+UniqueDirFd OpenDirectory(const std::string& path);
+UniqueDirFd OpenDirectoryAt(const UniqueDirFd& directory, const std::string& name);
+UniqueMapping MapFile(int fd, uint64_t offset, size_t size, int flags = MAP_PRIVATE);
+void OpenPipe(UniqueFd& read_end, UniqueFd& write_end);
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: watch.h
+ * @brief: continuous mirror of a directory driven by inotify events
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+// Tiempo sin eventos que se espera antes de copiar un archivo que se está escribiendo
+constexpr std::chrono::milliseconds kDefaultSettleTime{200};
+
+/**
+ * @brief Estadísticas de un TreeWatcher
+ * [+] events = eventos de inotify leídos
+ * [+] copies = archivos copiados
+ * [+] removals = rutas borradas del destino porque ya no están en el origen
+ * [+] rescans = recorridos completos del árbol (el inicial y uno por cada desbordamiento)
+ * [+] overflows = veces que se ha llenado la cola de inotify
+ * [+] errors = rutas que no se han podido sincronizar
+ * [+] latencies_ms = milisegundos desde el primer evento de un cambio hasta que está en el
+ *                    destino, de los últimos kMaxLatencySamples cambios
+ */
+struct WatchStats {
+  static constexpr size_t kMaxLatencySamples = 4096;
+
+  uint64_t events = 0;
+  uint64_t copies = 0;
+  uint64_t removals = 0;
+  uint64_t rescans = 0;
+  uint64_t overflows = 0;
+  uint64_t errors = 0;
+  std::deque<double> latencies_ms;
+
+  double LatencyPercentile(double percentile) const;
+};
+
+// Función a la que se llama con la ruta y el error cuando no se puede sincronizar una ruta
+using WatchErrorCallback = std::function<void(const std::string&, std::exception_ptr)>;
+
+/**
+ * @brief Mantiene un directorio de destino igual que uno de origen. Primero los sincroniza
+ *        recorriendo los dos árboles y después solo vuelve a copiar lo que indican los
+ *        eventos de inotify. Los eventos de una misma ruta se agrupan: se copia cuando lleva
+ *        settle_time sin cambiar (o, si no para de cambiar, cada 10 veces settle_time).
+ *        Si la cola de inotify se desborda se vuelve a recorrer todo el árbol.
+ */
+class TreeWatcher {
+ public:
+  TreeWatcher(const std::string& source, const std::string& destination,
+              std::chrono::milliseconds settle_time = kDefaultSettleTime, WatchErrorCallback on_error = {});
+  ~TreeWatcher();
+  TreeWatcher(const TreeWatcher&) = delete;
+  TreeWatcher& operator=(const TreeWatcher&) = delete;
+
+  void Run();
+  void Stop();
+
+  inline const WatchStats& GetStats() const { return stats_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Ruta con cambios pendientes de copiar
+   * [+] first_event = primer evento desde la última copia (para medir la latencia)
+   * [+] last_event = último evento, para esperar a que deje de cambiar
+   */
+  struct PendingChange {
+    Clock::time_point first_event;
+    Clock::time_point last_event;
+  };
+
+  void Rescan(const std::string& relative_path);
+  void AddWatch(const std::string& relative_path);
+  void RemoveWatches(const std::string& relative_path);
+  void ReadEvents();
+  void SyncPath(const std::string& relative_path, bool only_if_changed);
+  void SyncDueChanges();
+  int NextTimeout() const;
+  void ReportError(const std::string& relative_path);
+  uintmax_t RemoveFromDestination(const std::filesystem::path& path);
+
+  std::string source_;
+  std::string destination_;
+  std::chrono::milliseconds settle_time_;
+  WatchErrorCallback on_error_;
+  int inotify_fd_ = -1;
+  int stop_fd_ = -1;
+  // Descriptor de cada directorio vigilado y su ruta relativa al origen
+  std::unordered_map<int, std::string> watches_;
+  std::map<std::string, PendingChange> pending_;
+  WatchStats stats_;
+};
+
+#endif
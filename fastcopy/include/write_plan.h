@@ -0,0 +1,53 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: write_plan.h
+ * @brief: planning of how the destination of a copy is allocated and written
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef WRITE_PLAN_H
+#define WRITE_PLAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "fastcopy.h"
+
+// Tamaño de bloque de las copias planificadas antes de ajustarlo al sistema de archivos
+constexpr size_t kPlannedChunkSize = 8 * kCopyBufferSize;
+
+/**
+ * @brief Cómo se va a escribir el destino de una copia entre archivos regulares
+ * [+] size = tamaño del origen al planificar
+ * [+] block_size = alineación de las escrituras: el tamaño de bloque preferido del destino
+ *                  (st_blksize) o el tamaño de E/S óptimo de su dispositivo, el mayor
+ * [+] chunk_size = bytes por escritura, múltiplo de block_size
+ * [+] data_ranges = tramos con datos del origen (posición, longitud); los huecos de un archivo
+ *                   disperso no se escriben y quedan como huecos en el destino
+ * [+] preallocate = si se reserva el espacio de los tramos con fallocate antes de copiar; no
+ *                   se hace si copy_file_range puede compartir los bloques (btrfs o XFS en el
+ *                   mismo dispositivo), porque se reservaría espacio para nada
+ */
+struct WritePlan {
+  uint64_t size = 0;
+  size_t block_size = 4096;
+  size_t chunk_size = kPlannedChunkSize;
+  std::vector<std::pair<uint64_t, uint64_t>> data_ranges;
+  bool preallocate = false;
+};
+
+WritePlan PlanWrite(int source_fd, int destination_fd);
+uint64_t PlannedCopy(int source_fd, int destination_fd, std::vector<uint8_t>* buffer = nullptr,
+                     CopyProgress* progress = nullptr);
+uint64_t CountExtents(int fd);
+
+#endif
@@ -0,0 +1,450 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: batch_copy.cc
+ * @brief: batch and recursive copies with content deduplication functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <system_error>
+#include <unordered_map>
+
+#include "batch_copy.h"
+#include "compare.h"
+#include "content_hash.h"
+#include "unique_handle.h"
+
+namespace {
+
+/**
+ * @brief Nombre del último componente de una ruta, aunque acabe en '/'.
+ */
+std::string BaseName(const std::string& path) {
+  std::filesystem::path file_path(path);
+  if (!file_path.has_filename()) file_path = file_path.parent_path();
+  return file_path.filename().string();
+}
+
+/**
+ * @brief Añade al plan el contenido de un directorio, recorriéndolo entero.
+ * @param plan Plan al que añadirlo.
+ * @param source_directory Directorio de origen.
+ * @param destination_directory Directorio que se creará como copia.
+ */
+void PlanTree(CopyPlan& plan, const std::string& source_directory, const std::string& destination_directory) {
+  plan.directories.push_back(CopyEntry{ source_directory, destination_directory });
+  // El iterador devuelve cada directorio antes que su contenido, así que los padres se crean antes
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(source_directory)) {
+    std::string relative_path = entry.path().lexically_relative(source_directory).string();
+    CopyEntry copy_entry{ entry.path().string(), destination_directory + "/" + relative_path };
+    auto status = entry.symlink_status();
+    if (std::filesystem::is_symlink(status)) {
+      plan.symlinks.push_back(std::move(copy_entry));
+    } else if (std::filesystem::is_directory(status)) {
+      plan.directories.push_back(std::move(copy_entry));
+    } else if (std::filesystem::is_regular_file(status)) {
+      plan.files.push_back(std::move(copy_entry));
+    }
+  }
+}
+
+/**
+ * @brief Crea un archivo en el destino como enlace duro a otro ya copiado.
+ * @param target_path Archivo ya copiado.
+ * @param destination_path Archivo a crear (si existe se sustituye).
+ * @param source_stat stat del origen, para no sustituir el propio origen.
+ *
+ * @return true si se ha creado el enlace, false si no se puede (por ejemplo, entre sistemas de archivos).
+ */
+bool CreateHardlink(const std::string& target_path, const std::string& destination_path,
+                    const struct stat& source_stat) {
+  struct stat destination_stat{};
+  if (lstat(destination_path.c_str(), &destination_stat) == 0) {
+    if (destination_stat.st_dev == source_stat.st_dev && destination_stat.st_ino == source_stat.st_ino) {
+      throw std::runtime_error("'" + destination_path + "' is the same file as its source");
+    }
+    if (unlink(destination_path.c_str()) < 0) throw std::system_error(errno, std::system_category(), destination_path);
+  }
+  return link(target_path.c_str(), destination_path.c_str()) == 0;
+}
+
+/**
+ * @brief Clona un archivo ya copiado con FICLONE: el destino comparte los bloques del otro
+ *        hasta que alguno de los dos se modifica.
+ * @param target_path Archivo ya copiado.
+ * @param destination_path Archivo a crear.
+ * @throw std::system_error Si no se pueden abrir los archivos.
+ *
+ * @return true si se ha clonado, false si el sistema de archivos no lo admite.
+ */
+bool CreateReflink(const std::string& target_path, const std::string& destination_path) {
+  UniqueFd target_fd = OpenFile(target_path, O_RDONLY);
+  UniqueFd destination_fd = OpenFile(destination_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  return ioctl(destination_fd.Get(), FICLONE, target_fd.Get()) == 0;
+}
+
+/**
+ * @brief Busca los archivos de contenido idéntico: se agrupan por tamaño, en cada grupo se
+ *        calcula el hash solo de los que comparten tamaño y los de igual hash se comparan byte
+ *        a byte con el primero de su contenido.
+ * @param files Archivos a copiar.
+ * @param stats stat de cada archivo.
+ * @param candidates Índices de los archivos que se pueden deduplicar.
+ * @param representatives Para cada archivo idéntico a otro, el índice de ese otro (se rellena).
+ */
+void FindDuplicates(const std::vector<CopyEntry>& files, const std::vector<struct stat>& stats,
+                    const std::vector<size_t>& candidates, std::vector<long>& representatives) {
+  std::unordered_map<off_t, std::vector<size_t>> by_size;
+  for (size_t index : candidates) {
+    // Los archivos vacíos no ocupan bloques: no se gana nada enlazándolos
+    if (stats[index].st_size > 0) by_size[stats[index].st_size].push_back(index);
+  }
+  std::vector<uint8_t> first_buffer(kCopyBufferSize);
+  std::vector<uint8_t> second_buffer(kCopyBufferSize);
+  for (const auto& [size, same_size] : by_size) {
+    if (same_size.size() < 2) continue;
+    std::map<uint64_t, std::vector<size_t>> by_hash;
+    for (size_t index : same_size) {
+      try {
+        UniqueFd fd = OpenFile(files[index].source_path, O_RDONLY);
+        by_hash[HashFileContents(fd.Get(), first_buffer)].push_back(index);
+      } catch (...) {
+        // Si no se puede leer se copia sin deduplicar, y es la copia la que informa del error
+      }
+    }
+    for (const auto& [hash, same_hash] : by_hash) {
+      // Si dos contenidos distintos coinciden en el hash, cada uno tiene su propio representante
+      std::vector<size_t> group_representatives;
+      for (size_t index : same_hash) {
+        try {
+          UniqueFd fd = OpenFile(files[index].source_path, O_RDONLY);
+          for (size_t representative : group_representatives) {
+            UniqueFd representative_fd = OpenFile(files[representative].source_path, O_RDONLY);
+            if (HaveSameContents(fd.Get(), representative_fd.Get(), first_buffer, second_buffer)) {
+              representatives[index] = representative;
+              break;
+            }
+          }
+        } catch (...) {
+          // Si no se puede comparar se copia sin deduplicar
+        }
+        if (representatives[index] < 0) group_representatives.push_back(index);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Lee hasta llenar el buffer o llegar al final del archivo.
+ * @param fd Descriptor del archivo.
+ * @param buffer Buffer de lectura.
+ *
+ * @return Número de bytes leídos (menos que buffer.size() solo al final del archivo).
+ */
+size_t ReadFull(int fd, std::vector<uint8_t>& buffer) {
+  size_t total = 0;
+  while (total < buffer.size()) {
+    ssize_t bytes_read = read(fd, buffer.data() + total, buffer.size() - total);
+    if (bytes_read < 0 && errno == EINTR) continue;
+    if (bytes_read < 0) throw std::system_error(errno, std::system_category());
+    if (bytes_read == 0) break;
+    total += bytes_read;
+  }
+  return total;
+}
+
+/**
+ * @brief Obtiene los atributos de un archivo con statx. Con AT_STATX_DONT_SYNC, en NFS se usan
+ *        los atributos que ya tiene el cliente en vez de preguntar al servidor por cada archivo.
+ * @param path Ruta del archivo.
+ * @param file_stat Donde se guardan los atributos.
+ *
+ * @return false si no se puede obtener (errno indica el motivo).
+ */
+bool StatxFile(const std::string& path, struct stat& file_stat) {
+  struct statx file_statx{};
+  if (statx(AT_FDCWD, path.c_str(), AT_STATX_DONT_SYNC, STATX_BASIC_STATS, &file_statx) < 0) return false;
+  file_stat = {};
+  file_stat.st_dev = makedev(file_statx.stx_dev_major, file_statx.stx_dev_minor);
+  file_stat.st_ino = file_statx.stx_ino;
+  file_stat.st_mode = file_statx.stx_mode;
+  file_stat.st_nlink = file_statx.stx_nlink;
+  file_stat.st_uid = file_statx.stx_uid;
+  file_stat.st_gid = file_statx.stx_gid;
+  file_stat.st_size = file_statx.stx_size;
+  file_stat.st_blocks = file_statx.stx_blocks;
+  file_stat.st_atim = { file_statx.stx_atime.tv_sec, file_statx.stx_atime.tv_nsec };
+  file_stat.st_mtim = { file_statx.stx_mtime.tv_sec, file_statx.stx_mtime.tv_nsec };
+  file_stat.st_ctim = { file_statx.stx_ctime.tv_sec, file_statx.stx_ctime.tv_nsec };
+  return true;
+}
+
+/**
+ * @brief Posición física en el disco del primer extent de un archivo, con FIEMAP.
+ * @param path Ruta del archivo.
+ *
+ * @return La posición en bytes, o 0 si el archivo no tiene bloques o el sistema de
+ *         archivos no admite FIEMAP (NFS, tmpfs...).
+ */
+uint64_t FirstExtentOffset(const std::string& path) {
+  UniqueFd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOATIME));
+  if (!fd) fd.Reset(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (!fd) return 0;
+  // Cabecera de fiemap seguida de espacio para un solo extent
+  alignas(struct fiemap) uint8_t storage[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {};
+  auto* map = reinterpret_cast<struct fiemap*>(storage);
+  map->fm_start = 0;
+  map->fm_length = FIEMAP_MAX_OFFSET;
+  map->fm_extent_count = 1;
+  if (ioctl(fd.Get(), FS_IOC_FIEMAP, map) < 0 || map->fm_mapped_extents == 0) return 0;
+  return map->fm_extents[0].fe_physical;
+}
+
+/**
+ * @brief Ordena las copias según el disco: por dispositivo, posición física del primer extent
+ *        e inodo. Donde no hay FIEMAP todas las posiciones son 0 y queda el orden por inodo, que
+ *        en la mayoría de sistemas de archivos sigue de cerca la disposición en el disco.
+ * @param files Archivos a copiar.
+ * @param file_stats stat de cada archivo.
+ * @param indices Índices de los archivos a ordenar.
+ * @param offsets Posición del primer extent de cada archivo (se rellena para los de indices).
+ *
+ * @return Los índices en el orden en el que se deben copiar.
+ */
+std::vector<size_t> ScheduleByDisk(const std::vector<CopyEntry>& files, const std::vector<struct stat>& file_stats,
+                                   const std::vector<size_t>& indices, std::vector<uint64_t>& offsets) {
+  offsets.resize(files.size(), 0);
+  for (size_t index : indices) offsets[index] = FirstExtentOffset(files[index].source_path);
+  std::vector<size_t> order = indices;
+  std::sort(order.begin(), order.end(), [&](size_t first, size_t second) {
+    const struct stat& first_stat = file_stats[first];
+    const struct stat& second_stat = file_stats[second];
+    if (first_stat.st_dev != second_stat.st_dev) return first_stat.st_dev < second_stat.st_dev;
+    if (offsets[first] != offsets[second]) return offsets[first] < offsets[second];
+    return first_stat.st_ino < second_stat.st_ino;
+  });
+  return order;
+}
+
+/**
+ * @brief Calcula el hash del contenido de un archivo desde el principio.
+ * @param fd Descriptor del archivo.
+ * @param buffer Buffer de lectura.
+ * @throw std::system_error Si se produce un error al leer.
+ */
+uint64_t HashFileContents(int fd, std::vector<uint8_t>& buffer) {
+  if (lseek(fd, 0, SEEK_SET) < 0) throw std::system_error(errno, std::system_category());
+  ContentHasher hasher;
+  size_t bytes_read;
+  do {
+    bytes_read = ReadFull(fd, buffer);
+    hasher.Update(buffer.data(), bytes_read);
+  } while (bytes_read == buffer.size());
+  return hasher.Final();
+}
+
+/**
+ * @brief Compara byte a byte el contenido de dos archivos desde el principio, leyéndolos. No se
+ *        proyectan en memoria: son archivos de origen en uso, y truncar uno proyectado mientras se
+ *        compara provocaría SIGBUS en todo el proceso.
+ * @param first_fd Descriptor del primer archivo.
+ * @param second_fd Descriptor del segundo archivo.
+ * @param first_buffer Buffer de lectura del primero.
+ * @param second_buffer Buffer de lectura del segundo, del mismo tamaño.
+ * @throw std::system_error Si se produce un error al leer.
+ *
+ * @return true si los dos tienen el mismo contenido.
+ */
+bool HaveSameContents(int first_fd, int second_fd, std::vector<uint8_t>& first_buffer,
+                      std::vector<uint8_t>& second_buffer) {
+  if (lseek(first_fd, 0, SEEK_SET) < 0 || lseek(second_fd, 0, SEEK_SET) < 0) {
+    throw std::system_error(errno, std::system_category());
+  }
+  while (true) {
+    size_t first_read = ReadFull(first_fd, first_buffer);
+    size_t second_read = ReadFull(second_fd, second_buffer);
+    if (first_read != second_read ||
+        FindFirstDifference(first_buffer.data(), second_buffer.data(), first_read) != first_read) {
+      return false;
+    }
+    if (first_read < first_buffer.size()) return true;
+  }
+}
+
+/**
+ * @brief Calcula qué hay que crear para copiar varias rutas. Con varios orígenes el destino debe
+ *        ser un directorio; los directorios solo se copian (enteros) si recursive es verdadero.
+ * @param sources Rutas de origen.
+ * @param destination Ruta de destino.
+ * @param recursive Si se copian los directorios.
+ * @throw std::runtime_error Si los argumentos no son válidos.
+ * @throw std::system_error Si no existe algún origen o no se puede recorrer.
+ *
+ * @return Plan con los directorios, enlaces simbólicos y archivos a crear.
+ */
+CopyPlan PlanCopy(const std::vector<std::string>& sources, const std::string& destination, bool recursive) {
+  struct stat destination_stat{};
+  bool is_destination_directory = stat(destination.c_str(), &destination_stat) == 0 && S_ISDIR(destination_stat.st_mode);
+  if (sources.size() > 1 && !is_destination_directory) {
+    throw std::runtime_error("ERROR: Destination '" + destination + "' is not a directory!");
+  }
+  CopyPlan plan;
+  for (const auto& source : sources) {
+    struct stat source_stat{};
+    if (stat(source.c_str(), &source_stat) < 0) throw std::system_error(errno, std::system_category(), source);
+    std::string target = is_destination_directory ? destination + "/" + BaseName(source) : destination;
+    if (S_ISDIR(source_stat.st_mode)) {
+      if (!recursive) throw std::runtime_error("ERROR: '" + source + "' is a directory (use -r)!");
+      PlanTree(plan, source, target);
+    } else if (S_ISREG(source_stat.st_mode)) {
+      plan.files.push_back(CopyEntry{ source, target });
+    } else {
+      throw std::runtime_error("ERROR: '" + source + "' is not a regular file!");
+    }
+  }
+  return plan;
+}
+
+/**
+ * @brief Ejecuta un plan de copia. Los archivos se copian a la vez en el CopyService, en el
+ *        orden de options.order; después los que son el mismo inodo que otro en el origen (si se
+ *        preservan los enlaces) y los de contenido idéntico a otro (si se deduplica) se enlazan
+ *        o clonan a partir de la copia del primero. Si no se puede enlazar o clonar, se copian.
+ * @param plan Plan calculado con PlanCopy.
+ * @param options Opciones de la copia.
+ * @param copy_service Servicio en el que se hacen las copias.
+ *
+ * @return Estadísticas de la copia, con los errores de cada archivo que no se ha podido copiar.
+ */
+BatchCopyStats RunCopyPlan(const CopyPlan& plan, const BatchCopyOptions& options, CopyService& copy_service) {
+  BatchCopyStats stats;
+  for (const auto& directory : plan.directories) {
+    struct stat source_stat{};
+    stat(directory.source_path.c_str(), &source_stat);
+    mode_t mode = options.preserve_all ? (source_stat.st_mode & 07777) | S_IRWXU : 0777;
+    if (mkdir(directory.destination_path.c_str(), mode) < 0 && errno != EEXIST) {
+      stats.errors.emplace_back(directory.destination_path,
+                                std::make_exception_ptr(std::system_error(errno, std::system_category())));
+    }
+  }
+  for (const auto& symlink_entry : plan.symlinks) {
+    std::error_code error;
+    auto target = std::filesystem::read_symlink(symlink_entry.source_path, error);
+    std::filesystem::remove(symlink_entry.destination_path, error);
+    if (!error) std::filesystem::create_symlink(target, symlink_entry.destination_path, error);
+    if (error) stats.errors.emplace_back(symlink_entry.destination_path, std::make_exception_ptr(std::system_error(error)));
+  }
+
+  const auto& files = plan.files;
+  std::vector<struct stat> file_stats(files.size());
+  std::vector<bool> is_valid(files.size(), false);
+  // Para cada archivo, el índice del archivo del que será un enlace o un clon (-1 si se copia)
+  std::vector<long> representatives(files.size(), -1);
+  std::vector<bool> is_same_inode(files.size(), false);
+  std::map<std::pair<dev_t, ino_t>, size_t> inodes;
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!StatxFile(files[i].source_path, file_stats[i])) {
+      stats.errors.emplace_back(files[i].source_path,
+                                std::make_exception_ptr(std::system_error(errno, std::system_category())));
+      continue;
+    }
+    is_valid[i] = true;
+    if (options.preserve_links) {
+      auto [inode, is_new] = inodes.emplace(std::make_pair(file_stats[i].st_dev, file_stats[i].st_ino), i);
+      if (!is_new) {
+        representatives[i] = inode->second;
+        is_same_inode[i] = true;
+        continue;
+      }
+    }
+    candidates.push_back(i);
+  }
+  if (options.dedup != DedupMode::kNone) FindDuplicates(files, file_stats, candidates, representatives);
+
+  // Primero se copian los archivos que no dependen de otro
+  std::vector<CopyHandle> handles(files.size());
+  auto submit_copy = [&](size_t i) {
+    handles[i] = copy_service.Submit(
+        CopyRequest{ files[i].source_path, files[i].destination_path, CopyOperation::kCopy, options.preserve_all,
+                     options.checkpoint_bytes, options.rate_limiter, options.io_priority });
+  };
+  auto wait_copy = [&](size_t i) {
+    try {
+      handles[i].Wait();
+      ++stats.files;
+      stats.bytes_copied += file_stats[i].st_size;
+      return true;
+    } catch (...) {
+      stats.errors.emplace_back(files[i].source_path, std::current_exception());
+      return false;
+    }
+  };
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (is_valid[i] && representatives[i] < 0) pending.push_back(i);
+  }
+  // El pool atiende las tareas en el orden en el que llegan, así que se lanzan ya ordenadas
+  if (options.order == CopyOrder::kDisk) {
+    std::vector<uint64_t> offsets;
+    pending = ScheduleByDisk(files, file_stats, pending, offsets);
+  }
+  for (size_t i : pending) submit_copy(i);
+  std::vector<bool> is_created(files.size(), false);
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (handles[i].IsValid()) is_created[i] = wait_copy(i);
+  }
+
+  // Después se enlazan o clonan los demás a partir de la copia de su representante
+  std::vector<size_t> fallback_copies;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!is_valid[i] || representatives[i] < 0) continue;
+    size_t representative = representatives[i];
+    if (!is_created[representative]) {
+      fallback_copies.push_back(i);
+      continue;
+    }
+    const std::string& target_path = files[representative].destination_path;
+    try {
+      bool is_hardlink = is_same_inode[i] || options.dedup == DedupMode::kHardlink;
+      if (is_hardlink && CreateHardlink(target_path, files[i].destination_path, file_stats[i])) {
+        ++stats.hardlinks;
+      } else if (!is_hardlink && CreateReflink(target_path, files[i].destination_path)) {
+        if (options.preserve_all) CopyAttributes(files[i].destination_path, file_stats[i]);
+        ++stats.reflinks;
+      } else {
+        fallback_copies.push_back(i);
+        continue;
+      }
+      is_created[i] = true;
+      ++stats.files;
+      stats.bytes_saved += file_stats[i].st_size;
+    } catch (...) {
+      stats.errors.emplace_back(files[i].source_path, std::current_exception());
+    }
+  }
+  for (size_t i : fallback_copies) submit_copy(i);
+  for (size_t i : fallback_copies) wait_copy(i);
+  return stats;
+}
@@ -0,0 +1,312 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: compare.cc
+ * @brief: comparison of files and directory trees functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <stdexcept>
+#include <system_error>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "batch_copy.h"
+#include "compare.h"
+#include "io_pool.h"
+#include "unique_handle.h"
+
+namespace {
+
+/**
+ * @brief Compara las entradas de dos directorios, sin entrar en los que solo están en uno de
+ *        los dos o son de distinto tipo. Los enlaces simbólicos se comparan por su destino y
+ *        no se siguen.
+ * @param first_directory Directorio del primer árbol.
+ * @param second_directory Directorio del segundo árbol.
+ * @param files Donde se añaden los pares de archivos regulares cuyo contenido hay que comparar.
+ * @param stats Donde se añaden las diferencias y los errores encontrados.
+ */
+void CompareTrees(const std::string& first_directory, const std::string& second_directory,
+                  std::vector<CopyEntry>& files, CompareStats& stats) {
+  namespace fs = std::filesystem;
+  for (auto entry = fs::recursive_directory_iterator(first_directory); entry != fs::end(entry); ++entry) {
+    std::string relative_path = entry->path().lexically_relative(first_directory).string();
+    CompareResult result{ entry->path().string(), second_directory + "/" + relative_path };
+    std::error_code error;
+    fs::file_status first_status = entry->symlink_status();
+    fs::file_status second_status = fs::symlink_status(result.second_path, error);
+    if (!fs::exists(second_status)) {
+      result.difference = Difference::kOnlyInFirst;
+    } else if (first_status.type() != second_status.type()) {
+      result.difference = Difference::kType;
+    } else if (fs::is_symlink(first_status)) {
+      fs::path first_target = fs::read_symlink(result.first_path, error);
+      fs::path second_target;
+      if (!error) second_target = fs::read_symlink(result.second_path, error);
+      if (error) {
+        stats.errors.emplace_back(result.first_path, std::make_exception_ptr(std::system_error(error)));
+      } else if (first_target != second_target) {
+        result.difference = Difference::kSymlinkTarget;
+      }
+    } else if (fs::is_regular_file(first_status)) {
+      files.push_back(CopyEntry{ result.first_path, result.second_path });
+    }
+    if (result.difference != Difference::kNone) {
+      if (fs::is_directory(first_status)) entry.disable_recursion_pending();
+      stats.differences.push_back(std::move(result));
+    }
+  }
+  // Lo que solo está en el segundo árbol
+  for (auto entry = fs::recursive_directory_iterator(second_directory); entry != fs::end(entry); ++entry) {
+    std::string relative_path = entry->path().lexically_relative(second_directory).string();
+    std::string first_path = first_directory + "/" + relative_path;
+    std::error_code error;
+    fs::file_status first_status = fs::symlink_status(first_path, error);
+    if (!fs::exists(first_status)) {
+      entry.disable_recursion_pending();
+      stats.differences.push_back(CompareResult{ first_path, entry->path().string(), Difference::kOnlyInSecond });
+    } else if (first_status.type() != entry->symlink_status().type()) {
+      // Ya se ha contado como kType al recorrer el primero
+      entry.disable_recursion_pending();
+    }
+  }
+}
+
+/**
+ * @brief Versión de FindFirstDifference sin instrucciones vectoriales: compara palabra a palabra
+ *        y byte a byte solo la palabra distinta.
+ */
+size_t FindFirstDifferenceScalar(const uint8_t* first, const uint8_t* second, size_t size) {
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+    uint64_t first_word, second_word;
+    std::memcpy(&first_word, first + offset, sizeof(uint64_t));
+    std::memcpy(&second_word, second + offset, sizeof(uint64_t));
+    if (first_word != second_word) break;
+  }
+  for (; offset < size; ++offset) {
+    if (first[offset] != second[offset]) return offset;
+  }
+  return size;
+}
+
+#if defined(__x86_64__)
+/**
+ * @brief Versión de FindFirstDifference con SSE2: cuatro comparaciones de 16 bytes por vuelta y
+ *        una sola máscara para saber si alguna ha fallado. La máscara de bytes iguales dice
+ *        además cuál es el primer byte distinto.
+ */
+size_t FindFirstDifferenceSse2(const uint8_t* first, const uint8_t* second, size_t size) {
+  constexpr size_t kStep = 4 * sizeof(__m128i);
+  size_t offset = 0;
+  for (; offset + kStep <= size; offset += kStep) {
+    __m128i equal[4];
+    for (size_t i = 0; i < 4; ++i) {
+      __m128i first_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + offset) + i);
+      __m128i second_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + offset) + i);
+      equal[i] = _mm_cmpeq_epi8(first_block, second_block);
+    }
+    __m128i all_equal = _mm_and_si128(_mm_and_si128(equal[0], equal[1]), _mm_and_si128(equal[2], equal[3]));
+    if (_mm_movemask_epi8(all_equal) == 0xffff) continue;
+    for (size_t i = 0; i < 4; ++i) {
+      unsigned mask = _mm_movemask_epi8(equal[i]);
+      if (mask != 0xffff) return offset + i * sizeof(__m128i) + __builtin_ctz(~mask);
+    }
+  }
+  return offset + FindFirstDifferenceScalar(first + offset, second + offset, size - offset);
+}
+
+/**
+ * @brief Versión de FindFirstDifference con AVX2: dos comparaciones de 32 bytes por vuelta.
+ */
+__attribute__((target("avx2")))
+size_t FindFirstDifferenceAvx2(const uint8_t* first, const uint8_t* second, size_t size) {
+  constexpr size_t kStep = 2 * sizeof(__m256i);
+  size_t offset = 0;
+  for (; offset + kStep <= size; offset += kStep) {
+    const __m256i* first_blocks = reinterpret_cast<const __m256i*>(first + offset);
+    const __m256i* second_blocks = reinterpret_cast<const __m256i*>(second + offset);
+    __m256i low_equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(first_blocks), _mm256_loadu_si256(second_blocks));
+    __m256i high_equal =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(first_blocks + 1), _mm256_loadu_si256(second_blocks + 1));
+    if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(low_equal, high_equal))) == 0xffffffffu) {
+      continue;
+    }
+    uint32_t low_mask = _mm256_movemask_epi8(low_equal);
+    if (low_mask != 0xffffffffu) return offset + __builtin_ctz(~low_mask);
+    uint32_t high_mask = _mm256_movemask_epi8(high_equal);
+    return offset + sizeof(__m256i) + __builtin_ctz(~high_mask);
+  }
+  return offset + FindFirstDifferenceSse2(first + offset, second + offset, size - offset);
+}
+#endif
+
+}  // namespace
+
+/**
+ * @brief Busca el primer byte distinto entre dos bloques de memoria. Compara 64 bytes por
+ *        vuelta con AVX2 si el procesador lo tiene, si no con SSE2 (que tienen todos los
+ *        x86-64), y en otras arquitecturas palabra a palabra. Se elige la versión la primera vez.
+ * @param first Primer bloque.
+ * @param second Segundo bloque.
+ * @param size Bytes a comparar de cada uno.
+ *
+ * @return Posición del primer byte distinto, o size si son iguales.
+ */
+size_t FindFirstDifference(const uint8_t* first, const uint8_t* second, size_t size) {
+#if defined(__x86_64__)
+  static const auto find = __builtin_cpu_supports("avx2") ? FindFirstDifferenceAvx2 : FindFirstDifferenceSse2;
+  return find(first, second, size);
+#else
+  return FindFirstDifferenceScalar(first, second, size);
+#endif
+}
+
+/**
+ * @brief Compara el contenido de dos archivos regulares hasta el primer byte distinto.
+ * @param first_path Ruta del primer archivo.
+ * @param second_path Ruta del segundo archivo.
+ * @param first_buffer Buffer de lectura del primero.
+ * @param second_buffer Buffer de lectura del segundo, del mismo tamaño.
+ * @param progress Si no es nulo, se le suman los bytes leídos y permite cancelar la comparación.
+ * @throw std::system_error Si no se puede abrir o leer alguno de los dos.
+ * @throw CopyCancelled Si se cancela la comparación.
+ *
+ * @return Resultado con kNone, kContents o kLength.
+ */
+CompareResult CompareFiles(const std::string& first_path, const std::string& second_path,
+                           std::vector<uint8_t>& first_buffer, std::vector<uint8_t>& second_buffer,
+                           CopyProgress* progress) {
+  CompareResult result{ first_path, second_path };
+  UniqueFd first_fd = OpenFile(first_path, O_RDONLY);
+  UniqueFd second_fd = OpenFile(second_path, O_RDONLY);
+  posix_fadvise(first_fd.Get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+  posix_fadvise(second_fd.Get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+  uint64_t offset = 0;
+  while (true) {
+    if (progress != nullptr && progress->is_cancelled) throw CopyCancelled();
+    size_t first_read = ReadFull(first_fd.Get(), first_buffer);
+    size_t second_read = ReadFull(second_fd.Get(), second_buffer);
+    if (progress != nullptr) progress->bytes_copied += first_read + second_read;
+    size_t common = std::min(first_read, second_read);
+    size_t difference = FindFirstDifference(first_buffer.data(), second_buffer.data(), common);
+    if (difference < common) {
+      result.difference = Difference::kContents;
+      result.difference_offset = offset + difference;
+      return result;
+    }
+    if (first_read != second_read) {
+      result.difference = Difference::kLength;
+      result.difference_offset = offset + common;
+      return result;
+    }
+    if (first_read < first_buffer.size()) return result;
+    offset += first_read;
+  }
+}
+
+/**
+ * @brief Compara dos archivos, o con recursive dos árboles de directorios. El contenido de los
+ *        archivos se compara a la vez en un IoPool con buffers de un BufferPool, como las
+ *        copias, y en el orden del disco del primer árbol (ScheduleByDisk).
+ * @param first_path Primer archivo o directorio.
+ * @param second_path Segundo archivo o directorio.
+ * @param recursive Si se pueden comparar directorios.
+ * @param threads Número de archivos que se comparan a la vez.
+ * @param progress Si no es nulo, cuenta los bytes leídos y permite cancelar la comparación.
+ * @throw std::runtime_error Si first_path es un directorio y recursive es falso, o no es ni un
+ *                           archivo regular ni un directorio.
+ * @throw std::system_error Si no existe alguna de las dos rutas.
+ * @throw CopyCancelled Si se cancela la comparación.
+ *
+ * @return Las diferencias encontradas y los errores de las rutas que no se han podido comparar.
+ */
+CompareStats ComparePaths(const std::string& first_path, const std::string& second_path, bool recursive,
+                          size_t threads, CopyProgress* progress) {
+  struct stat first_stat{};
+  struct stat second_stat{};
+  if (stat(first_path.c_str(), &first_stat) < 0) throw std::system_error(errno, std::system_category(), first_path);
+  if (stat(second_path.c_str(), &second_stat) < 0) throw std::system_error(errno, std::system_category(), second_path);
+  CompareStats stats;
+  std::vector<CopyEntry> files;
+  if (S_ISDIR(first_stat.st_mode)) {
+    if (!recursive) throw std::runtime_error("ERROR: '" + first_path + "' is a directory (use -r)!");
+    if (S_ISDIR(second_stat.st_mode)) {
+      CompareTrees(first_path, second_path, files, stats);
+    } else {
+      stats.differences.push_back(CompareResult{ first_path, second_path, Difference::kType });
+    }
+  } else if (S_ISREG(first_stat.st_mode)) {
+    if (S_ISREG(second_stat.st_mode)) {
+      files.push_back(CopyEntry{ first_path, second_path });
+    } else {
+      stats.differences.push_back(CompareResult{ first_path, second_path, Difference::kType });
+    }
+  } else {
+    throw std::runtime_error("ERROR: '" + first_path + "' is not a regular file!");
+  }
+
+  std::vector<struct stat> file_stats(files.size());
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (StatxFile(files[i].source_path, file_stats[i])) {
+      pending.push_back(i);
+    } else {
+      stats.errors.emplace_back(files[i].source_path,
+                                std::make_exception_ptr(std::system_error(errno, std::system_category())));
+    }
+  }
+  std::vector<uint64_t> offsets;
+  pending = ScheduleByDisk(files, file_stats, pending, offsets);
+
+  CopyProgress own_progress;
+  if (progress == nullptr) progress = &own_progress;
+  const uint64_t initial_bytes = progress->bytes_copied;
+  std::vector<CompareResult> results(files.size());
+  // Cada comparación usa dos buffers; con dos por hilo ninguna espera a que se libere otro
+  BufferPool buffers(kCopyBufferSize, 2 * threads);
+  {
+    IoPool pool(threads);
+    std::vector<std::shared_future<int>> comparisons(files.size());
+    for (size_t i : pending) {
+      comparisons[i] = pool.Submit([&, i] {
+        BufferPool::Lease first_buffer = buffers.Acquire();
+        BufferPool::Lease second_buffer = buffers.Acquire();
+        results[i] = CompareFiles(files[i].source_path, files[i].destination_path, first_buffer.Buffer(),
+                                  second_buffer.Buffer(), progress);
+        return 0;
+      });
+    }
+    for (size_t i = 0; i < files.size(); ++i) {
+      if (!comparisons[i].valid()) continue;
+      try {
+        comparisons[i].get();
+        ++stats.files;
+        if (results[i].difference != Difference::kNone) stats.differences.push_back(std::move(results[i]));
+      } catch (const CopyCancelled&) {
+      } catch (...) {
+        stats.errors.emplace_back(files[i].source_path, std::current_exception());
+      }
+    }
+  }
+  if (progress->is_cancelled) throw CopyCancelled();
+  stats.bytes_read = progress->bytes_copied - initial_bytes;
+  std::sort(stats.differences.begin(), stats.differences.end(),
+            [](const CompareResult& first, const CompareResult& second) { return first.first_path < second.first_path; });
+  return stats;
+}
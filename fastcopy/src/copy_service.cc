@@ -0,0 +1,123 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: copy_service.cc
+ * @brief: asynchronous copy and move service functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include "copy_service.h"
+#include "resume.h"
+#include "scope_exit.h"
+
+/**
+ * @brief Indica si el trabajo ha terminado, sin esperar.
+ */
+bool CopyHandle::IsDone() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->is_done;
+}
+
+/**
+ * @brief Espera a que termine el trabajo.
+ * @throw CopyCancelled Si se ha cancelado.
+ * @throw std::runtime_error Si la copia ha fallado.
+ *
+ * @return 0 si el trabajo ha terminado bien.
+ */
+int CopyHandle::Wait() const {
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->finished.wait(lock, [this] { return state_->is_done; });
+  if (state_->error) std::rethrow_exception(state_->error);
+  return 0;
+}
+
+/**
+ * @brief Pide que se cancele el trabajo. La copia se detiene en el siguiente bloque y se
+ *        borra lo que se hubiera escrito del destino; si ya había terminado no tiene efecto.
+ *        Solo guarda un atómico, así que se puede llamar desde un manejador de señal.
+ */
+void CopyHandle::Cancel() const {
+  state_->progress.is_cancelled = true;
+}
+
+/**
+ * @brief Crea el servicio. Los hilos no se lanzan hasta el primer trabajo.
+ * @param threads Número de copias que se hacen a la vez.
+ * @param max_buffers Número máximo de buffers de copia reservados a la vez.
+ * @throw std::system_error Si no se puede crear el eventfd del pool.
+ */
+CopyService::CopyService(size_t threads, size_t max_buffers)
+    : buffers_(kCopyBufferSize, max_buffers), pool_(threads) {}
+
+/**
+ * @brief Envía un trabajo de copia o movimiento.
+ * @param request Trabajo a realizar.
+ * @param on_complete Función a la que se llama al terminar (opcional).
+ *
+ * @return Referencia al trabajo, para esperarlo, consultar su progreso o cancelarlo.
+ */
+CopyHandle CopyService::Submit(CopyRequest request, CopyCallback on_complete) {
+  auto state = std::make_shared<CopyHandle::State>();
+  state->request = std::move(request);
+  CopyHandle handle(state);
+  pool_.Submit([this, handle, on_complete = std::move(on_complete)] {
+    Run(handle, on_complete);
+    return 0;
+  });
+  return handle;
+}
+
+/**
+ * @brief Hace la copia en un hilo del pool, guarda el resultado y avisa a quien espera.
+ * @param handle Trabajo a realizar.
+ * @param on_complete Función a la que se llama al terminar (puede estar vacía).
+ */
+void CopyService::Run(const CopyHandle& handle, const CopyCallback& on_complete) {
+  CopyHandle::State& state = *handle.state_;
+  std::exception_ptr error;
+  try {
+    if (state.progress.is_cancelled) throw CopyCancelled();
+    auto buffer = buffers_.Acquire();
+    const CopyRequest& request = state.request;
+    state.progress.rate_limiter = request.rate_limiter.get();
+    // Los hilos del pool se reutilizan: la prioridad se devuelve al acabar cada copia
+    int previous_priority = request.io_priority != 0 ? SetThreadIoPriority(request.io_priority) : 0;
+    auto restore_priority = ScopeExit([&request, previous_priority] {
+      if (request.io_priority == 0) return;
+      try {
+        SetThreadIoPriority(previous_priority);
+      } catch (...) {}
+    });
+    if (request.operation == CopyOperation::kMove) {
+      MoveFile(request.source_path, request.destination_path, &buffer.Buffer(), &state.progress);
+    } else if (request.checkpoint_bytes > 0) {
+      ResumableCopyFile(request.source_path, request.destination_path, request.preserve_all,
+                        request.checkpoint_bytes, &buffer.Buffer(), &state.progress);
+    } else {
+      CopyFile(request.source_path, request.destination_path, request.preserve_all, &buffer.Buffer(),
+               &state.progress);
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.error = error;
+    state.is_done = true;
+  }
+  state.finished.notify_all();
+  if (on_complete) {
+    // Un fallo de la función de aviso no debe tumbar el hilo del pool
+    try {
+      on_complete(handle, error);
+    } catch (...) {}
+  }
+}
@@ -0,0 +1,272 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: fanout.cc
+ * @brief: copy of one file to several destinations reading it once functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "fanout.h"
+#include "scope_exit.h"
+#include "throttle.h"
+#include "unique_handle.h"
+
+namespace {
+
+/**
+ * @brief Un destino de la copia. El hilo lector deja los datos del origen en su tubería y un
+ *        hilo propio los pasa al archivo, así que cada destino escribe a su ritmo y solo frena
+ *        a los demás cuando se le llena la tubería.
+ * [+] path = ruta del archivo de destino
+ * [+] file = archivo de destino
+ * [+] pipe_read = extremo de la tubería del que lee el hilo del destino
+ * [+] pipe_write = extremo en el que escribe el hilo lector
+ * [+] error = primer error al escribir el destino (nulo si ha ido bien)
+ * [+] writer = hilo que vacía la tubería en el archivo
+ */
+struct Branch {
+  std::string path;
+  UniqueFd file;
+  UniqueFd pipe_read;
+  UniqueFd pipe_write;
+  std::exception_ptr error;
+  std::thread writer;
+};
+
+/**
+ * @brief Agranda una tubería. Si no se puede hasta size (sin privilegios el máximo es
+ *        /proc/sys/fs/pipe-max-size, 1 MiB por defecto), se intenta con kCopyBufferSize.
+ * @param fd Cualquiera de los extremos de la tubería.
+ * @param size Capacidad deseada en bytes.
+ *
+ * @return Capacidad que tiene la tubería.
+ */
+size_t GrowPipe(int fd, size_t size) {
+  if (fcntl(fd, F_SETPIPE_SZ, size) < 0) fcntl(fd, F_SETPIPE_SZ, std::min(size, kCopyBufferSize));
+  return fcntl(fd, F_GETPIPE_SZ);
+}
+
+/**
+ * @brief Mueve bytes de una tubería a otro descriptor con splice, esperando si el destino está lleno.
+ * @param source_fd Tubería de origen, que tiene al menos size bytes.
+ * @param destination_fd Descriptor de destino.
+ * @param size Bytes a mover.
+ * @throw std::system_error Si falla splice.
+ */
+void SpliceAll(int source_fd, int destination_fd, size_t size) {
+  while (size > 0) {
+    ssize_t bytes_moved = splice(source_fd, nullptr, destination_fd, nullptr, size, SPLICE_F_MOVE);
+    if (bytes_moved < 0 && errno == EINTR) continue;
+    if (bytes_moved <= 0) throw std::system_error(bytes_moved < 0 ? errno : EIO, std::system_category(), "splice");
+    size -= bytes_moved;
+  }
+}
+
+/**
+ * @brief Bucle del hilo de un destino: pasa al archivo lo que llega a su tubería hasta que el
+ *        lector la cierra. Usa splice y, si el sistema de archivos del destino no lo admite,
+ *        read y write. Si la escritura falla, guarda el primer error y sigue vaciando la tubería
+ *        sin escribir hasta que se cierra, para no bloquear al lector ni al resto de destinos.
+ * @param branch Destino.
+ */
+void DrainBranch(Branch& branch) {
+  bool use_splice = true;
+  std::vector<uint8_t> buffer;
+  while (true) {
+    try {
+      if (use_splice && branch.error == nullptr) {
+        ssize_t bytes_moved = splice(branch.pipe_read.Get(), nullptr, branch.file.Get(), nullptr, kFanoutWindowSize,
+                                     SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (bytes_moved > 0) continue;
+        if (bytes_moved == 0) return;
+        if (errno == EINTR) continue;
+        // Lo que no se ha podido mover sigue en la tubería, así que se puede cambiar a read y write
+        if (errno != EINVAL && errno != ENOSYS && errno != EOPNOTSUPP) {
+          throw std::system_error(errno, std::system_category(), branch.path);
+        }
+        use_splice = false;
+      }
+      if (buffer.empty()) buffer.resize(kCopyBufferSize);
+      ssize_t bytes_read = ReadFile(branch.pipe_read.Get(), buffer);
+      if (bytes_read == 0) return;
+      if (branch.error == nullptr) WriteFile(branch.file.Get(), buffer.data(), bytes_read);
+    } catch (...) {
+      if (branch.error == nullptr) branch.error = std::current_exception();
+    }
+  }
+}
+
+/**
+ * @brief Lee el origen una vez y reparte cada bloque entre las tuberías de los destinos. El
+ *        bloque entra en una tubería central (con splice desde el archivo, sin copiarlo); tee
+ *        lo duplica en una tubería auxiliar vacía, que se vacía con splice en la de cada
+ *        destino, y a la del último se mueve el original. tee no copia los datos, solo
+ *        referencias a las mismas páginas, y la auxiliar tiene el doble de capacidad que la
+ *        central para que tee nunca se quede a medias.
+ * @param source_fd Archivo de origen.
+ * @param branches Destinos, con el archivo y la tubería ya abiertos.
+ * @param progress Progreso de la copia (puede ser nulo).
+ * @throw std::system_error Si falla la lectura del origen o el reparto.
+ * @throw CopyCancelled Si se cancela la copia.
+ *
+ * @return Bytes leídos del origen.
+ */
+uint64_t Distribute(int source_fd, std::vector<Branch>& branches, CopyProgress* progress) {
+  UniqueFd hub_read, hub_write, scratch_read, scratch_write;
+  OpenPipe(hub_read, hub_write);
+  OpenPipe(scratch_read, scratch_write);
+  size_t scratch_capacity = GrowPipe(scratch_read.Get(), 2 * kCopyBufferSize);
+  size_t hub_capacity = GrowPipe(hub_read.Get(), scratch_capacity / 2);
+  if (hub_capacity > scratch_capacity / 2) throw std::runtime_error("ERROR: Could not size the copy pipes!");
+  const size_t chunk_size = ThrottledChunkSize(progress, hub_capacity);
+
+  for (auto& branch : branches) branch.writer = std::thread(DrainBranch, std::ref(branch));
+  // Al cerrar las tuberías los hilos de los destinos acaban lo que tienen y terminan
+  auto join_writers = ScopeExit([&branches] {
+    for (auto& branch : branches) {
+      branch.pipe_write.Reset();
+      if (branch.writer.joinable()) branch.writer.join();
+    }
+  });
+
+  std::vector<uint8_t> buffer;
+  uint64_t bytes_read = 0;
+  while (true) {
+    if (progress != nullptr && progress->is_cancelled) throw CopyCancelled();
+    ssize_t chunk;
+    if (buffer.empty()) {
+      chunk = splice(source_fd, nullptr, hub_write.Get(), nullptr, chunk_size, SPLICE_F_MOVE);
+      if (chunk < 0 && errno == EINTR) continue;
+      if (chunk < 0 && bytes_read == 0 && (errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP)) {
+        buffer.resize(chunk_size);
+        continue;
+      }
+      if (chunk < 0) throw std::system_error(errno, std::system_category());
+    } else {
+      // La tubería central está vacía y el bloque cabe, así que write no se bloquea
+      chunk = ReadFile(source_fd, buffer);
+      WriteFile(hub_write.Get(), buffer.data(), chunk);
+    }
+    if (chunk == 0) break;
+    for (size_t i = 0; i + 1 < branches.size(); ++i) {
+      ssize_t bytes_teed;
+      do {
+        bytes_teed = tee(hub_read.Get(), scratch_write.Get(), chunk, 0);
+      } while (bytes_teed < 0 && errno == EINTR);
+      if (bytes_teed < 0) throw std::system_error(errno, std::system_category(), "tee");
+      if (bytes_teed != chunk) throw std::runtime_error("ERROR: Short tee between the copy pipes!");
+      SpliceAll(scratch_read.Get(), branches[i].pipe_write.Get(), chunk);
+    }
+    SpliceAll(hub_read.Get(), branches.back().pipe_write.Get(), chunk);
+    bytes_read += chunk;
+    if (progress != nullptr) progress->bytes_copied += chunk;
+    ThrottleCopy(progress, chunk);
+  }
+  return bytes_read;
+}
+
+}  // namespace
+
+/**
+ * @brief Copia un archivo a varios destinos leyéndolo una sola vez. Cada destino se escribe en
+ *        su propio hilo desde una tubería de hasta kFanoutWindowSize bytes, así que uno lento
+ *        solo frena a los demás cuando se queda una tubería entera atrás. Si falla un destino
+ *        (por ejemplo, porque se llena su disco) se borra y los demás siguen.
+ * @param src_path Ruta del archivo de origen.
+ * @param dst_paths Rutas de destino (si alguna es un directorio, el archivo conserva su nombre).
+ * @param preserve_all Si se copian los permisos, el propietario y las fechas del origen.
+ * @param progress Si no es nulo, se actualiza con los bytes leídos del origen, permite cancelar
+ *                 la copia (se borran todos los destinos) y limita su velocidad.
+ * @throw std::runtime_error Si no se puede leer el origen o dos destinos son el mismo archivo.
+ * @throw CopyCancelled Si se cancela la copia.
+ *
+ * @return Los destinos y los errores de los que han fallado.
+ */
+FanoutStats CopyToMany(const std::string& src_path, const std::vector<std::string>& dst_paths, bool preserve_all,
+                       CopyProgress* progress) {
+  try {
+    struct stat source_stat = StatSource(src_path);
+    FanoutStats stats;
+    for (const auto& dst_path : dst_paths) {
+      stats.destinations.push_back(ResolveDestination(src_path, dst_path, source_stat));
+    }
+    UniqueFd source_fd = OpenFile(src_path, O_RDONLY);
+    posix_fadvise(source_fd.Get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Los destinos se abren sin O_TRUNC y se comparan por dispositivo e inodo, porque dos rutas
+    // distintas ("out" y "./out", o un enlace) pueden ser el mismo archivo. Solo se vacían
+    // cuando se sabe que no hay ninguno repetido
+    std::vector<Branch> branches;
+    std::vector<std::pair<dev_t, ino_t>> identities;
+    branches.reserve(stats.destinations.size());
+    for (const auto& destination : stats.destinations) {
+      try {
+        Branch branch;
+        branch.path = destination;
+        branch.file = OpenFile(destination, O_WRONLY | O_CREAT, 0666);
+        struct stat destination_stat{};
+        if (fstat(branch.file.Get(), &destination_stat) < 0) {
+          throw std::system_error(errno, std::system_category(), destination);
+        }
+        for (size_t i = 0; i < identities.size(); ++i) {
+          if (identities[i].first == destination_stat.st_dev && identities[i].second == destination_stat.st_ino) {
+            throw std::runtime_error("ERROR: '" + destination + "' is the same file as '" + branches[i].path + "'!");
+          }
+        }
+        OpenPipe(branch.pipe_read, branch.pipe_write);
+        GrowPipe(branch.pipe_read.Get(), kFanoutWindowSize);
+        identities.emplace_back(destination_stat.st_dev, destination_stat.st_ino);
+        branches.push_back(std::move(branch));
+      } catch (const std::system_error&) {
+        stats.errors.emplace_back(destination, std::current_exception());
+      }
+    }
+    for (auto branch = branches.begin(); branch != branches.end();) {
+      if (ftruncate(branch->file.Get(), 0) == 0) {
+        ++branch;
+        continue;
+      }
+      std::system_error error(errno, std::system_category(), branch->path);
+      stats.errors.emplace_back(branch->path, std::make_exception_ptr(error));
+      branch = branches.erase(branch);
+    }
+    if (branches.empty()) return stats;
+
+    if (progress != nullptr) progress->total_bytes = source_stat.st_size;
+    try {
+      stats.bytes_read = Distribute(source_fd.Get(), branches, progress);
+    } catch (...) {
+      for (const auto& branch : branches) unlink(branch.path.c_str());
+      throw;
+    }
+    for (auto& branch : branches) {
+      if (branch.error != nullptr) {
+        unlink(branch.path.c_str());
+        stats.errors.emplace_back(branch.path, branch.error);
+      } else if (preserve_all) {
+        CopyAttributes(branch.path, source_stat);
+      }
+    }
+    return stats;
+  } catch (const CopyCancelled&) {
+    throw;
+  } catch (const std::exception& error) {
+    std::throw_with_nested(std::runtime_error("ERROR: Copying the file!"));
+  }
+}
@@ -0,0 +1,466 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: fastcopy.cc
+ * @brief: file copy and move functions shared by the shell and copyfile
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <system_error>
+
+#include "compare.h"
+#include "fastcopy.h"
+#include "unique_handle.h"
+#include "throttle.h"
+#include "write_plan.h"
+
+namespace {
+
+/**
+ * @brief Lanza CopyCancelled si se ha pedido cancelar la copia.
+ * @param progress Progreso de la copia (puede ser nulo).
+ */
+void CheckCancelled(const CopyProgress* progress) {
+  if (progress != nullptr && progress->is_cancelled) throw CopyCancelled();
+}
+
+}  // namespace
+
+/**
+ * @brief Calcula la ruta final de una copia o un movimiento: si el destino es un directorio,
+ *        el archivo conserva su nombre dentro de él.
+ * @param source_path Ruta del archivo de origen.
+ * @param destination_path Ruta de destino indicada.
+ * @param source_stat stat del archivo de origen.
+ * @throw std::runtime_error Si no existe el directorio de destino o el destino es el propio origen.
+ *
+ * @return Ruta del archivo de destino.
+ */
+std::string ResolveDestination(const std::string& source_path, const std::string& destination_path,
+                               const struct stat& source_stat) {
+  // dirname y basename pueden modificar la cadena que reciben, así que se les pasa una copia
+  std::string destination_path_copy = destination_path;
+  std::string dst_dir_name = dirname(destination_path_copy.data());
+  struct stat dst_dir_name_stat{};
+  if (stat(dst_dir_name.c_str(), &dst_dir_name_stat) == -1) {
+    throw std::runtime_error("ERROR: Destination path does not exist!");
+  }
+  std::string resolved_path = destination_path;
+  struct stat destination_stat{};
+  if (stat(resolved_path.c_str(), &destination_stat) == 0 && S_ISDIR(destination_stat.st_mode)) {
+    std::string source_path_copy = source_path;
+    resolved_path += "/" + std::string(basename(source_path_copy.data()));
+  }
+  // Se compara con el archivo que se va a abrir, no con el directorio que lo contiene
+  if (stat(resolved_path.c_str(), &destination_stat) == 0 && source_stat.st_dev == destination_stat.st_dev &&
+      source_stat.st_ino == destination_stat.st_ino) {
+    throw std::runtime_error("'" + source_path + "' is the same file as '" + destination_path + "'");
+  }
+  return resolved_path;
+}
+
+/**
+ * @brief Obtiene el stat del archivo de origen, que debe ser un archivo regular.
+ * @param source_path Ruta del archivo de origen.
+ * @throw std::runtime_error Si no existe o no es un archivo regular.
+ */
+struct stat StatSource(const std::string& source_path) {
+  struct stat source_stat{};
+  if (stat(source_path.c_str(), &source_stat) == -1 || !S_ISREG(source_stat.st_mode)) {
+    throw std::runtime_error("ERROR: Source path does not exist or source file is not a regular file!");
+  }
+  return source_stat;
+}
+
+/**
+ * @brief Lee de un archivo en un buffer ya reservado, sin reservar memoria nueva.
+ * @param fd Descriptor del archivo.
+ * @param buffer Buffer donde se guardan los datos; se leen como mucho buffer.size() bytes.
+ * @param max_bytes Máximo de bytes a leer si es menor que el buffer.
+ * @throw std::system_error Si se produce un error al leer el archivo.
+ *
+ * @return Número de bytes leídos (0 al final del archivo).
+ */
+ssize_t ReadFile(const int fd, std::vector<uint8_t>& buffer, size_t max_bytes) {
+  ssize_t bytes_read;
+  do {
+    bytes_read = read(fd, buffer.data(), std::min(buffer.size(), max_bytes));
+  } while (bytes_read < 0 && errno == EINTR);
+  if (bytes_read < 0) throw std::system_error(errno, std::system_category());
+  return bytes_read;
+}
+
+/**
+ * @brief Escribe un bloque de bytes en un archivo, reintentando las escrituras parciales.
+ * @param fd Descriptor del archivo.
+ * @param data Bytes a escribir.
+ * @param size Número de bytes a escribir.
+ * @throw std::system_error Si se produce un error al escribir el archivo.
+ */
+void WriteFile(int fd, const uint8_t* data, size_t size) {
+  while (size > 0) {
+    ssize_t bytes_written = write(fd, data, size);
+    if (bytes_written < 0 && errno == EINTR) continue;
+    if (bytes_written < 0) throw std::system_error(errno, std::system_category());
+    data += bytes_written;
+    size -= bytes_written;
+  }
+}
+
+/**
+ * @brief Copia el resto de un archivo regular o de una tubería sin pasar por espacio de
+ *        usuario: con splice si alguno de los dos es una tubería, con copy_file_range si los dos
+ *        son archivos regulares y con sendfile en otro caso (por ejemplo, hacia un socket).
+ *        Terminales y sockets como origen no se pueden copiar así.
+ * @param source_fd Descriptor de origen (desde su posición actual; si es una tubería, hasta
+ *                  que se cierre su otro extremo).
+ * @param destination_fd Descriptor de destino.
+ * @param progress Si no es nulo, se actualiza con los bytes copiados, se comprueba si se ha
+ *                 cancelado y se aplica su límite de velocidad.
+ *
+ * @return false si el kernel no permite la copia entre estos descriptores y no se ha copiado nada
+ *         (hay que hacerla con read y write), true si se ha copiado todo.
+ * @throw std::system_error Si falla la copia cuando ya se había copiado una parte.
+ * @throw CopyCancelled Si se cancela la copia.
+ */
+bool KernelCopy(int source_fd, int destination_fd, CopyProgress* progress) {
+  struct stat source_stat{};
+  struct stat destination_stat{};
+  if (fstat(source_fd, &source_stat) < 0 || fstat(destination_fd, &destination_stat) < 0) return false;
+  bool is_pipe = S_ISFIFO(source_stat.st_mode) || S_ISFIFO(destination_stat.st_mode);
+  // Ni copy_file_range ni splice admiten un destino abierto con O_APPEND (>>)
+  if ((!S_ISREG(source_stat.st_mode) && !S_ISFIFO(source_stat.st_mode)) ||
+      (fcntl(destination_fd, F_GETFL) & O_APPEND) != 0) {
+    return false;
+  }
+  // Se copia por bloques para poder actualizar el progreso y atender las cancelaciones
+  const size_t kChunkSize = ThrottledChunkSize(progress, 8 * kCopyBufferSize);
+  bool is_first = true;
+  while (true) {
+    CheckCancelled(progress);
+    ssize_t bytes_copied;
+    if (is_pipe) {
+      bytes_copied = splice(source_fd, nullptr, destination_fd, nullptr, kChunkSize, SPLICE_F_MOVE);
+    } else if (S_ISREG(destination_stat.st_mode)) {
+      bytes_copied = copy_file_range(source_fd, nullptr, destination_fd, nullptr, kChunkSize, 0);
+    } else {
+      bytes_copied = sendfile(destination_fd, source_fd, nullptr, kChunkSize);
+    }
+    if (bytes_copied < 0) {
+      if (errno == EINTR) continue;
+      bool is_unsupported = errno == EXDEV || errno == EINVAL || errno == EBADF || errno == ENOSYS || errno == EOPNOTSUPP;
+      if (is_first && is_unsupported) return false;
+      throw std::system_error(errno, std::system_category());
+    }
+    if (bytes_copied == 0) return true;
+    is_first = false;
+    if (progress != nullptr) progress->bytes_copied += bytes_copied;
+    ThrottleCopy(progress, bytes_copied);
+  }
+}
+
+/**
+ * @brief Copia el resto de un archivo por bloques con read y write.
+ * @param source_fd Descriptor de origen (desde su posición actual).
+ * @param destination_fd Descriptor de destino.
+ * @param buffer Buffer para la copia.
+ * @param progress Si no es nulo, se actualiza con los bytes copiados, se comprueba si se ha
+ *                 cancelado y se aplica su límite de velocidad.
+ * @throw std::system_error Si se produce un error al leer o escribir.
+ * @throw CopyCancelled Si se cancela la copia.
+ */
+void ReadWriteCopy(int source_fd, int destination_fd, std::vector<uint8_t>& buffer, CopyProgress* progress) {
+  while (true) {
+    CheckCancelled(progress);
+    ssize_t bytes_read = ReadFile(source_fd, buffer, ThrottledChunkSize(progress, buffer.size()));
+    if (bytes_read == 0) break;
+    WriteFile(destination_fd, buffer.data(), bytes_read);
+    if (progress != nullptr) progress->bytes_copied += bytes_read;
+    ThrottleCopy(progress, bytes_read);
+  }
+}
+
+/**
+ * @brief Copia el resto de un archivo regular escribiendo directamente desde una proyección en
+ *        memoria del origen, por ventanas de kMmapWindowSize. Cada ventana se proyecta con
+ *        MAP_POPULATE (el kernel la lee de una vez) y MADV_SEQUENTIAL (libera las páginas ya
+ *        escritas), así que no hay copia intermedia en un buffer de usuario. Si el origen se
+ *        trunca mientras está proyectado, el proceso recibe SIGBUS: solo debe usarse con
+ *        archivos que nadie más está modificando.
+ * @param source_fd Descriptor de origen (desde su posición actual).
+ * @param destination_fd Descriptor de destino.
+ * @param progress Si no es nulo, se actualiza con los bytes copiados, se comprueba si se ha
+ *                 cancelado y se aplica su límite de velocidad.
+ * @throw std::system_error Si falla la copia cuando ya se había copiado una parte.
+ * @throw CopyCancelled Si se cancela la copia.
+ *
+ * @return false si el origen no se puede proyectar y no se ha copiado nada, true si se ha copiado todo.
+ */
+bool MmapCopy(int source_fd, int destination_fd, CopyProgress* progress) {
+  struct stat source_stat{};
+  if (fstat(source_fd, &source_stat) < 0 || !S_ISREG(source_stat.st_mode)) return false;
+  off_t start = lseek(source_fd, 0, SEEK_CUR);
+  if (start < 0) return false;
+  const uint64_t page_size = sysconf(_SC_PAGESIZE);
+  const uint64_t size = source_stat.st_size;
+  uint64_t offset = start;
+  while (offset < size) {
+    CheckCancelled(progress);
+    // mmap solo admite posiciones alineadas a página
+    uint64_t window_start = offset - offset % page_size;
+    size_t window_size = std::min<uint64_t>(kMmapWindowSize, size - window_start);
+    UniqueMapping mapping;
+    try {
+      mapping = MapFile(source_fd, window_start, window_size, MAP_PRIVATE | MAP_POPULATE);
+    } catch (const std::system_error&) {
+      if (offset == static_cast<uint64_t>(start)) return false;
+      throw;
+    }
+    madvise(mapping.Get().address, window_size, MADV_SEQUENTIAL);
+    uint64_t window_end = window_start + window_size;
+    while (offset < window_end) {
+      CheckCancelled(progress);
+      size_t chunk = std::min<uint64_t>(ThrottledChunkSize(progress, 8 * kCopyBufferSize), window_end - offset);
+      WriteFile(destination_fd, mapping.Get().Data() + (offset - window_start), chunk);
+      offset += chunk;
+      if (progress != nullptr) progress->bytes_copied += chunk;
+      ThrottleCopy(progress, chunk);
+    }
+  }
+  // Como con read, el descriptor queda al final de lo copiado
+  lseek(source_fd, offset, SEEK_SET);
+  return true;
+}
+
+/**
+ * @brief Copia el resto de un archivo con el método indicado. Si el kernel o mmap no admiten
+ *        estos descriptores se copia con read y write. Permite a los benchmarks comparar los métodos.
+ * @param source_fd Descriptor de origen (desde su posición actual).
+ * @param destination_fd Descriptor de destino.
+ * @param engine Método de copia.
+ * @param buffer Buffer para read y write. Si es nulo y hace falta, se reserva uno propio.
+ * @param progress Si no es nulo, se actualiza con los bytes copiados, se comprueba si se ha
+ *                 cancelado y se aplica su límite de velocidad.
+ * @throw std::system_error Si se produce un error al copiar.
+ * @throw CopyCancelled Si se cancela la copia.
+ */
+void CopyContents(int source_fd, int destination_fd, CopyEngine engine, std::vector<uint8_t>* buffer,
+                  CopyProgress* progress) {
+  if (engine == CopyEngine::kKernel && KernelCopy(source_fd, destination_fd, progress)) return;
+  if (engine == CopyEngine::kMmap && MmapCopy(source_fd, destination_fd, progress)) return;
+  std::vector<uint8_t> own_buffer;
+  if (buffer == nullptr) {
+    own_buffer.resize(kCopyBufferSize);
+    buffer = &own_buffer;
+  }
+  ReadWriteCopy(source_fd, destination_fd, *buffer, progress);
+}
+
+/**
+ * @brief Compara el contenido de dos archivos regulares proyectándolos en memoria por ventanas,
+ *        sin leerlos a buffers. Como en MmapCopy, ninguno debe truncarse mientras tanto.
+ * @param first_fd Descriptor del primer archivo.
+ * @param second_fd Descriptor del segundo archivo.
+ * @param is_equal Donde se guarda si los dos tienen el mismo contenido.
+ * @throw std::system_error Si falla una proyección cuando ya se había comparado una parte.
+ *
+ * @return false si alguno no se puede proyectar (hay que compararlos con read).
+ */
+bool MmapCompare(int first_fd, int second_fd, bool& is_equal) {
+  struct stat first_stat{};
+  struct stat second_stat{};
+  if (fstat(first_fd, &first_stat) < 0 || fstat(second_fd, &second_stat) < 0 || !S_ISREG(first_stat.st_mode) ||
+      !S_ISREG(second_stat.st_mode)) {
+    return false;
+  }
+  is_equal = first_stat.st_size == second_stat.st_size;
+  const uint64_t size = first_stat.st_size;
+  for (uint64_t offset = 0; is_equal && offset < size; offset += kMmapWindowSize) {
+    size_t window_size = std::min<uint64_t>(kMmapWindowSize, size - offset);
+    UniqueMapping first_mapping;
+    UniqueMapping second_mapping;
+    try {
+      first_mapping = MapFile(first_fd, offset, window_size, MAP_PRIVATE | MAP_POPULATE);
+      second_mapping = MapFile(second_fd, offset, window_size, MAP_PRIVATE | MAP_POPULATE);
+    } catch (const std::system_error&) {
+      if (offset == 0) return false;
+      throw;
+    }
+    madvise(first_mapping.Get().address, window_size, MADV_SEQUENTIAL);
+    madvise(second_mapping.Get().address, window_size, MADV_SEQUENTIAL);
+    is_equal =
+        FindFirstDifference(first_mapping.Get().Data(), second_mapping.Get().Data(), window_size) == window_size;
+  }
+  return true;
+}
+
+/**
+ * @brief Copia al destino los permisos, el propietario y las fechas de acceso y modificación del origen.
+ * @param destination_path Ruta del archivo de destino.
+ * @param source_stat stat del archivo de origen.
+ */
+void CopyAttributes(const std::string& destination_path, const struct stat& source_stat) {
+  chmod(destination_path.c_str(), source_stat.st_mode);
+  chown(destination_path.c_str(), source_stat.st_uid, source_stat.st_gid);
+  struct utimbuf times{};
+  times.actime = source_stat.st_atim.tv_sec;
+  times.modtime = source_stat.st_mtim.tv_sec;
+  utime(destination_path.c_str(), &times);
+}
+
+/**
+ * @brief Copia un archivo de una ruta de origen a una ruta de destino. Si el destino es un
+ *        archivo regular se copia con PlannedCopy: espacio reservado de antemano, escrituras
+ *        alineadas y huecos conservados.
+ * @param source_path Ruta del archivo de origen.
+ * @param destination_path Ruta del archivo de destino.
+ * @param preserve_all Indica si se deben preservar todas las propiedades del archivo de origen (permisos, propietario, fechas de acceso y modificación).
+ * @param buffer Buffer para la copia (por ejemplo, uno prestado por el BufferPool). Si es nulo se reserva uno propio.
+ * @param progress Si no es nulo, se actualiza con los bytes copiados según avanza la copia,
+ *                 permite cancelarla y limita su velocidad. Una copia cancelada o fallida no
+ *                 deja el destino a medias.
+ * @throw std::runtime_error Si se produce un error al copiar el archivo.
+ * @throw CopyCancelled Si se cancela la copia.
+ */
+void CopyFile(const std::string& source_path, const std::string& destination_path, bool preserve_all,
+              std::vector<uint8_t>* buffer, CopyProgress* progress) {
+  try {
+    struct stat source_path_stat = StatSource(source_path);
+    std::string destination_path_copy = ResolveDestination(source_path, destination_path, source_path_stat);
+
+    UniqueFd source_fd = OpenFile(source_path, O_RDONLY);
+    UniqueFd destination_fd = OpenFile(destination_path_copy, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+    if (progress != nullptr) progress->total_bytes = source_path_stat.st_size;
+    try {
+      // El destino puede no ser un archivo regular (por ejemplo, /dev/null)
+      struct stat destination_stat{};
+      if (fstat(destination_fd.Get(), &destination_stat) == 0 && S_ISREG(destination_stat.st_mode)) {
+        PlannedCopy(source_fd.Get(), destination_fd.Get(), buffer, progress);
+      } else {
+        CopyContents(source_fd.Get(), destination_fd.Get(), CopyEngine::kKernel, buffer, progress);
+      }
+    } catch (...) {
+      // Un archivo regular a medias podría parecer completo; /dev/null y similares no se tocan
+      struct stat destination_stat{};
+      if (fstat(destination_fd.Get(), &destination_stat) == 0 && S_ISREG(destination_stat.st_mode)) {
+        unlink(destination_path_copy.c_str());
+      }
+      throw;
+    }
+
+    if (preserve_all) CopyAttributes(destination_path_copy, source_path_stat);
+  } catch (const CopyCancelled&) {
+    throw;
+  } catch (const std::exception& error) {
+    std::throw_with_nested(std::runtime_error("ERROR: Copying the file!"));
+  }
+}
+
+/**
+ * @brief Copia entre rutas en las que kStandardStream ("-") es la entrada estándar (como
+ *        origen) o la salida estándar (como destino), para usar la copia en una tubería:
+ *        productor | copyfile - archivo. El origen puede ser cualquier cosa que se pueda leer.
+ *        Con tuberías y archivos los datos se mueven con splice dentro del kernel (KernelCopy);
+ *        con terminales y sockets, por bloques con read y write.
+ * @param source_path Ruta del origen o "-".
+ * @param destination_path Ruta del destino o "-". Si el origen es "-" no puede ser un directorio.
+ * @param buffer Buffer para la copia si no se puede hacer en el kernel (nulo para reservar uno propio).
+ * @param progress Si no es nulo, se actualiza con los bytes copiados, permite cancelar la copia
+ *                 (se borra el destino si es un archivo) y limita su velocidad.
+ * @throw std::runtime_error Si se produce un error al copiar.
+ * @throw CopyCancelled Si se cancela la copia.
+ */
+void CopyStream(const std::string& source_path, const std::string& destination_path, std::vector<uint8_t>* buffer,
+                CopyProgress* progress) {
+  try {
+    const bool is_standard_input = source_path == kStandardStream;
+    const bool is_standard_output = destination_path == kStandardStream;
+    UniqueFd source_file;
+    if (!is_standard_input) source_file = OpenFile(source_path, O_RDONLY);
+    const int source_fd = is_standard_input ? STDIN_FILENO : source_file.Get();
+    struct stat source_stat{};
+    if (fstat(source_fd, &source_stat) < 0) throw std::system_error(errno, std::system_category(), source_path);
+
+    UniqueFd destination_file;
+    std::string resolved_path;
+    if (is_standard_output) {
+      struct stat output_stat{};
+      if (fstat(STDOUT_FILENO, &output_stat) == 0 && S_ISREG(output_stat.st_mode) &&
+          output_stat.st_dev == source_stat.st_dev && output_stat.st_ino == source_stat.st_ino) {
+        throw std::runtime_error("'" + source_path + "' is the same file as the standard output");
+      }
+    } else {
+      struct stat destination_stat{};
+      if (is_standard_input && stat(destination_path.c_str(), &destination_stat) == 0 &&
+          S_ISDIR(destination_stat.st_mode)) {
+        throw std::runtime_error("ERROR: The standard input can not be copied into a directory!");
+      }
+      // Si la entrada estándar es un archivo, se comprueba también que no sea el propio destino
+      resolved_path = ResolveDestination(source_path, destination_path, source_stat);
+      destination_file = OpenFile(resolved_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    }
+    const int destination_fd = is_standard_output ? STDOUT_FILENO : destination_file.Get();
+
+    if (progress != nullptr && S_ISREG(source_stat.st_mode)) progress->total_bytes = source_stat.st_size;
+    try {
+      CopyContents(source_fd, destination_fd, CopyEngine::kKernel, buffer, progress);
+    } catch (const CopyCancelled&) {
+      if (!is_standard_output) unlink(resolved_path.c_str());
+      throw;
+    }
+  } catch (const CopyCancelled&) {
+    throw;
+  } catch (const std::exception& error) {
+    std::throw_with_nested(std::runtime_error("ERROR: Copying the file!"));
+  }
+}
+
+/**
+ * @brief Mueve un archivo de una ruta de origen a una ruta de destino. Dentro del mismo
+ *        sistema de archivos basta con rename; entre sistemas de archivos distintos se copia
+ *        con sus atributos y se borra el origen.
+ * @param source_path Ruta del archivo de origen.
+ * @param destination_path Ruta del archivo de destino.
+ * @param buffer Buffer para la copia si el archivo cambia de sistema de archivos (nulo para reservar uno propio).
+ * @param progress Si no es nulo, se actualiza con los bytes copiados y permite cancelar la copia.
+ * @throw std::runtime_error Si se produce un error al mover el archivo.
+ * @throw CopyCancelled Si se cancela la copia (el origen no se borra).
+ */
+void MoveFile(const std::string& source_path, const std::string& destination_path,
+              std::vector<uint8_t>* buffer, CopyProgress* progress) {
+  try {
+    struct stat source_path_stat = StatSource(source_path);
+    std::string destination_path_copy = ResolveDestination(source_path, destination_path, source_path_stat);
+    CheckCancelled(progress);
+    if (progress != nullptr) progress->total_bytes = source_path_stat.st_size;
+    if (rename(source_path.c_str(), destination_path_copy.c_str()) == 0) {
+      if (progress != nullptr) progress->bytes_copied = source_path_stat.st_size;
+      return;
+    }
+    if (errno != EXDEV) throw std::system_error(errno, std::system_category(), destination_path_copy);
+    CopyFile(source_path, destination_path_copy, true, buffer, progress);
+    if (unlink(source_path.c_str()) < 0) throw std::system_error(errno, std::system_category(), source_path);
+  } catch (const CopyCancelled&) {
+    throw;
+  } catch (const std::exception& error) {
+    std::throw_with_nested(std::runtime_error("ERROR: Moving the file!"));
+  }
+}
@@ -0,0 +1,126 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: io_pool.cc
+ * @brief: I/O worker pool and shared buffer pool functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <system_error>
+
+#include "io_pool.h"
+
+/**
+ * @brief Presta un buffer del pool, reservándolo si aún no se ha llegado al máximo.
+ *
+ * @return Buffer prestado, que vuelve al pool cuando se destruye.
+ */
+BufferPool::Lease BufferPool::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  buffer_released_.wait(lock, [this] { return !free_buffers_.empty() || allocated_buffers_ < max_buffers_; });
+  if (!free_buffers_.empty()) {
+    auto buffer = std::move(free_buffers_.back());
+    free_buffers_.pop_back();
+    return Lease(*this, std::move(buffer));
+  }
+  ++allocated_buffers_;
+  lock.unlock();
+  return Lease(*this, std::make_unique<std::vector<uint8_t>>(buffer_size_));
+}
+
+/**
+ * @brief Devuelve un buffer al pool para que lo reutilice otra copia.
+ * @param buffer Buffer a devolver.
+ */
+void BufferPool::Release(std::unique_ptr<std::vector<uint8_t>> buffer) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_buffers_.push_back(std::move(buffer));
+  }
+  buffer_released_.notify_one();
+}
+
+/**
+ * @brief Crea el pool y su eventfd. Los hilos no se lanzan hasta la primera tarea.
+ * @param threads Número de hilos de trabajo.
+ * @throw std::system_error Si no se puede crear el eventfd.
+ */
+IoPool::IoPool(size_t threads) : threads_count_(threads == 0 ? 1 : threads) {
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ < 0) throw std::system_error(errno, std::system_category());
+}
+
+/**
+ * @brief Termina las tareas pendientes, espera a los hilos y cierra el eventfd.
+ */
+IoPool::~IoPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  task_available_.notify_all();
+  for (auto& thread : threads_) thread.join();
+  close(event_fd_);
+}
+
+/**
+ * @brief Encola una tarea en el pool.
+ * @param task Tarea a ejecutar. Devuelve su valor de salida; las excepciones quedan en el futuro.
+ *
+ * @return Futuro con el valor de salida de la tarea.
+ */
+std::shared_future<int> IoPool::Submit(std::function<int()> task) {
+  std::packaged_task<int()> packaged_task(std::move(task));
+  std::shared_future<int> result = packaged_task.get_future().share();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(packaged_task));
+    if (threads_.empty()) {
+      for (size_t i = 0; i < threads_count_; ++i) threads_.emplace_back(&IoPool::WorkerLoop, this);
+    }
+  }
+  task_available_.notify_one();
+  return result;
+}
+
+/**
+ * @brief Vacía el contador del eventfd una vez atendidas las tareas terminadas.
+ */
+void IoPool::ClearEvents() {
+  uint64_t completed;
+  read(event_fd_, &completed, sizeof(completed));
+}
+
+/**
+ * @brief Bucle de cada hilo: saca tareas de la cola, las ejecuta y avisa por el eventfd.
+ */
+void IoPool::WorkerLoop() {
+  // Las señales las atiende el hilo principal (en la shell, SIGCHLD llega por su signalfd)
+  sigset_t mask;
+  sigfillset(&mask);
+  pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+  while (true) {
+    std::packaged_task<int()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_available_.wait(lock, [this] { return is_stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+    uint64_t completed = 1;
+    write(event_fd_, &completed, sizeof(completed));
+  }
+}
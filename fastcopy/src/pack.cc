@@ -0,0 +1,475 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: pack.cc
+ * @brief: streaming pack and unpack of directory trees functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "fastcopy.h"
+#include "pack.h"
+#include "unique_handle.h"
+
+namespace {
+
+constexpr char kPackMagic[] = "FCPACK1\n";
+constexpr size_t kPackMagicSize = sizeof(kPackMagic) - 1;
+
+// Tamaño del buffer de getdents64: miles de entradas por llamada
+constexpr size_t kDirentBufferSize = 256ul * 1024;
+
+/**
+ * @brief Entrada de directorio tal y como la devuelve getdents64.
+ */
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+/**
+ * @brief Escritura del flujo con un buffer grande: las cabeceras y el contenido de muchos
+ *        archivos pequeños salen en una sola llamada a write.
+ */
+class StreamWriter {
+ public:
+  explicit StreamWriter(int fd) : fd_(fd), buffer_(kPackBufferSize) {}
+
+  void Put(const void* data, size_t size) {
+    if (used_ + size > buffer_.size()) Flush();
+    std::memcpy(buffer_.data() + used_, data, size);
+    used_ += size;
+  }
+
+  template <typename Integer>
+  void PutInteger(Integer value) {
+    auto bits = static_cast<std::make_unsigned_t<Integer>>(value);
+    uint8_t bytes[sizeof(Integer)];
+    for (size_t i = 0; i < sizeof(Integer); ++i) bytes[i] = static_cast<uint8_t>(bits >> (8 * i));
+    Put(bytes, sizeof(bytes));
+  }
+
+  void PutString(const std::string& text) {
+    PutInteger<uint32_t>(text.size());
+    Put(text.data(), text.size());
+  }
+
+  /**
+   * @brief Lee size bytes de un archivo directamente en el buffer del flujo.
+   * @param fd Descriptor del archivo.
+   * @param size Tamaño del archivo según su cabecera.
+   * @throw std::system_error Si se produce un error al leer.
+   *
+   * @return false si el archivo tenía menos bytes (el resto se rellena con ceros).
+   */
+  bool PutFileData(int fd, uint64_t size) {
+    bool is_complete = true;
+    while (size > 0) {
+      if (used_ == buffer_.size()) Flush();
+      size_t chunk = std::min<uint64_t>(size, buffer_.size() - used_);
+      ssize_t bytes_read = read(fd, buffer_.data() + used_, chunk);
+      if (bytes_read < 0 && errno == EINTR) continue;
+      if (bytes_read < 0) throw std::system_error(errno, std::system_category());
+      if (bytes_read == 0) {
+        std::memset(buffer_.data() + used_, 0, chunk);
+        bytes_read = chunk;
+        is_complete = false;
+      }
+      used_ += bytes_read;
+      size -= bytes_read;
+    }
+    return is_complete;
+  }
+
+  void Flush() {
+    WriteFile(fd_, buffer_.data(), used_);
+    used_ = 0;
+  }
+
+ private:
+  int fd_;
+  std::vector<uint8_t> buffer_;
+  size_t used_ = 0;
+};
+
+/**
+ * @brief Lectura del flujo con un buffer grande. El contenido de los archivos se escribe
+ *        directamente desde ese buffer.
+ */
+class StreamReader {
+ public:
+  explicit StreamReader(int fd) : fd_(fd), buffer_(kPackBufferSize) {}
+
+  void Get(void* data, size_t size) {
+    auto* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+      if (position_ == end_) Fill();
+      size_t chunk = std::min(size, end_ - position_);
+      std::memcpy(bytes, buffer_.data() + position_, chunk);
+      position_ += chunk;
+      bytes += chunk;
+      size -= chunk;
+    }
+  }
+
+  template <typename Integer>
+  Integer GetInteger() {
+    uint8_t bytes[sizeof(Integer)];
+    Get(bytes, sizeof(bytes));
+    std::make_unsigned_t<Integer> bits = 0;
+    for (size_t i = 0; i < sizeof(Integer); ++i) bits |= static_cast<decltype(bits)>(bytes[i]) << (8 * i);
+    return static_cast<Integer>(bits);
+  }
+
+  std::string GetString() {
+    uint32_t size = GetInteger<uint32_t>();
+    if (size > PATH_MAX) throw std::runtime_error("ERROR: Corrupt pack stream!");
+    std::string text(size, '\0');
+    Get(text.data(), size);
+    return text;
+  }
+
+  /**
+   * @brief Escribe en un archivo los size bytes siguientes del flujo.
+   * @param fd Descriptor del archivo.
+   * @param size Número de bytes.
+   * @throw std::system_error Si se produce un error al escribir.
+   */
+  void CopyTo(int fd, uint64_t size) {
+    while (size > 0) {
+      if (position_ == end_) Fill();
+      size_t chunk = std::min<uint64_t>(size, end_ - position_);
+      WriteFile(fd, buffer_.data() + position_, chunk);
+      position_ += chunk;
+      size -= chunk;
+    }
+  }
+
+ private:
+  void Fill() {
+    ssize_t bytes_read;
+    do {
+      bytes_read = read(fd_, buffer_.data(), buffer_.size());
+    } while (bytes_read < 0 && errno == EINTR);
+    if (bytes_read < 0) throw std::system_error(errno, std::system_category());
+    if (bytes_read == 0) throw std::runtime_error("ERROR: Truncated pack stream!");
+    position_ = 0;
+    end_ = bytes_read;
+  }
+
+  int fd_;
+  std::vector<uint8_t> buffer_;
+  size_t position_ = 0;
+  size_t end_ = 0;
+};
+
+/**
+ * @brief Escribe la cabecera de un registro.
+ */
+void PutHeader(StreamWriter& writer, char type, const struct stat& file_stat, const std::string& path) {
+  writer.Put(&type, 1);
+  writer.PutInteger<uint32_t>(file_stat.st_mode);
+  writer.PutInteger<int64_t>(file_stat.st_mtim.tv_sec);
+  writer.PutInteger<uint32_t>(file_stat.st_mtim.tv_nsec);
+  writer.PutString(path);
+}
+
+/**
+ * @brief Empaqueta un archivo regular ya abierto.
+ */
+void PackFile(StreamWriter& writer, int fd, const std::string& path, PackStats& stats) {
+  struct stat file_stat{};
+  if (fstat(fd, &file_stat) < 0) throw std::system_error(errno, std::system_category(), path);
+  PutHeader(writer, 'F', file_stat, path);
+  writer.PutInteger<uint64_t>(file_stat.st_size);
+  if (!writer.PutFileData(fd, file_stat.st_size)) ++stats.changed_files;
+  ++stats.files;
+  stats.bytes += file_stat.st_size;
+}
+
+/**
+ * @brief Empaqueta el contenido de un directorio. Las entradas se leen con getdents64 en bloques
+ *        grandes y se abren con openat relativo al directorio, sin volver a resolver la ruta entera.
+ * @param writer Flujo de salida.
+ * @param directory Directorio abierto.
+ * @param prefix Ruta del directorio dentro del paquete (vacía en la raíz).
+ * @param stats Estadísticas a actualizar.
+ * @param dirent_buffer Buffer de getdents64, compartido por toda la recursión.
+ * @throw std::system_error Si no se puede leer alguna entrada.
+ */
+void PackDirectory(StreamWriter& writer, const UniqueDirFd& directory, const std::string& prefix, PackStats& stats,
+                   std::vector<char>& dirent_buffer) {
+  const int directory_fd = directory.Get();
+  // Se lee el directorio entero antes de bajar a los subdirectorios, que reutilizan el buffer
+  std::vector<std::pair<std::string, unsigned char>> entries;
+  while (true) {
+    long bytes_read = syscall(SYS_getdents64, directory_fd, dirent_buffer.data(), dirent_buffer.size());
+    if (bytes_read < 0) throw std::system_error(errno, std::system_category(), prefix.empty() ? "." : prefix);
+    if (bytes_read == 0) break;
+    for (long position = 0; position < bytes_read;) {
+      const auto* entry = reinterpret_cast<const LinuxDirent64*>(dirent_buffer.data() + position);
+      position += entry->d_reclen;
+      if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) continue;
+      entries.emplace_back(entry->d_name, entry->d_type);
+    }
+  }
+  // Orden fijo para que el mismo árbol produzca siempre el mismo flujo
+  std::sort(entries.begin(), entries.end());
+  for (auto& [name, type] : entries) {
+    std::string path = prefix.empty() ? name : prefix + "/" + name;
+    struct stat entry_stat{};
+    if (type == DT_UNKNOWN) {
+      if (fstatat(directory_fd, name.c_str(), &entry_stat, AT_SYMLINK_NOFOLLOW) < 0) {
+        throw std::system_error(errno, std::system_category(), path);
+      }
+      type = IFTODT(entry_stat.st_mode);
+    }
+    if (type == DT_DIR) {
+      UniqueDirFd child(openat(directory_fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+      if (!child) throw std::system_error(errno, std::system_category(), path);
+      if (fstat(child.Get(), &entry_stat) < 0) throw std::system_error(errno, std::system_category(), path);
+      PutHeader(writer, 'D', entry_stat, path);
+      ++stats.directories;
+      PackDirectory(writer, child, path, stats, dirent_buffer);
+    } else if (type == DT_REG) {
+      UniqueFd fd(openat(directory_fd, name.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+      if (!fd) throw std::system_error(errno, std::system_category(), path);
+      PackFile(writer, fd.Get(), path, stats);
+    } else if (type == DT_LNK) {
+      char target[PATH_MAX];
+      ssize_t target_size = readlinkat(directory_fd, name.c_str(), target, sizeof(target));
+      if (target_size < 0 || fstatat(directory_fd, name.c_str(), &entry_stat, AT_SYMLINK_NOFOLLOW) < 0) {
+        throw std::system_error(errno, std::system_category(), path);
+      }
+      PutHeader(writer, 'L', entry_stat, path);
+      writer.PutString(std::string(target, target_size));
+      ++stats.symlinks;
+    }
+    // Los dispositivos, tuberías y sockets no se empaquetan
+  }
+}
+
+/**
+ * @brief Comprueba que una ruta del flujo es relativa y no sale del directorio de destino por
+ *        sí sola. Que no pase por un enlace simbólico lo asegura ParentDirectory.
+ * @throw std::runtime_error Si es absoluta, está vacía o tiene algún componente vacío, "." o "..".
+ */
+void CheckPath(const std::string& path) {
+  bool is_safe = !path.empty() && path[0] != '/';
+  for (size_t start = 0; is_safe && start <= path.size();) {
+    size_t end = path.find('/', start);
+    if (end == std::string::npos) end = path.size();
+    is_safe = end > start && path.compare(start, end - start, ".") != 0 && path.compare(start, end - start, "..") != 0;
+    start = end + 1;
+  }
+  if (!is_safe) throw std::runtime_error("ERROR: Unsafe path '" + path + "' in pack stream!");
+}
+
+/**
+ * @brief Directorios padre de las rutas del flujo. Se abren componente a componente con
+ *        O_NOFOLLOW, así que ninguna entrada se crea a través de un enlace simbólico, ni de
+ *        los del flujo ni de los que ya hubiera en el destino. Se guarda el último padre,
+ *        porque las entradas de un mismo directorio van seguidas en el flujo.
+ */
+class ParentDirectory {
+ public:
+  explicit ParentDirectory(int destination_fd) : destination_fd_(destination_fd) {}
+
+  /**
+   * @brief Abre el directorio padre de una ruta del flujo.
+   * @param path Ruta ya comprobada con CheckPath.
+   * @param name Donde se guarda el último componente de la ruta.
+   * @throw std::system_error Si algún componente no existe, no es un directorio o es un enlace.
+   *
+   * @return Descriptor del padre, válido hasta la siguiente llamada.
+   */
+  int Open(const std::string& path, std::string& name) {
+    size_t slash = path.rfind('/');
+    name = path.substr(slash + 1);
+    if (slash == std::string::npos) return destination_fd_;
+    if (fd_ && path.compare(0, slash, path_) == 0 && path_.size() == slash) return fd_.Get();
+    UniqueDirFd directory;
+    int current_fd = destination_fd_;
+    for (size_t start = 0; start < slash;) {
+      size_t end = std::min(path.find('/', start), slash);
+      UniqueDirFd child(openat(current_fd, path.substr(start, end - start).c_str(),
+                               O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+      if (!child) throw std::system_error(errno, std::system_category(), path);
+      directory = std::move(child);
+      current_fd = directory.Get();
+      start = end + 1;
+    }
+    fd_ = std::move(directory);
+    path_ = path.substr(0, slash);
+    return fd_.Get();
+  }
+
+ private:
+  int destination_fd_;
+  std::string path_;
+  UniqueDirFd fd_;
+};
+
+/**
+ * @brief Entrada cuyos atributos se aplican al final del desempaquetado
+ */
+struct DeferredEntry {
+  std::string path;
+  mode_t mode;
+  struct timespec mtime;
+  std::string target;
+};
+
+}  // namespace
+
+/**
+ * @brief Empaqueta un directorio (o un solo archivo) en un flujo.
+ * @param source_path Directorio o archivo a empaquetar.
+ * @param output_fd Descriptor donde se escribe el flujo.
+ * @throw std::system_error Si no se puede leer algún archivo o escribir el flujo.
+ *
+ * @return Estadísticas de lo empaquetado.
+ */
+PackStats PackTree(const std::string& source_path, int output_fd) {
+  PackStats stats;
+  StreamWriter writer(output_fd);
+  writer.Put(kPackMagic, kPackMagicSize);
+  UniqueFd fd = OpenFile(source_path, O_RDONLY);
+  struct stat source_stat{};
+  if (fstat(fd.Get(), &source_stat) < 0) throw std::system_error(errno, std::system_category(), source_path);
+  if (S_ISDIR(source_stat.st_mode)) {
+    std::vector<char> dirent_buffer(kDirentBufferSize);
+    PackDirectory(writer, UniqueDirFd(fd.Release()), "", stats, dirent_buffer);
+  } else if (S_ISREG(source_stat.st_mode)) {
+    std::string name = source_path.substr(source_path.find_last_of('/') + 1);
+    PackFile(writer, fd.Get(), name, stats);
+  } else {
+    throw std::runtime_error("ERROR: '" + source_path + "' is not a directory or a regular file!");
+  }
+  char end = 'E';
+  writer.Put(&end, 1);
+  writer.Flush();
+  return stats;
+}
+
+/**
+ * @brief Desempaqueta un flujo en un directorio, que se crea si no existe. Cada entrada se crea
+ *        en su padre abierto con ParentDirectory, sin seguir enlaces simbólicos, y una entrada
+ *        dentro de un enlace del flujo se rechaza. Los enlaces se crean al final, y los permisos
+ *        y fechas de los directorios también, para poder escribir dentro antes.
+ * @param input_fd Descriptor del que se lee el flujo.
+ * @param destination_path Directorio de destino.
+ * @throw std::runtime_error Si el flujo no es válido.
+ * @throw std::system_error Si no se puede crear algún archivo.
+ *
+ * @return Estadísticas de lo desempaquetado.
+ */
+PackStats UnpackTree(int input_fd, const std::string& destination_path) {
+  if (mkdir(destination_path.c_str(), 0777) < 0 && errno != EEXIST) {
+    throw std::system_error(errno, std::system_category(), destination_path);
+  }
+  UniqueDirFd destination = OpenDirectory(destination_path);
+  const int destination_fd = destination.Get();
+  // Solo hace falta fchmod si la umask quitaría algún permiso del archivo original
+  mode_t umask_bits = umask(0);
+  umask(umask_bits);
+
+  StreamReader reader(input_fd);
+  char magic[kPackMagicSize];
+  reader.Get(magic, sizeof(magic));
+  if (std::memcmp(magic, kPackMagic, kPackMagicSize) != 0) throw std::runtime_error("ERROR: Not a pack stream!");
+  PackStats stats;
+  std::vector<DeferredEntry> directories;
+  std::vector<DeferredEntry> symlinks;
+  std::unordered_set<std::string> symlink_paths;
+  ParentDirectory parent(destination_fd);
+  std::string name;
+  while (true) {
+    char type;
+    reader.Get(&type, 1);
+    if (type == 'E') break;
+    DeferredEntry entry;
+    entry.mode = reader.GetInteger<uint32_t>() & 07777;
+    entry.mtime.tv_sec = reader.GetInteger<int64_t>();
+    entry.mtime.tv_nsec = reader.GetInteger<uint32_t>();
+    entry.path = reader.GetString();
+    CheckPath(entry.path);
+    for (size_t slash = entry.path.find('/'); slash != std::string::npos; slash = entry.path.find('/', slash + 1)) {
+      if (symlink_paths.count(entry.path.substr(0, slash)) != 0) {
+        throw std::runtime_error("ERROR: Path '" + entry.path + "' goes through a symlink in pack stream!");
+      }
+    }
+    struct timespec times[2] = { { 0, UTIME_OMIT }, entry.mtime };
+    if (type == 'D') {
+      int parent_fd = parent.Open(entry.path, name);
+      if (mkdirat(parent_fd, name.c_str(), 0700) < 0 && errno != EEXIST) {
+        throw std::system_error(errno, std::system_category(), entry.path);
+      }
+      directories.push_back(std::move(entry));
+      ++stats.directories;
+    } else if (type == 'F') {
+      uint64_t size = reader.GetInteger<uint64_t>();
+      int parent_fd = parent.Open(entry.path, name);
+      UniqueFd fd(openat(parent_fd, name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC,
+                         entry.mode));
+      if (!fd) throw std::system_error(errno, std::system_category(), entry.path);
+      reader.CopyTo(fd.Get(), size);
+      if ((entry.mode & (umask_bits | 07000)) != 0) fchmod(fd.Get(), entry.mode);
+      futimens(fd.Get(), times);
+      ++stats.files;
+      stats.bytes += size;
+    } else if (type == 'L') {
+      entry.target = reader.GetString();
+      symlink_paths.insert(entry.path);
+      symlinks.push_back(std::move(entry));
+    } else {
+      throw std::runtime_error("ERROR: Corrupt pack stream!");
+    }
+  }
+  for (const auto& symlink_entry : symlinks) {
+    int parent_fd = parent.Open(symlink_entry.path, name);
+    unlinkat(parent_fd, name.c_str(), 0);
+    if (symlinkat(symlink_entry.target.c_str(), parent_fd, name.c_str()) < 0) {
+      throw std::system_error(errno, std::system_category(), symlink_entry.path);
+    }
+    struct timespec times[2] = { { 0, UTIME_OMIT }, symlink_entry.mtime };
+    utimensat(parent_fd, name.c_str(), times, AT_SYMLINK_NOFOLLOW);
+    ++stats.symlinks;
+  }
+  // Los directorios más profundos van después de sus padres: se recorren al revés. Cada uno se
+  // abre sin seguir enlaces, por si el destino ya tenía un enlace con ese nombre
+  for (auto directory = directories.rbegin(); directory != directories.rend(); ++directory) {
+    int parent_fd = parent.Open(directory->path, name);
+    UniqueDirFd fd(openat(parent_fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+    if (!fd) throw std::system_error(errno, std::system_category(), directory->path);
+    struct timespec times[2] = { { 0, UTIME_OMIT }, directory->mtime };
+    fchmod(fd.Get(), directory->mode);
+    futimens(fd.Get(), times);
+  }
+  return stats;
+}
@@ -0,0 +1,267 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: resume.cc
+ * @brief: resumable copies of large files with a checkpoint journal functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include "content_hash.h"
+#include "resume.h"
+#include "throttle.h"
+#include "unique_handle.h"
+
+namespace {
+
+/**
+ * @brief Tramo del destino ya copiado y sincronizado con el disco
+ * [+] offset = posición del primer byte
+ * [+] length = número de bytes
+ * [+] hash = hash del contenido del tramo (ContentHasher)
+ */
+struct Checkpoint {
+  uint64_t offset;
+  uint64_t length;
+  uint64_t hash;
+};
+
+/**
+ * @brief Primera línea del diario. Identifica la versión del origen que se estaba copiando:
+ *        si el origen cambia, lo copiado hasta entonces no sirve.
+ * @param source_stat stat del archivo de origen.
+ */
+std::string JournalHeader(const struct stat& source_stat) {
+  std::stringstream header;
+  header << "fastcopy-journal 1 " << source_stat.st_dev << ' ' << source_stat.st_ino << ' ' << source_stat.st_size
+         << ' ' << source_stat.st_mtim.tv_sec << '.' << source_stat.st_mtim.tv_nsec;
+  return header.str();
+}
+
+/**
+ * @brief Lee los puntos de control de un diario. Se ignora todo lo que va detrás de la primera
+ *        línea incompleta o que no continúa donde acabó la anterior (una escritura cortada).
+ * @param journal_path Ruta del diario.
+ * @param header Cabecera que debe tener el diario.
+ *
+ * @return Los puntos de control, vacío si no hay diario o es de otra versión del origen.
+ */
+std::vector<Checkpoint> ReadJournal(const std::string& journal_path, const std::string& header) {
+  std::vector<Checkpoint> checkpoints;
+  std::ifstream journal(journal_path);
+  std::string line;
+  if (!std::getline(journal, line) || line != header) return checkpoints;
+  uint64_t end = 0;
+  while (std::getline(journal, line) && !journal.eof()) {
+    std::istringstream fields(line);
+    Checkpoint checkpoint{};
+    if (!(fields >> checkpoint.offset >> checkpoint.length >> std::hex >> checkpoint.hash)) break;
+    if (checkpoint.offset != end || checkpoint.length == 0) break;
+    checkpoints.push_back(checkpoint);
+    end += checkpoint.length;
+  }
+  return checkpoints;
+}
+
+/**
+ * @brief Escribe un diario nuevo con los puntos de control válidos. Se escribe aparte y se
+ *        renombra encima para que un corte a medias no deje un diario mezclado.
+ * @param journal_path Ruta del diario.
+ * @param header Cabecera del diario.
+ * @param checkpoints Puntos de control.
+ * @throw std::system_error Si no se puede escribir.
+ */
+void WriteJournal(const std::string& journal_path, const std::string& header,
+                  const std::vector<Checkpoint>& checkpoints) {
+  std::stringstream contents;
+  contents << header << '\n';
+  for (const auto& checkpoint : checkpoints) {
+    contents << std::dec << checkpoint.offset << ' ' << checkpoint.length << ' ' << std::hex << checkpoint.hash << '\n';
+  }
+  std::string temporary_path = journal_path + ".tmp";
+  UniqueFd fd = OpenFile(temporary_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  std::string data = contents.str();
+  WriteFile(fd.Get(), reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  if (fdatasync(fd.Get()) < 0 || rename(temporary_path.c_str(), journal_path.c_str()) < 0) {
+    throw std::system_error(errno, std::system_category(), journal_path);
+  }
+}
+
+/**
+ * @brief Calcula el hash de un tramo de un archivo.
+ * @param fd Descriptor del archivo.
+ * @param offset Posición del tramo.
+ * @param length Longitud del tramo.
+ * @param buffer Buffer de lectura.
+ * @param hash Donde se guarda el hash.
+ * @throw std::system_error Si se produce un error al leer.
+ *
+ * @return false si el archivo acaba antes del final del tramo.
+ */
+bool HashRange(int fd, uint64_t offset, uint64_t length, std::vector<uint8_t>& buffer, uint64_t& hash) {
+  ContentHasher hasher;
+  while (length > 0) {
+    ssize_t bytes_read = pread(fd, buffer.data(), std::min<uint64_t>(buffer.size(), length), offset);
+    if (bytes_read < 0 && errno == EINTR) continue;
+    if (bytes_read < 0) throw std::system_error(errno, std::system_category());
+    if (bytes_read == 0) return false;
+    hasher.Update(buffer.data(), bytes_read);
+    offset += bytes_read;
+    length -= bytes_read;
+  }
+  hash = hasher.Final();
+  return true;
+}
+
+/**
+ * @brief Escribe un bloque en una posición de un archivo, reintentando las escrituras parciales.
+ * @param fd Descriptor del archivo.
+ * @param data Bytes a escribir.
+ * @param size Número de bytes a escribir.
+ * @param offset Posición del archivo donde se escriben.
+ * @throw std::system_error Si se produce un error al escribir.
+ */
+void WriteAt(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+  while (size > 0) {
+    ssize_t bytes_written = pwrite(fd, data, size, offset);
+    if (bytes_written < 0 && errno == EINTR) continue;
+    if (bytes_written < 0) throw std::system_error(errno, std::system_category());
+    data += bytes_written;
+    size -= bytes_written;
+    offset += bytes_written;
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Copia un archivo de forma que, si la copia se interrumpe (error, cancelación, corte
+ *        de luz), al volver a lanzarla continúa donde se quedó. Junto al destino se guarda un
+ *        diario (<destino>.fcjournal) con los tramos ya copiados y el hash de cada uno. Cada
+ *        checkpoint_bytes se sincroniza el destino con un solo fdatasync y después se añade
+ *        el tramo al diario, así que lo que se puede perder es como mucho un intervalo.
+ *        Al reanudar solo se vuelve a leer el último tramo para comprobar que está en el
+ *        disco; si no coincide se descarta y se comprueba el anterior.
+ * @param source_path Ruta del archivo de origen.
+ * @param destination_path Ruta del archivo de destino.
+ * @param preserve_all Si se preservan los atributos del origen.
+ * @param checkpoint_bytes Bytes copiados entre dos puntos de control.
+ * @param buffer Buffer para la copia. Si es nulo se reserva uno propio.
+ * @param progress Si no es nulo, se actualiza con los bytes copiados (incluidos los de antes de
+ *                 reanudar), permite cancelar la copia y limita su velocidad. Una copia cancelada guarda un último
+ *                 punto de control y deja el destino y el diario para reanudarla.
+ * @throw std::runtime_error Si se produce un error al copiar el archivo.
+ * @throw CopyCancelled Si se cancela la copia.
+ */
+void ResumableCopyFile(const std::string& source_path, const std::string& destination_path, bool preserve_all,
+                       uint64_t checkpoint_bytes, std::vector<uint8_t>* buffer, CopyProgress* progress) {
+  try {
+    struct stat source_stat = StatSource(source_path);
+    std::string destination_path_copy = ResolveDestination(source_path, destination_path, source_stat);
+    std::string journal_path = destination_path_copy + kJournalSuffix;
+    std::string header = JournalHeader(source_stat);
+    uint64_t source_size = source_stat.st_size;
+
+    UniqueFd source = OpenFile(source_path, O_RDONLY);
+    const int source_fd = source.Get();
+    posix_fadvise(source_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Sin O_TRUNC: lo que ya está copiado se conserva
+    UniqueFd destination = OpenFile(destination_path_copy, O_RDWR | O_CREAT, 0666);
+    const int destination_fd = destination.Get();
+
+    std::vector<uint8_t> own_buffer;
+    if (buffer == nullptr) {
+      own_buffer.resize(kCopyBufferSize);
+      buffer = &own_buffer;
+    }
+
+    // Se busca el último tramo que sigue en el disco tal y como se copió
+    std::vector<Checkpoint> checkpoints = ReadJournal(journal_path, header);
+    while (!checkpoints.empty()) {
+      const Checkpoint& last = checkpoints.back();
+      uint64_t hash;
+      if (HashRange(destination_fd, last.offset, last.length, *buffer, hash) && hash == last.hash) break;
+      checkpoints.pop_back();
+    }
+    uint64_t offset = checkpoints.empty() ? 0 : checkpoints.back().offset + checkpoints.back().length;
+    if (offset > source_size) {
+      checkpoints.clear();
+      offset = 0;
+    }
+    if (offset == 0 && ftruncate(destination_fd, 0) < 0) {
+      throw std::system_error(errno, std::system_category(), destination_path_copy);
+    }
+    WriteJournal(journal_path, header, checkpoints);
+    UniqueFd journal = OpenFile(journal_path, O_WRONLY | O_APPEND);
+    const int journal_fd = journal.Get();
+
+    if (progress != nullptr) {
+      progress->total_bytes = source_size;
+      progress->bytes_copied = offset;
+    }
+    uint64_t range_start = offset;
+    ContentHasher range_hasher;
+    // Primero los datos y después el diario: un tramo solo se anota cuando ya está en el disco
+    auto save_checkpoint = [&] {
+      if (offset == range_start) return;
+      if (fdatasync(destination_fd) < 0) throw std::system_error(errno, std::system_category(), destination_path_copy);
+      std::stringstream line;
+      line << range_start << ' ' << offset - range_start << ' ' << std::hex << range_hasher.Final() << '\n';
+      std::string data = line.str();
+      WriteFile(journal_fd, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+      if (fdatasync(journal_fd) < 0) throw std::system_error(errno, std::system_category(), journal_path);
+      range_start = offset;
+      range_hasher = ContentHasher();
+    };
+
+    try {
+      while (offset < source_size) {
+        if (progress != nullptr && progress->is_cancelled) throw CopyCancelled();
+        size_t chunk = std::min<uint64_t>(ThrottledChunkSize(progress, buffer->size()), source_size - offset);
+        ssize_t bytes_read = pread(source_fd, buffer->data(), chunk, offset);
+        if (bytes_read < 0 && errno == EINTR) continue;
+        if (bytes_read < 0) throw std::system_error(errno, std::system_category(), source_path);
+        if (bytes_read == 0) throw std::runtime_error("'" + source_path + "' shrank while being copied");
+        WriteAt(destination_fd, buffer->data(), bytes_read, offset);
+        range_hasher.Update(buffer->data(), bytes_read);
+        offset += bytes_read;
+        if (progress != nullptr) progress->bytes_copied = offset;
+        ThrottleCopy(progress, bytes_read);
+        if (offset - range_start >= checkpoint_bytes) save_checkpoint();
+      }
+    } catch (...) {
+      // Se guarda lo copiado desde el último punto de control para no repetirlo al reanudar
+      try {
+        save_checkpoint();
+      } catch (...) {}
+      throw;
+    }
+
+    // El destino puede ser más largo si ya existía; el diario sobra una vez está todo en el disco
+    if (ftruncate(destination_fd, source_size) < 0 || fdatasync(destination_fd) < 0) {
+      throw std::system_error(errno, std::system_category(), destination_path_copy);
+    }
+    unlink(journal_path.c_str());
+    if (preserve_all) CopyAttributes(destination_path_copy, source_stat);
+  } catch (const CopyCancelled&) {
+    throw;
+  } catch (const std::exception& error) {
+    std::throw_with_nested(std::runtime_error("ERROR: Copying the file!"));
+  }
+}
@@ -0,0 +1,170 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: throttle.cc
+ * @brief: bandwidth limiting and I/O priority of copies functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <linux/ioprio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "throttle.h"
+
+namespace {
+
+// Las esperas son como mucho de 1/kChunksPerSecond segundos
+constexpr uint64_t kChunksPerSecond = 20;
+constexpr size_t kMinChunkSize = 64 * 1024;
+
+}  // namespace
+
+/**
+ * @brief Crea un limitador.
+ * @param bytes_per_second Velocidad máxima, mayor que 0.
+ */
+RateLimiter::RateLimiter(uint64_t bytes_per_second) : rate_(bytes_per_second) {
+  chunk_size_ = std::clamp<uint64_t>(rate_ / kChunksPerSecond, kMinChunkSize, kCopyBufferSize);
+  tokens_ = chunk_size_;
+}
+
+/**
+ * @brief Descuenta los bytes recién copiados y espera si se va por delante del ritmo. El cubo
+ *        guarda como mucho un bloque de fichas, así que una copia que ha estado parada no
+ *        puede recuperar el tiempo perdido con una ráfaga.
+ * @param bytes Bytes copiados.
+ */
+void RateLimiter::Acquire(uint64_t bytes) {
+  std::chrono::duration<double> wait{0};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    if (!is_started_) {
+      start_ = now;
+      last_refill_ = now;
+      is_started_ = true;
+    }
+    std::chrono::duration<double> elapsed = now - last_refill_;
+    last_refill_ = now;
+    tokens_ = std::min<double>(tokens_ + elapsed.count() * rate_, chunk_size_);
+    tokens_ -= bytes;
+    total_bytes_ += bytes;
+    // La deuda queda en el cubo: quien llegue después espera también lo que le toca a este
+    if (tokens_ < 0) wait = std::chrono::duration<double>(-tokens_ / rate_);
+  }
+  if (wait.count() > 0) std::this_thread::sleep_for(wait);
+}
+
+/**
+ * @brief Velocidad conseguida desde el primer bloque.
+ *
+ * @return Bytes por segundo, 0 si todavía no se ha copiado nada.
+ */
+double RateLimiter::GetAchievedRate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_started_) return 0;
+  std::chrono::duration<double> elapsed = Clock::now() - start_;
+  return elapsed.count() > 0 ? total_bytes_ / elapsed.count() : 0;
+}
+
+/**
+ * @brief Aplica a un bloque recién copiado el límite de velocidad de la copia, si lo tiene.
+ * @param progress Progreso de la copia (puede ser nulo).
+ * @param bytes Bytes del bloque.
+ */
+void ThrottleCopy(const CopyProgress* progress, uint64_t bytes) {
+  if (progress != nullptr && progress->rate_limiter != nullptr) progress->rate_limiter->Acquire(bytes);
+}
+
+/**
+ * @brief Tamaño de bloque para una copia: con límite de velocidad, uno pequeño para que las
+ *        esperas sean cortas.
+ * @param progress Progreso de la copia (puede ser nulo).
+ * @param size Tamaño de bloque sin límite.
+ */
+size_t ThrottledChunkSize(const CopyProgress* progress, size_t size) {
+  if (progress == nullptr || progress->rate_limiter == nullptr) return size;
+  return std::min(size, progress->rate_limiter->GetChunkSize());
+}
+
+/**
+ * @brief Convierte una velocidad como "500K", "20M" o "1G" (potencias de 1024) en bytes por segundo.
+ * @param rate Velocidad; sin sufijo son bytes por segundo.
+ * @throw std::invalid_argument Si no es una velocidad válida.
+ */
+uint64_t ParseRate(const std::string& rate) {
+  size_t digits = rate.find_first_not_of("0123456789");
+  if (digits == 0 || rate.empty()) throw std::invalid_argument("Invalid rate '" + rate + "'");
+  uint64_t value = std::stoull(rate.substr(0, digits));
+  std::string suffix = digits == std::string::npos ? "" : rate.substr(digits);
+  if (suffix == "K" || suffix == "k") {
+    value *= 1024;
+  } else if (suffix == "M" || suffix == "m") {
+    value *= 1024 * 1024;
+  } else if (suffix == "G" || suffix == "g") {
+    value *= 1024 * 1024 * 1024;
+  } else if (!suffix.empty()) {
+    throw std::invalid_argument("Invalid rate '" + rate + "'");
+  }
+  if (value == 0) throw std::invalid_argument("Invalid rate '" + rate + "'");
+  return value;
+}
+
+/**
+ * @brief Escribe una velocidad en MiB/s para mostrarla.
+ * @param bytes_per_second Velocidad en bytes por segundo.
+ */
+std::string FormatRate(double bytes_per_second) {
+  std::stringstream text;
+  text << std::fixed << std::setprecision(2) << bytes_per_second / (1024 * 1024) << " MiB/s";
+  return text.str();
+}
+
+/**
+ * @brief Convierte una prioridad de E/S como la de ionice en el valor de ioprio_set.
+ * @param priority "idle" o "best-effort:N", con N de 0 (más prioridad) a 7.
+ * @throw std::invalid_argument Si no es una prioridad válida.
+ */
+int ParseIoPriority(const std::string& priority) {
+  if (priority == "idle") return IOPRIO_PRIO_VALUE(IOPRIO_CLASS_IDLE, 0);
+  const std::string best_effort = "best-effort:";
+  if (priority.rfind(best_effort, 0) == 0 && priority.size() == best_effort.size() + 1) {
+    char level = priority.back();
+    if (level >= '0' && level <= '7') return IOPRIO_PRIO_VALUE(IOPRIO_CLASS_BE, level - '0');
+  }
+  throw std::invalid_argument("Invalid I/O priority '" + priority + "' (use idle or best-effort:0-7)");
+}
+
+/**
+ * @brief Cambia la prioridad de E/S del hilo que la llama (no la del proceso), así cada
+ *        copia de un pool puede tener la suya. Solo la respetan los planificadores de E/S
+ *        que tienen clases (BFQ); con los demás no tiene efecto.
+ * @param priority Valor de ioprio_set (ver ParseIoPriority).
+ * @throw std::system_error Si el kernel no acepta la prioridad.
+ *
+ * @return La prioridad que tenía el hilo, para restaurarla.
+ */
+int SetThreadIoPriority(int priority) {
+  // Con IOPRIO_WHO_PROCESS y 0 el kernel se refiere al hilo actual
+  long previous = syscall(SYS_ioprio_get, IOPRIO_WHO_PROCESS, 0);
+  if (previous < 0) throw std::system_error(errno, std::system_category(), "ioprio_get");
+  if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, priority) < 0) {
+    throw std::system_error(errno, std::system_category(), "ioprio_set");
+  }
+  return static_cast<int>(previous);
+}
@@ -0,0 +1,98 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: unique_handle.cc
+ * @brief: RAII handles for file descriptors, directory descriptors and memory mappings functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <cerrno>
+#include <system_error>
+
+#include "unique_handle.h"
+
+/**
+ * @brief Abre un archivo. Siempre se añade O_CLOEXEC.
+ * @param path Ruta del archivo.
+ * @param flags Opciones de open.
+ * @param mode Permisos si se crea.
+ * @throw std::system_error Si no se puede abrir.
+ */
+UniqueFd OpenFile(const std::string& path, int flags, mode_t mode) {
+  UniqueFd fd(open(path.c_str(), flags | O_CLOEXEC, mode));
+  if (!fd) throw std::system_error(errno, std::system_category(), path);
+  return fd;
+}
+
+/**
+ * @brief Abre un archivo dentro de un directorio ya abierto, sin volver a resolver su ruta.
+ *        Siempre se añade O_CLOEXEC.
+ * @param directory Directorio.
+ * @param name Nombre (o ruta relativa) del archivo.
+ * @param flags Opciones de openat.
+ * @param mode Permisos si se crea.
+ * @throw std::system_error Si no se puede abrir.
+ */
+UniqueFd OpenFileAt(const UniqueDirFd& directory, const std::string& name, int flags, mode_t mode) {
+  UniqueFd fd(openat(directory.Get(), name.c_str(), flags | O_CLOEXEC, mode));
+  if (!fd) throw std::system_error(errno, std::system_category(), name);
+  return fd;
+}
+
+/**
+ * @brief Abre un directorio.
+ * @param path Ruta del directorio.
+ * @throw std::system_error Si no existe o no es un directorio.
+ */
+UniqueDirFd OpenDirectory(const std::string& path) {
+  UniqueDirFd fd(open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+  if (!fd) throw std::system_error(errno, std::system_category(), path);
+  return fd;
+}
+
+/**
+ * @brief Abre un subdirectorio de un directorio ya abierto, sin seguir enlaces simbólicos.
+ * @param directory Directorio.
+ * @param name Nombre del subdirectorio.
+ * @throw std::system_error Si no existe, no es un directorio o es un enlace simbólico.
+ */
+UniqueDirFd OpenDirectoryAt(const UniqueDirFd& directory, const std::string& name) {
+  UniqueDirFd fd(openat(directory.Get(), name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+  if (!fd) throw std::system_error(errno, std::system_category(), name);
+  return fd;
+}
+
+/**
+ * @brief Proyecta en memoria, solo para lectura, un tramo de un archivo.
+ * @param fd Descriptor del archivo.
+ * @param offset Posición del tramo; debe ser múltiplo del tamaño de página.
+ * @param size Bytes a proyectar (mayor que 0).
+ * @param flags Opciones de mmap (MAP_PRIVATE o MAP_SHARED, y por ejemplo MAP_POPULATE).
+ * @throw std::system_error Si el archivo no se puede proyectar.
+ */
+UniqueMapping MapFile(int fd, uint64_t offset, size_t size, int flags) {
+  UniqueMapping mapping(Mapping{ mmap(nullptr, size, PROT_READ, flags, fd, offset), size });
+  if (!mapping) throw std::system_error(errno, std::system_category(), "mmap");
+  return mapping;
+}
+
+/**
+ * @brief Crea una tubería con O_CLOEXEC en los dos extremos.
+ * @param read_end Donde se guarda el extremo de lectura.
+ * @param write_end Donde se guarda el extremo de escritura.
+ * @throw std::system_error Si no se puede crear.
+ */
+void OpenPipe(UniqueFd& read_end, UniqueFd& write_end) {
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC) < 0) throw std::system_error(errno, std::system_category(), "pipe2");
+  read_end.Reset(fds[0]);
+  write_end.Reset(fds[1]);
+}
@@ -0,0 +1,396 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: watch.cc
+ * @brief: continuous mirror of a directory driven by inotify events functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+#include "fastcopy.h"
+#include "watch.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Eventos que indican que algo ha cambiado dentro de un directorio vigilado
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM |
+                                IN_MOVED_TO | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+// Un archivo que no para de cambiar se copia igualmente cada kMaxDelayFactor veces settle_time
+constexpr int kMaxDelayFactor = 10;
+
+/**
+ * @brief Comprueba si la copia de un archivo regular está al día: mismo tamaño y misma fecha de
+ *        modificación (CopyAttributes la copia en segundos).
+ * @param source_stat stat del archivo de origen.
+ * @param destination_path Ruta del archivo de destino.
+ */
+bool IsUpToDate(const struct stat& source_stat, const std::string& destination_path) {
+  struct stat destination_stat{};
+  if (lstat(destination_path.c_str(), &destination_stat) < 0 || !S_ISREG(destination_stat.st_mode)) return false;
+  return destination_stat.st_size == source_stat.st_size &&
+         destination_stat.st_mtim.tv_sec == source_stat.st_mtim.tv_sec;
+}
+
+/**
+ * @brief Normaliza una ruta absoluta y le quita la barra final.
+ */
+std::string NormalizePath(const std::string& path) {
+  fs::path normalized = fs::absolute(path).lexically_normal();
+  if (!normalized.has_filename() && normalized.has_parent_path()) normalized = normalized.parent_path();
+  return normalized.string();
+}
+
+}  // namespace
+
+/**
+ * @brief Percentil de las latencias guardadas.
+ * @param percentile Percentil entre 0 y 100.
+ *
+ * @return Milisegundos, 0 si no hay latencias.
+ */
+double WatchStats::LatencyPercentile(double percentile) const {
+  if (latencies_ms.empty()) return 0;
+  std::vector<double> sorted(latencies_ms.begin(), latencies_ms.end());
+  size_t index = std::min(sorted.size() - 1, static_cast<size_t>(std::ceil(percentile / 100 * sorted.size())) - 1);
+  if (percentile <= 0) index = 0;
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  return sorted[index];
+}
+
+/**
+ * @brief Prepara la vigilancia de un directorio. No sincroniza nada hasta llamar a Run.
+ * @param source Directorio de origen.
+ * @param destination Directorio de destino; se crea si no existe. Queda con el mismo contenido
+ *                    que el origen (no con el origen dentro, como en una copia con -r).
+ * @param settle_time Tiempo sin eventos que se espera antes de copiar un archivo.
+ * @param on_error Función a la que se llama con cada ruta que no se puede sincronizar (puede estar vacía).
+ * @throw std::runtime_error Si el origen no es un directorio, o si el destino es el origen, está
+ *                           dentro de él o lo contiene (la limpieza del destino borraría el origen).
+ * @throw std::system_error Si no se puede crear la instancia de inotify.
+ */
+TreeWatcher::TreeWatcher(const std::string& source, const std::string& destination,
+                         std::chrono::milliseconds settle_time, WatchErrorCallback on_error)
+    : source_(NormalizePath(source)), destination_(NormalizePath(destination)), settle_time_(settle_time),
+      on_error_(std::move(on_error)) {
+  if (!fs::is_directory(source_)) throw std::runtime_error("ERROR: Source path is not a directory!");
+  if (destination_ == source_ || destination_.rfind(source_ + "/", 0) == 0) {
+    throw std::runtime_error("ERROR: The destination can not be inside the source!");
+  }
+  if (source_.rfind(destination_ == "/" ? destination_ : destination_ + "/", 0) == 0) {
+    throw std::runtime_error("ERROR: The source can not be inside the destination!");
+  }
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) throw std::system_error(errno, std::system_category(), "inotify_init1");
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (stop_fd_ < 0) {
+    close(inotify_fd_);
+    throw std::system_error(errno, std::system_category(), "eventfd");
+  }
+}
+
+TreeWatcher::~TreeWatcher() {
+  close(inotify_fd_);
+  close(stop_fd_);
+}
+
+/**
+ * @brief Sincroniza el árbol entero y después copia los cambios según llegan, hasta que se
+ *        llama a Stop.
+ * @throw std::system_error Si falla la vigilancia del directorio de origen.
+ */
+void TreeWatcher::Run() {
+  ++stats_.rescans;
+  Rescan("");
+  struct pollfd fds[2] = { { inotify_fd_, POLLIN, 0 }, { stop_fd_, POLLIN, 0 } };
+  while (true) {
+    int ready = poll(fds, 2, NextTimeout());
+    if (ready < 0 && errno == EINTR) continue;
+    if (ready < 0) throw std::system_error(errno, std::system_category(), "poll");
+    if (fds[1].revents & POLLIN) break;
+    if (fds[0].revents & POLLIN) ReadEvents();
+    SyncDueChanges();
+  }
+}
+
+/**
+ * @brief Hace que Run termine. Solo escribe en un eventfd, así que se puede llamar desde otro
+ *        hilo o desde un manejador de señales.
+ */
+void TreeWatcher::Stop() {
+  uint64_t one = 1;
+  ssize_t result = write(stop_fd_, &one, sizeof(one));
+  (void)result;
+}
+
+/**
+ * @brief Recorre un subárbol del origen: vigila sus directorios, copia lo que ha cambiado
+ *        desde la última vez (por tamaño y fecha) y borra del destino lo que ya no existe.
+ *        Cada directorio se vigila antes de listarlo, así que no se pierde nada de lo que se
+ *        cree mientras tanto.
+ * @param relative_path Subárbol, relativo al origen ("" para todo).
+ * @throw std::system_error Si no se puede vigilar o crear el directorio raíz del subárbol.
+ */
+void TreeWatcher::Rescan(const std::string& relative_path) {
+  fs::path source_root = fs::path(source_) / relative_path;
+  fs::path destination_root = fs::path(destination_) / relative_path;
+  if (fs::exists(fs::symlink_status(destination_root)) && !fs::is_directory(fs::symlink_status(destination_root))) {
+    RemoveFromDestination(destination_root);
+  }
+  fs::create_directories(destination_root);
+  AddWatch(relative_path);
+
+  std::error_code error;
+  fs::recursive_directory_iterator end;
+  for (fs::recursive_directory_iterator entry(source_root, fs::directory_options::skip_permission_denied, error);
+       !error && entry != end; entry.increment(error)) {
+    std::string relative = entry->path().lexically_relative(source_).string();
+    try {
+      if (entry->is_directory() && !entry->is_symlink()) {
+        fs::path destination_path = fs::path(destination_) / relative;
+        if (!fs::is_directory(fs::symlink_status(destination_path))) {
+          RemoveFromDestination(destination_path);
+          fs::create_directory(destination_path);
+        }
+        AddWatch(relative);
+      } else {
+        SyncPath(relative, true);
+      }
+    } catch (...) {
+      ReportError(relative);
+    }
+  }
+
+  // Lo que sobra en el destino: se apunta primero y se borra después para no romper el recorrido
+  std::vector<fs::path> extra_paths;
+  error.clear();
+  for (fs::recursive_directory_iterator entry(destination_root, fs::directory_options::skip_permission_denied, error);
+       !error && entry != end; entry.increment(error)) {
+    fs::path source_path = fs::path(source_) / entry->path().lexically_relative(destination_);
+    if (fs::exists(fs::symlink_status(source_path))) continue;
+    extra_paths.push_back(entry->path());
+    if (entry->is_directory() && !entry->is_symlink()) entry.disable_recursion_pending();
+  }
+  for (const auto& path : extra_paths) {
+    try {
+      if (RemoveFromDestination(path) > 0) ++stats_.removals;
+    } catch (const std::exception&) {
+      ReportError(path.lexically_relative(destination_).string());
+    }
+  }
+}
+
+/**
+ * @brief Empieza a vigilar un directorio del origen.
+ * @param relative_path Directorio, relativo al origen.
+ * @throw std::system_error Si inotify no lo admite (por ejemplo, por superar max_user_watches).
+ */
+void TreeWatcher::AddWatch(const std::string& relative_path) {
+  std::string path = (fs::path(source_) / relative_path).string();
+  int watch = inotify_add_watch(inotify_fd_, path.c_str(), kWatchMask);
+  if (watch < 0) throw std::system_error(errno, std::system_category(), path);
+  watches_[watch] = relative_path;
+}
+
+/**
+ * @brief Deja de vigilar un directorio que ya no está en el origen y todos los que tenía dentro.
+ * @param relative_path Directorio, relativo al origen.
+ */
+void TreeWatcher::RemoveWatches(const std::string& relative_path) {
+  for (auto watch = watches_.begin(); watch != watches_.end();) {
+    const std::string& path = watch->second;
+    if (path == relative_path || path.rfind(relative_path + "/", 0) == 0) {
+      inotify_rm_watch(inotify_fd_, watch->first);
+      watch = watches_.erase(watch);
+    } else {
+      ++watch;
+    }
+  }
+}
+
+/**
+ * @brief Lee los eventos de inotify disponibles y apunta las rutas que han cambiado. Los
+ *        directorios nuevos se vigilan en seguida para no perder lo que se cree dentro.
+ */
+void TreeWatcher::ReadEvents() {
+  alignas(struct inotify_event) char buffer[64 * 1024];
+  bool is_overflowed = false;
+  while (true) {
+    ssize_t bytes_read = read(inotify_fd_, buffer, sizeof(buffer));
+    if (bytes_read < 0 && errno == EINTR) continue;
+    if (bytes_read < 0 && errno == EAGAIN) break;
+    if (bytes_read < 0) throw std::system_error(errno, std::system_category(), "inotify");
+    Clock::time_point now = Clock::now();
+    for (char* position = buffer; position < buffer + bytes_read;) {
+      const auto* event = reinterpret_cast<const struct inotify_event*>(position);
+      position += sizeof(struct inotify_event) + event->len;
+      ++stats_.events;
+      if (event->mask & IN_Q_OVERFLOW) {
+        is_overflowed = true;
+        continue;
+      }
+      if (event->mask & IN_IGNORED) {
+        watches_.erase(event->wd);
+        continue;
+      }
+      auto watch = watches_.find(event->wd);
+      // Los eventos sin nombre son del propio directorio vigilado, que se trata desde su padre
+      if (watch == watches_.end() || event->len == 0) continue;
+      std::string relative = watch->second.empty() ? event->name : watch->second + "/" + event->name;
+      if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_DELETE | IN_MOVED_FROM)) RemoveWatches(relative);
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          try {
+            AddWatch(relative);
+          } catch (...) {
+            ReportError(relative);
+          }
+        }
+      }
+      auto change = pending_.try_emplace(relative, PendingChange{ now, now }).first;
+      change->second.last_event = now;
+    }
+  }
+  // Se han perdido eventos: solo un recorrido completo deja el destino al día
+  if (is_overflowed) {
+    ++stats_.overflows;
+    ++stats_.rescans;
+    try {
+      Rescan("");
+    } catch (...) {
+      ReportError("");
+    }
+  }
+}
+
+/**
+ * @brief Deja una ruta del destino igual que en el origen: copia los archivos regulares (con
+ *        CopyFile, conservando los atributos), recrea los enlaces simbólicos, recorre los
+ *        directorios y borra lo que ya no existe.
+ * @param relative_path Ruta relativa al origen.
+ * @param only_if_changed Si un archivo regular solo se copia cuando su tamaño o su fecha no
+ *                        coinciden con los del destino. Tras un evento se copia siempre: una
+ *                        reescritura en el mismo segundo no cambia ninguno de los dos.
+ * @throw std::exception Si no se puede sincronizar.
+ */
+void TreeWatcher::SyncPath(const std::string& relative_path, bool only_if_changed) {
+  std::string source_path = (fs::path(source_) / relative_path).string();
+  std::string destination_path = (fs::path(destination_) / relative_path).string();
+  struct stat source_stat{};
+  if (lstat(source_path.c_str(), &source_stat) < 0) {
+    if (errno != ENOENT) throw std::system_error(errno, std::system_category(), source_path);
+    if (RemoveFromDestination(destination_path) > 0) ++stats_.removals;
+    return;
+  }
+  if (S_ISDIR(source_stat.st_mode)) {
+    Rescan(relative_path);
+    return;
+  }
+  struct stat destination_stat{};
+  if (lstat(destination_path.c_str(), &destination_stat) == 0 &&
+      (destination_stat.st_mode & S_IFMT) != (source_stat.st_mode & S_IFMT)) {
+    RemoveFromDestination(destination_path);
+  }
+  if (S_ISLNK(source_stat.st_mode)) {
+    fs::path target = fs::read_symlink(source_path);
+    std::error_code error;
+    if (fs::is_symlink(fs::symlink_status(destination_path)) && fs::read_symlink(destination_path, error) == target) {
+      return;
+    }
+    fs::remove(destination_path, error);
+    fs::create_symlink(target, destination_path);
+  } else if (S_ISREG(source_stat.st_mode) && !(only_if_changed && IsUpToDate(source_stat, destination_path))) {
+    CopyFile(source_path, destination_path, true);
+    ++stats_.copies;
+  }
+}
+
+/**
+ * @brief Sincroniza las rutas que ya llevan settle_time sin cambiar (o que llevan demasiado
+ *        tiempo cambiando) y guarda la latencia de cada una.
+ */
+void TreeWatcher::SyncDueChanges() {
+  Clock::time_point now = Clock::now();
+  for (auto change = pending_.begin(); change != pending_.end();) {
+    bool is_settled = now - change->second.last_event >= settle_time_;
+    bool is_overdue = now - change->second.first_event >= kMaxDelayFactor * settle_time_;
+    if (!is_settled && !is_overdue) {
+      ++change;
+      continue;
+    }
+    std::string relative = change->first;
+    Clock::time_point first_event = change->second.first_event;
+    change = pending_.erase(change);
+    try {
+      SyncPath(relative, false);
+    } catch (...) {
+      ReportError(relative);
+      continue;
+    }
+    std::chrono::duration<double, std::milli> latency = Clock::now() - first_event;
+    stats_.latencies_ms.push_back(latency.count());
+    if (stats_.latencies_ms.size() > WatchStats::kMaxLatencySamples) stats_.latencies_ms.pop_front();
+  }
+}
+
+/**
+ * @brief Milisegundos hasta que toca sincronizar la siguiente ruta pendiente.
+ *
+ * @return El tiempo de espera para poll (-1 si no hay nada pendiente).
+ */
+int TreeWatcher::NextTimeout() const {
+  if (pending_.empty()) return -1;
+  Clock::time_point now = Clock::now();
+  Clock::time_point next = Clock::time_point::max();
+  for (const auto& [path, change] : pending_) {
+    next = std::min({ next, change.last_event + settle_time_, change.first_event + kMaxDelayFactor * settle_time_ });
+  }
+  if (next <= now) return 0;
+  return std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1;
+}
+
+/**
+ * @brief Cuenta el error que se está tratando y lo pasa a on_error.
+ * @param relative_path Ruta que no se ha podido sincronizar.
+ */
+void TreeWatcher::ReportError(const std::string& relative_path) {
+  ++stats_.errors;
+  if (on_error_) on_error_(relative_path.empty() ? "." : relative_path, std::current_exception());
+}
+
+/**
+ * @brief Borra una ruta del destino con todo lo que contenga, salvo que sea el origen o lo
+ *        contenga (por ejemplo, a través de un enlace en el destino o de un montaje).
+ * @param path Ruta del destino.
+ * @throw std::runtime_error Si la ruta es el origen o lo contiene.
+ * @throw std::filesystem::filesystem_error Si no se puede borrar.
+ *
+ * @return El número de entradas borradas.
+ */
+uintmax_t TreeWatcher::RemoveFromDestination(const fs::path& path) {
+  std::string normalized = NormalizePath(path.string());
+  if (normalized == source_ || source_.rfind(normalized == "/" ? normalized : normalized + "/", 0) == 0) {
+    throw std::runtime_error("ERROR: Refusing to remove '" + normalized + "', it contains the source!");
+  }
+  return fs::remove_all(path);
+}
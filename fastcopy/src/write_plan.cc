@@ -0,0 +1,244 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: write_plan.cc
+ * @brief: planning of how the destination of a copy is allocated and written functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <linux/magic.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <system_error>
+
+#include "throttle.h"
+#include "write_plan.h"
+
+namespace {
+
+/**
+ * @brief Tamaño de E/S óptimo que anuncia el dispositivo de bloques de un sistema de archivos
+ *        (por ejemplo, el ancho de banda de un RAID). Las particiones no tienen cola propia, así
+ *        que si no está en la suya se mira la del disco.
+ * @param device Dispositivo (st_dev).
+ *
+ * @return El tamaño en bytes, o 0 si el dispositivo no lo anuncia (o no es de bloques).
+ */
+size_t OptimalIoSize(dev_t device) {
+  std::string base = "/sys/dev/block/" + std::to_string(major(device)) + ":" + std::to_string(minor(device));
+  for (const char* queue : { "/queue/optimal_io_size", "/../queue/optimal_io_size" }) {
+    std::ifstream file(base + queue);
+    size_t size = 0;
+    if (file >> size) return size;
+  }
+  return 0;
+}
+
+/**
+ * @brief Tramos con datos de un archivo, saltando los huecos con SEEK_DATA y SEEK_HOLE.
+ * @param fd Descriptor del archivo.
+ * @param size Tamaño del archivo.
+ * @throw std::system_error Si falla lseek por algo distinto de no admitir SEEK_DATA.
+ *
+ * @return Los tramos (posición, longitud); todo el archivo si el sistema de archivos no
+ *         distingue los huecos.
+ */
+std::vector<std::pair<uint64_t, uint64_t>> FindDataRanges(int fd, uint64_t size) {
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  uint64_t position = 0;
+  while (position < size) {
+    off_t data = lseek(fd, position, SEEK_DATA);
+    // ENXIO: no hay más datos desde position, el resto es un hueco
+    if (data < 0 && errno == ENXIO) break;
+    off_t hole = data < 0 ? -1 : lseek(fd, data, SEEK_HOLE);
+    if (hole < 0) {
+      if (errno != EINVAL && errno != EOPNOTSUPP) throw std::system_error(errno, std::system_category());
+      return { { 0, size } };
+    }
+    uint64_t end = std::min<uint64_t>(hole, size);
+    if (end > static_cast<uint64_t>(data)) ranges.emplace_back(data, end - data);
+    position = end;
+  }
+  return ranges;
+}
+
+/**
+ * @brief Escribe un bloque en una posición, reintentando las escrituras parciales.
+ * @throw std::system_error Si falla la escritura.
+ */
+void WriteAt(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+  while (size > 0) {
+    ssize_t bytes_written = pwrite(fd, data, size, offset);
+    if (bytes_written < 0 && errno == EINTR) continue;
+    if (bytes_written < 0) throw std::system_error(errno, std::system_category());
+    data += bytes_written;
+    size -= bytes_written;
+    offset += bytes_written;
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Decide cómo escribir el destino de una copia entre dos archivos regulares: qué tramos
+ *        del origen tienen datos, si se reserva su espacio y con qué tamaño y alineación se
+ *        escribe según el sistema de archivos y el dispositivo del destino.
+ * @param source_fd Descriptor del origen.
+ * @param destination_fd Descriptor del destino.
+ * @throw std::system_error Si no se pueden obtener los atributos o los tramos del origen.
+ */
+WritePlan PlanWrite(int source_fd, int destination_fd) {
+  struct stat source_stat{};
+  struct stat destination_stat{};
+  if (fstat(source_fd, &source_stat) < 0 || fstat(destination_fd, &destination_stat) < 0) {
+    throw std::system_error(errno, std::system_category());
+  }
+  WritePlan plan;
+  plan.size = source_stat.st_size;
+  plan.block_size = std::max<size_t>(destination_stat.st_blksize, OptimalIoSize(destination_stat.st_dev));
+  if (plan.block_size == 0) plan.block_size = 4096;
+  plan.chunk_size = std::max(plan.block_size, kPlannedChunkSize / plan.block_size * plan.block_size);
+  plan.data_ranges = FindDataRanges(source_fd, plan.size);
+  struct statfs destination_fs{};
+  bool may_share_extents =
+      source_stat.st_dev == destination_stat.st_dev && fstatfs(destination_fd, &destination_fs) == 0 &&
+      (destination_fs.f_type == BTRFS_SUPER_MAGIC || destination_fs.f_type == XFS_SUPER_MAGIC);
+  plan.preallocate = !may_share_extents;
+  return plan;
+}
+
+/**
+ * @brief Copia un archivo regular entero en otro siguiendo un WritePlan. Primero reserva con
+ *        fallocate el espacio de los tramos con datos, para que el sistema de archivos lo
+ *        asigne de una vez en extents grandes (y un disco lleno se detecte antes de copiar),
+ *        y después copia cada tramo con copy_file_range (o pread y pwrite si no se puede)
+ *        en bloques de plan.chunk_size que terminan en múltiplos de plan.block_size. Los
+ *        huecos no se escriben. Si el origen ha crecido se copia también lo añadido, y al
+ *        final se ajusta el tamaño del destino con ftruncate, también si el origen ha menguado.
+ *        La reserva no cambia el tamaño del destino (FALLOC_FL_KEEP_SIZE), y si la copia falla
+ *        el destino se vacía, así que nunca queda un archivo del tamaño del origen a medias.
+ * @param source_fd Descriptor del origen.
+ * @param destination_fd Descriptor del destino, vacío.
+ * @param buffer Buffer si no se puede copiar en el kernel (nulo para reservar uno propio).
+ * @param progress Si no es nulo, se actualiza con los bytes copiados, se comprueba si se ha
+ *                 cancelado y se aplica su límite de velocidad.
+ * @throw std::system_error Si falla la lectura, la escritura o no hay espacio para la reserva.
+ * @throw CopyCancelled Si se cancela la copia.
+ *
+ * @return Tamaño final del destino.
+ */
+uint64_t PlannedCopy(int source_fd, int destination_fd, std::vector<uint8_t>* buffer, CopyProgress* progress) {
+  WritePlan plan = PlanWrite(source_fd, destination_fd);
+  try {
+    if (plan.preallocate) {
+      for (const auto& [offset, length] : plan.data_ranges) {
+        if (fallocate(destination_fd, FALLOC_FL_KEEP_SIZE, offset, length) == 0) continue;
+        if (errno == ENOSPC || errno == EDQUOT) throw std::system_error(errno, std::system_category());
+        // El sistema de archivos no admite fallocate: se copia sin reservar
+        break;
+      }
+    }
+
+    std::vector<uint8_t> own_buffer;
+    bool use_kernel = true;
+    uint64_t end = 0;
+    // Copia un tramo; devuelve false si el origen se acaba antes
+    auto copy_range = [&](uint64_t offset, uint64_t length) {
+      while (length > 0) {
+        if (progress != nullptr && progress->is_cancelled) throw CopyCancelled();
+        uint64_t limit = offset + ThrottledChunkSize(progress, plan.chunk_size);
+        // Cada escritura termina alineada, así que la siguiente empieza alineada
+        if (limit / plan.block_size * plan.block_size > offset) limit = limit / plan.block_size * plan.block_size;
+        size_t chunk = std::min(limit - offset, length);
+        ssize_t bytes_copied;
+        if (use_kernel) {
+          loff_t source_offset = offset;
+          loff_t destination_offset = offset;
+          bytes_copied = copy_file_range(source_fd, &source_offset, destination_fd, &destination_offset, chunk, 0);
+          if (bytes_copied < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EXDEV && errno != EINVAL && errno != EBADF && errno != ENOSYS && errno != EOPNOTSUPP) {
+              throw std::system_error(errno, std::system_category());
+            }
+            // Las posiciones son explícitas, así que se puede seguir con pread y pwrite desde aquí
+            use_kernel = false;
+            if (buffer == nullptr) {
+              own_buffer.resize(kCopyBufferSize);
+              buffer = &own_buffer;
+            }
+            continue;
+          }
+        } else {
+          size_t buffer_chunk = buffer->size() / plan.block_size * plan.block_size;
+          chunk = std::min(chunk, buffer_chunk > 0 ? buffer_chunk : buffer->size());
+          bytes_copied = pread(source_fd, buffer->data(), chunk, offset);
+          if (bytes_copied < 0 && errno == EINTR) continue;
+          if (bytes_copied < 0) throw std::system_error(errno, std::system_category());
+          WriteAt(destination_fd, buffer->data(), bytes_copied, offset);
+        }
+        if (bytes_copied == 0) return false;
+        offset += bytes_copied;
+        length -= bytes_copied;
+        end = std::max(end, offset);
+        if (progress != nullptr) progress->bytes_copied += bytes_copied;
+        ThrottleCopy(progress, bytes_copied);
+      }
+      return true;
+    };
+    bool is_complete = true;
+    for (const auto& [offset, length] : plan.data_ranges) {
+      if (!copy_range(offset, length)) {
+        is_complete = false;
+        break;
+      }
+    }
+    if (is_complete) {
+      // Lo que se haya añadido al origen desde que se planificó
+      end = plan.size;
+      copy_range(plan.size, std::numeric_limits<uint64_t>::max() - plan.size);
+    }
+    // Quita lo reservado de más si el origen ha menguado y crea el hueco final si lo hay
+    if (ftruncate(destination_fd, end) < 0) throw std::system_error(errno, std::system_category());
+    return end;
+  } catch (...) {
+    // Se libera lo reservado y lo escrito
+    ftruncate(destination_fd, 0);
+    throw;
+  }
+}
+
+/**
+ * @brief Número de extents de un archivo, para medir su fragmentación. Antes se escriben sus
+ *        datos pendientes para que el sistema de archivos les asigne sitio.
+ * @param fd Descriptor del archivo.
+ *
+ * @return El número de extents, o 0 si el sistema de archivos no admite FIEMAP.
+ */
+uint64_t CountExtents(int fd) {
+  struct fiemap map{};
+  map.fm_start = 0;
+  map.fm_length = FIEMAP_MAX_OFFSET;
+  map.fm_flags = FIEMAP_FLAG_SYNC;
+  // Sin espacio para extents el kernel solo los cuenta
+  map.fm_extent_count = 0;
+  if (ioctl(fd, FS_IOC_FIEMAP, &map) < 0) return 0;
+  return map.fm_mapped_extents;
+}
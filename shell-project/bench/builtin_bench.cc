@@ -0,0 +1,83 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: builtin_bench.cc
+ * @brief: in-process builtins vs exec'd binaries benchmark
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+
+#include "shell.h"
+#include "usages.h"
+
+/**
+ * @brief Ejecuta un comando varias veces a través de Shell::ExecuteCommand.
+ * @param shell Shell con la que ejecutar el comando.
+ * @param args Comando y argumentos.
+ * @param iterations Número de repeticiones.
+ *
+ * @return Tiempo medio por ejecución en microsegundos.
+ */
+double TimeCommand(Shell& shell, const std::vector<std::string>& args, int iterations) {
+  Command command{args};
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) shell.ExecuteCommand(command);
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+int main(const int argc, const char* argv[]) {
+  try {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 500;
+    // Archivo de prueba con algunas líneas de texto
+    char path[] = "/tmp/builtin_bench_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) throw std::system_error(errno, std::system_category());
+    std::string content;
+    for (int i = 0; i < 1000; ++i) content += "line " + std::to_string(i) + " of the benchmark file\n";
+    write(fd, content.data(), content.size());
+    close(fd);
+    // La salida de los comandos se descarta; los resultados van a la salida estándar original
+    int results_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+
+    Shell shell;
+    std::stringstream results;
+    results << std::fixed << std::setprecision(2);
+    results << std::left << std::setw(8) << "command" << std::setw(16) << "in-process(us)"
+            << std::setw(14) << "exec(us)" << "speedup\n";
+    const std::vector<std::vector<std::string>> commands = {
+      { "cat", path },
+      { "head", "-n", "20", path },
+      { "stat", path },
+    };
+    for (const auto& args : commands) {
+      std::vector<std::string> external_args = args;
+      external_args[0] = "/usr/bin/" + args[0];
+      double builtin_time = TimeCommand(shell, args, iterations);
+      double exec_time = TimeCommand(shell, external_args, iterations);
+      results << std::setw(8) << args[0] << std::setw(16) << builtin_time
+              << std::setw(14) << exec_time << exec_time / builtin_time << "x\n";
+    }
+    std::string output = results.str();
+    write(results_fd, output.data(), output.size());
+    unlink(path);
+  } catch (const std::exception& error) {
+    PrintException(error);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: output_bench.cc
+ * @brief: write syscall count of the buffered output writer vs std::cout + std::endl
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+#include "output_writer.h"
+#include "shell.h"
+#include "usages.h"
+
+/**
+ * @brief Número de llamadas al sistema de escritura hechas por el proceso (syscw de /proc/self/io).
+ */
+long WriteSyscalls() {
+  std::ifstream io("/proc/self/io");
+  std::string key;
+  long value;
+  while (io >> key >> value) {
+    if (key == "syscw:") return value;
+  }
+  return -1;
+}
+
+/**
+ * @brief Resultado de una de las pruebas: llamadas de escritura y tiempo total.
+ */
+struct Measure {
+  long syscalls;
+  double wall_ms;
+};
+
+/**
+ * @brief Mide las escrituras y el tiempo de una función.
+ * @param function Función a medir.
+ */
+template <typename Function>
+Measure MeasureWrites(Function function) {
+  long start_syscalls = WriteSyscalls();
+  auto start = std::chrono::steady_clock::now();
+  function();
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return { WriteSyscalls() - start_syscalls, elapsed.count() };
+}
+
+int main(const int argc, const char* argv[]) {
+  try {
+    int lines = argc > 1 ? std::atoi(argv[1]) : 10000;
+    // La salida de los comandos va a un archivo temporal (no es un terminal: buffer completo)
+    char path[] = "/tmp/output_bench_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) throw std::system_error(errno, std::system_category());
+    unlink(path);
+    int results_fd = dup(STDOUT_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    Shell shell;
+    Command echo{{"echo", "hello", "world"}};
+    // Como antes: cada argumento por std::cout y un std::endl tras cada comando
+    Measure stream = MeasureWrites([&] {
+      for (int i = 0; i < lines; ++i) {
+        for (size_t j = 1; j < echo.args.size(); ++j) std::cout << echo.args[j] << " ";
+        std::cout << std::endl;
+      }
+    });
+    // Con el buffer de salida, volcando al acabar cada comando (como en un terminal)
+    Measure terminal = MeasureWrites([&] {
+      for (int i = 0; i < lines; ++i) {
+        shell.ExecuteCommand(echo);
+        StandardOutput().Flush();
+      }
+    });
+    // Con el buffer de salida y la salida redirigida (buffer completo)
+    Measure buffered = MeasureWrites([&] {
+      for (int i = 0; i < lines; ++i) {
+        shell.ExecuteCommand(echo);
+        StandardOutput().EndCommand();
+      }
+      StandardOutput().Flush();
+    });
+
+    std::stringstream results;
+    results << std::fixed << std::setprecision(2);
+    results << lines << " x echo hello world\n";
+    results << std::left << std::setw(28) << "mode" << std::setw(14) << "write calls" << "time(ms)\n";
+    results << std::setw(28) << "std::cout + std::endl" << std::setw(14) << stream.syscalls << stream.wall_ms << '\n';
+    results << std::setw(28) << "writer, flush per command" << std::setw(14) << terminal.syscalls << terminal.wall_ms << '\n';
+    results << std::setw(28) << "writer, fully buffered" << std::setw(14) << buffered.syscalls << buffered.wall_ms << '\n';
+    std::string output = results.str();
+    write(results_fd, output.data(), output.size());
+    close(results_fd);
+  } catch (const std::exception& error) {
+    PrintException(error);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,256 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: shell_bench.cc
+ * @brief: latency benchmark of the shell hot paths, with JSON percentiles
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <thread>
+
+#include "completion.h"
+#include "output_writer.h"
+#include "shell.h"
+#include "trace.h"
+#include "usages.h"
+
+/**
+ * @brief Tiempos de una prueba en nanosegundos, con las estadísticas en JSON.
+ *        Si se indica cuántos bytes procesa cada iteración se añade el rendimiento.
+ */
+class Samples {
+ public:
+  explicit Samples(size_t expected) { samples_ns_.reserve(expected); }
+
+  template <typename Function>
+  void Measure(Function function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    samples_ns_.push_back(elapsed.count());
+  }
+
+  inline void AddBytes(uint64_t bytes) { bytes_ += bytes; }
+
+  std::string ToJson() {
+    std::sort(samples_ns_.begin(), samples_ns_.end());
+    double total = 0;
+    for (double sample : samples_ns_) total += sample;
+    std::stringstream json;
+    json << std::fixed << std::setprecision(1);
+    json << "{\"iterations\": " << samples_ns_.size()
+         << ", \"mean_ns\": " << (samples_ns_.empty() ? 0 : total / samples_ns_.size())
+         << ", \"p50_ns\": " << Percentile(0.50) << ", \"p90_ns\": " << Percentile(0.90)
+         << ", \"p99_ns\": " << Percentile(0.99) << ", \"max_ns\": " << Percentile(1.0);
+    if (bytes_ > 0 && total > 0) json << ", \"throughput_mb_s\": " << bytes_ / (total / 1e9) / (1024 * 1024);
+    json << "}";
+    return json.str();
+  }
+
+ private:
+  double Percentile(double fraction) const {
+    if (samples_ns_.empty()) return 0;
+    size_t index = static_cast<size_t>(fraction * (samples_ns_.size() - 1) + 0.5);
+    return samples_ns_[index];
+  }
+
+  std::vector<double> samples_ns_;
+  uint64_t bytes_ = 0;
+};
+
+/**
+ * @brief Líneas de prueba con las formas habituales: comandos sueltos, tuberías,
+ *        varias sentencias, segundo plano y redirecciones.
+ */
+const std::vector<std::string> kLines = {
+  "ls -la /tmp",
+  "cp -a build/bin/Shell /tmp/shell_copy ; mv /tmp/shell_copy /tmp/shell_moved",
+  "cat src/shell.cc | head -n 20 | grep include",
+  "sleep 1 & jobs",
+  "echo hello world > /tmp/out.txt 2>&1",
+  "parallel -j 4 gzip ::: a.log b.log c.log d.log",
+};
+
+/**
+ * @brief Mide ParseLine y Split sobre las líneas de prueba.
+ */
+std::string BenchParse(int iterations) {
+  Samples parse(iterations * kLines.size());
+  Samples split(iterations * kLines.size());
+  for (int i = 0; i < iterations; ++i) {
+    for (const auto& line : kLines) {
+      parse.Measure([&line] { ParseLine(line); });
+      parse.AddBytes(line.size());
+      split.Measure([&line] { Split(line, { ' ', '\t' }, { '|', ';', '&' }); });
+      split.AddBytes(line.size());
+    }
+  }
+  return "  \"parse_line\": " + parse.ToJson() + ",\n  \"split\": " + split.ToJson();
+}
+
+/**
+ * @brief Mide ReadInput + PopLine leyendo de una tubería que llena otro hilo.
+ */
+std::string BenchReadInput(int lines) {
+  int pipe_fds[2];
+  if (pipe(pipe_fds) < 0) throw std::system_error(errno, std::system_category());
+  std::thread writer([fd = pipe_fds[1], lines] {
+    std::string block;
+    for (int i = 0; i < lines; ++i) block += kLines[i % kLines.size()] + "\n";
+    WriteFile(fd, reinterpret_cast<const uint8_t*>(block.data()), block.size());
+    close(fd);
+  });
+  Samples read_input(lines);
+  std::string pending_input;
+  std::string line;
+  int lines_read = 0;
+  ssize_t bytes_read = 1;
+  while (bytes_read > 0) {
+    read_input.Measure([&] {
+      bytes_read = ReadInput(pipe_fds[0], pending_input);
+      while (PopLine(pending_input, line)) ++lines_read;
+    });
+    read_input.AddBytes(bytes_read);
+  }
+  writer.join();
+  close(pipe_fds[0]);
+  if (lines_read != lines) throw std::runtime_error("shell_bench: lost lines reading the pipe");
+  return "  \"read_input\": " + read_input.ToJson();
+}
+
+/**
+ * @brief Mide PrintPrompt. El prompt solo se muestra si la entrada es un terminal,
+ *        así que la entrada estándar se sustituye por un pseudoterminal.
+ */
+std::string BenchPrompt(int iterations) {
+  int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master_fd < 0 || grantpt(master_fd) < 0 || unlockpt(master_fd) < 0) {
+    throw std::system_error(errno, std::system_category());
+  }
+  int terminal_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY);
+  if (terminal_fd < 0) throw std::system_error(errno, std::system_category());
+  int saved_stdin = dup(STDIN_FILENO);
+  dup2(terminal_fd, STDIN_FILENO);
+  Samples prompt(iterations);
+  for (int i = 0; i < iterations; ++i) prompt.Measure([] { PrintPrompt(0); });
+  dup2(saved_stdin, STDIN_FILENO);
+  close(saved_stdin);
+  close(terminal_fd);
+  close(master_fd);
+  return "  \"print_prompt\": " + prompt.ToJson();
+}
+
+/**
+ * @brief Mide lo que cuesta ejecutar comandos internos a través de ExecuteCommand.
+ */
+std::string BenchDispatch(Shell& shell, int iterations) {
+  Command echo{{ "echo", "hello" }};
+  Command cd{{ "cd", "." }};
+  Samples echo_samples(iterations);
+  Samples cd_samples(iterations);
+  for (int i = 0; i < iterations; ++i) {
+    echo_samples.Measure([&] { shell.ExecuteCommand(echo); });
+    cd_samples.Measure([&] { shell.ExecuteCommand(cd); });
+  }
+  StandardOutput().Flush();
+  return "  \"dispatch_echo\": " + echo_samples.ToJson() + ",\n  \"dispatch_cd\": " + cd_samples.ToJson();
+}
+
+/**
+ * @brief Mide ExecuteProgram con /bin/true, desde el fork hasta que se recoge al hijo.
+ */
+std::string BenchSpawn(Shell& shell, int iterations) {
+  Samples spawn(iterations);
+  for (int i = 0; i < iterations; ++i) spawn.Measure([&] { shell.ExecuteProgram({ "/bin/true" }, true); });
+  return "  \"execute_program_true\": " + spawn.ToJson();
+}
+
+/**
+ * @brief Mide la completación en un directorio con muchas entradas: la primera vez (que lee el
+ *        directorio) y las siguientes, con el índice ya construido, y la de los comandos de PATH.
+ * @param entries Entradas del directorio de prueba.
+ * @param iterations Completaciones que se miden con el índice construido.
+ */
+std::string BenchCompletion(int entries, int iterations) {
+  std::string directory = "/tmp/shell_bench_completion";
+  std::filesystem::create_directory(directory);
+  for (int i = 0; i < entries; ++i) {
+    close(open((directory + "/entry_" + std::to_string(i)).c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644));
+  }
+  // Se espera a que la fecha del directorio deje de ser reciente, para que el índice se fíe de ella
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  CompletionIndex index;
+  Samples cold(1);
+  Samples warm(iterations);
+  Samples command(iterations);
+  cold.Measure([&] { index.CompletePath(directory + "/entry_4242"); });
+  for (int i = 0; i < iterations; ++i) {
+    warm.Measure([&] { index.CompletePath(directory + "/entry_" + std::to_string(i % entries)); });
+  }
+  index.CompleteCommand("l", {});
+  for (int i = 0; i < iterations; ++i) command.Measure([&] { index.CompleteCommand("l", {}); });
+  std::filesystem::remove_all(directory);
+  return "  \"complete_path_cold_" + std::to_string(entries) + "\": " + cold.ToJson() + ",\n  \"complete_path_" +
+         std::to_string(entries) + "\": " + warm.ToJson() + ",\n  \"complete_command\": " + command.ToJson() +
+         ",\n  \"completion_scans\": " + std::to_string(index.GetScans());
+}
+
+/**
+ * @brief Mide lo que cuestan 1000 TraceSpan seguidos con el trazado desactivado y activado.
+ *        Va al final porque el trazado no se puede volver a desactivar.
+ */
+std::string BenchTrace(int iterations) {
+  constexpr int kSpans = 1000;
+  Samples disabled(iterations);
+  Samples enabled(iterations);
+  for (int i = 0; i < iterations; ++i) {
+    disabled.Measure([] {
+      for (int span = 0; span < kSpans; ++span) TraceSpan trace_span("bench");
+    });
+  }
+  EnableTracing("/dev/null");
+  for (int i = 0; i < iterations; ++i) {
+    enabled.Measure([] {
+      for (int span = 0; span < kSpans; ++span) TraceSpan trace_span("bench");
+    });
+  }
+  return "  \"trace_1000_spans_disabled\": " + disabled.ToJson() + ",\n  \"trace_1000_spans_enabled\": " +
+         enabled.ToJson();
+}
+
+int main(const int argc, const char* argv[]) {
+  try {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int spawn_iterations = argc > 2 ? std::atoi(argv[2]) : 500;
+    int completion_entries = argc > 3 ? std::atoi(argv[3]) : 100000;
+    // La salida de los comandos se descarta; el JSON va a la salida estándar original
+    int results_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+
+    Shell shell;
+    std::string json = "{\n" + BenchParse(iterations) + ",\n" + BenchReadInput(iterations * 10) + ",\n" +
+                       BenchPrompt(iterations / 10) + ",\n" + BenchDispatch(shell, iterations) + ",\n" +
+                       BenchSpawn(shell, spawn_iterations) + ",\n" +
+                       BenchCompletion(completion_entries, iterations / 10) + ",\n" + BenchTrace(iterations / 100) +
+                       "\n}\n";
+    write(results_fd, json.data(), json.size());
+    close(results_fd);
+  } catch (const std::exception& error) {
+    PrintException(error);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,36 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: builtin_plugin.h
+ * @brief: interface of builtins loaded from shared objects
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef BUILTIN_PLUGIN_H
+#define BUILTIN_PLUGIN_H
+
+/**
+ * Una biblioteca de comandos internos es un objeto compartido que exporta el símbolo
+ * SHELL_BUILTINS_SYMBOL: un vector de ShellBuiltinEntry terminado en { nullptr, nullptr }.
+ * Se carga desde la shell con: enable -f ruta/a/la/biblioteca.so
+ */
+extern "C" {
+
+typedef int (*ShellBuiltinFunction)(const int argc, const char* argv[]);
+
+struct ShellBuiltinEntry {
+  const char* name;
+  ShellBuiltinFunction function;
+};
+
+}
+
+#define SHELL_BUILTINS_SYMBOL "shell_builtins"
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: builtins.h
+ * @brief: builtin commands dispatch table
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Shell;
+
+using BuiltinFunction = int (Shell::*)(const std::vector<std::string>& args);
+
+/**
+ * @brief Estructura que representa un comando interno de la shell
+ * [+] name = nombre del comando
+ * [+] function = método de Shell que lo implementa
+ */
+struct Builtin {
+  std::string_view name;
+  BuiltinFunction function;
+};
+
+/**
+ * @brief Hash FNV-1a de un nombre de comando. Es constexpr para poder construir
+ *        la tabla de comandos internos en tiempo de compilación.
+ * @param name Nombre del comando.
+ *
+ * @return Hash de 32 bits del nombre.
+ */
+constexpr uint32_t HashBuiltinName(std::string_view name) {
+  uint32_t hash = 2166136261u;
+  for (char symbol : name) {
+    hash ^= static_cast<uint8_t>(symbol);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+const Builtin* FindBuiltin(std::string_view name);
+std::vector<std::string> GetBuiltinNames();
+
+#endif
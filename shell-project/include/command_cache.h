@@ -0,0 +1,73 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: command_cache.h
+ * @brief: on-disk content-addressed cache of command output
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef COMMAND_CACHE_H
+#define COMMAND_CACHE_H
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Almacén en disco de la salida de comandos deterministas (builtin cache).
+ *        La salida estándar se guarda en objects/ con su hash como nombre, así que las
+ *        salidas iguales se guardan una sola vez, y cada clave (hash de los argumentos,
+ *        el directorio actual, las variables de entorno elegidas y los archivos de entrada)
+ *        tiene en keys/ un registro con el valor de salida y el objeto de su salida.
+ */
+class CommandCache {
+ public:
+  inline void SetDirectory(const std::string& directory) { directory_ = directory; }
+  inline const std::string& GetDirectory() const { return directory_; }
+
+  std::string Key(const std::vector<std::string>& args, const std::vector<std::string>& env_names,
+                  const std::vector<std::string>& key_files);
+  int Lookup(const std::string& key, int& return_value);
+  void Store(const std::string& key, int return_value, int output_fd);
+  void Clear();
+
+  inline uint64_t GetHits() const { return hits_; }
+  inline uint64_t GetMisses() const { return misses_; }
+  inline uint64_t GetBytesServed() const { return bytes_served_; }
+  inline void AddBytesServed(uint64_t bytes) { bytes_served_ += bytes; }
+
+ private:
+  /**
+   * @brief Hash ya calculado del contenido de un archivo de entrada, válido
+   *        mientras no cambien su inodo, tamaño o fecha de modificación.
+   */
+  struct FileHash {
+    ino_t inode;
+    off_t size;
+    int64_t mtime_ns;
+    std::string hash;
+  };
+
+  std::string HashFile(const std::string& path, const struct stat& file_stat);
+  void WriteAtomically(const std::string& path, int source_fd, const std::string& data);
+
+  std::string directory_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t bytes_served_ = 0;
+  uint64_t temporary_files_ = 0;
+  std::unordered_map<std::string, FileHash> file_hashes_;
+};
+
+std::string DefaultCacheDirectory();
+
+#endif
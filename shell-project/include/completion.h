@@ -0,0 +1,103 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: completion.h
+ * @brief: cached directory and PATH index for tab completion
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef COMPLETION_H
+#define COMPLETION_H
+
+#include <sys/types.h>
+#include <time.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Directorios cuyo listado se mantiene en memoria (los usados más recientemente)
+constexpr size_t kMaxCachedDirectories = 64;
+
+// Candidatos que se guardan como mucho en un CompletionResult (el resto solo se cuenta)
+constexpr size_t kMaxCompletions = 256;
+
+/**
+ * @brief Resultado de completar una palabra
+ * [+] candidates = palabras completas, ordenadas; los directorios acaban en '/' (como mucho
+ *                  kMaxCompletions)
+ * [+] total = número total de candidatos
+ * [+] common_prefix = prefijo común de todos los candidatos, que se puede escribir ya
+ */
+struct CompletionResult {
+  std::vector<std::string> candidates;
+  size_t total = 0;
+  std::string common_prefix;
+};
+
+/**
+ * @brief Índice de nombres para completar con el tabulador. Guarda en memoria el listado
+ *        ordenado de los directorios usados recientemente (los de PATH y los de las rutas que
+ *        se completan), leído de una vez con getdents64, así que cada tabulación es una
+ *        búsqueda binaria y un stat por directorio. Un listado se vuelve a leer cuando cambia
+ *        la fecha de modificación del directorio, o si cambió tan cerca de la lectura que
+ *        otra modificación en el mismo instante no se notaría.
+ */
+class CompletionIndex {
+ public:
+  CompletionResult CompleteCommand(std::string_view prefix, const std::vector<std::string>& builtins);
+  CompletionResult CompletePath(std::string_view word);
+  inline uint64_t GetScans() const { return scans_; }
+
+ private:
+  // Lo que se sabe de una entrada además de su d_type: se averigua con stat solo cuando hace falta
+  static constexpr uint8_t kResolved = 1;
+  static constexpr uint8_t kDirectory = 2;
+  static constexpr uint8_t kExecutable = 4;
+
+  /**
+   * @brief Entrada de un listado: su nombre está en names[offset, offset + length)
+   */
+  struct Entry {
+    uint32_t offset;
+    uint32_t length;
+    unsigned char type;
+    uint8_t flags;
+  };
+
+  /**
+   * @brief Listado de un directorio
+   * [+] device, inode, mtime = identidad y fecha de modificación del directorio al leerlo
+   * [+] is_racy = si se modificó en el mismo segundo en que se leyó (no se puede fiar de mtime)
+   * [+] names = todos los nombres en un único bloque de memoria
+   * [+] entries = entradas ordenadas por nombre
+   * [+] last_use = cuándo se usó por última vez, para descartar los menos usados
+   */
+  struct Listing {
+    dev_t device = 0;
+    ino_t inode = 0;
+    struct timespec mtime{};
+    bool is_racy = false;
+    std::string names;
+    std::vector<Entry> entries;
+    uint64_t last_use = 0;
+  };
+
+  Listing* GetListing(const std::string& directory);
+  void ScanListing(const std::string& directory, Listing& listing);
+  uint8_t Resolve(const std::string& directory, const Listing& listing, Entry& entry) const;
+
+  std::unordered_map<std::string, Listing> listings_;
+  uint64_t uses_ = 0;
+  uint64_t scans_ = 0;
+};
+
+#endif
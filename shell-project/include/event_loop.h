@@ -0,0 +1,59 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: event_loop.h
+ * @brief: event_loop class
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
+
+/**
+ * @brief Bucle de eventos basado en epoll. Multiplexa descriptores (stdin, signalfd...)
+ *        y temporizadores (timerfd) y llama al callback asociado a cada uno.
+ */
+class EventLoop {
+ public:
+  using Callback = std::function<void()>;
+
+  EventLoop();
+  ~EventLoop();
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+  // Descriptores vigilados
+  void AddFd(int fd, const Callback& callback);
+  void RemoveFd(int fd);
+
+  // Temporizadores. Devuelven un identificador para poder cancelarlos.
+  int AddTimer(std::chrono::milliseconds timeout, const Callback& callback, bool is_periodic = false);
+  void CancelTimer(int timer_id);
+
+  // Ejecución del bucle
+  void RunOnce(int timeout_ms = -1);
+  void Run();
+  inline void Stop() { is_running_ = false; }
+  inline bool IsRunning() const { return is_running_; }
+
+ private:
+  int epoll_fd_;
+  bool is_running_ = false;
+  std::map<int, Callback> callbacks_;
+  std::map<int, bool> timers_;
+  // Descriptores que epoll no admite (archivos regulares): siempre están listos
+  std::set<int> always_ready_;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: expansion.h
+ * @brief: variable and glob word expansion
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef EXPANSION_H
+#define EXPANSION_H
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "shell_system.h"
+
+// Tamaño del buffer de getdents64: unas 30000 entradas por llamada
+constexpr size_t kDirentBufferSize = 1ul * 1024 * 1024;
+
+/**
+ * @brief Entrada de directorio tal y como la devuelve getdents64 (la usan los globs y el
+ *        índice de la completación).
+ */
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+/**
+ * @brief Patrón de glob (*, ?, [...], [!...] y \ para escapar) compilado una sola vez
+ *        a una lista de elementos. Los patrones de la forma prefijo*sufijo (como *.log)
+ *        se comparan solo con el prefijo y el sufijo.
+ */
+class GlobPattern {
+ public:
+  explicit GlobPattern(std::string_view pattern);
+
+  bool Match(std::string_view name) const;
+  inline bool MatchesHidden() const { return matches_hidden_; }
+
+ private:
+  enum class TokenType : uint8_t { kLiteral, kAnyChar, kStar, kClass };
+
+  /**
+   * @brief Elemento del patrón. En los literales index y length indican el texto dentro
+   *        de literals_; en las clases, index es la posición en classes_.
+   */
+  struct Token {
+    TokenType type;
+    uint32_t index;
+    uint32_t length;
+  };
+
+  std::vector<Token> tokens_;
+  std::string literals_;
+  std::vector<std::bitset<256>> classes_;
+  std::string prefix_;
+  std::string suffix_;
+  size_t min_length_ = 0;
+  bool is_prefix_suffix_ = false;
+  bool matches_hidden_ = false;
+};
+
+bool HasGlobCharacters(std::string_view word);
+std::vector<std::string> ExpandGlob(const std::string& pattern);
+std::string ExpandVariables(const std::string& word, int last_status);
+Command ExpandCommand(const Command& command, int last_status);
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: history.h
+ * @brief: persistent command history class
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <sys/types.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Historial de comandos persistente. El archivo solo se amplía (una línea por comando):
+ *        lo que se añade se lee con pread a bloques propios (no se proyecta: si otra shell o el
+ *        usuario trunca el archivo, una proyección daría SIGBUS), y los comandos nuevos se
+ *        escriben por lotes con O_APPEND y flock, de modo que varias shells pueden compartir el
+ *        mismo archivo.
+ *        Las búsquedas usan un índice que se construye en un hilo aparte al abrir el historial:
+ *        un vector ordenado para los prefijos y un índice de trigramas para las subcadenas.
+ */
+class History {
+ public:
+  History() = default;
+  ~History();
+  History(const History&) = delete;
+  History& operator=(const History&) = delete;
+
+  void Open(const std::string& path);
+  inline bool IsOpen() const { return fd_ >= 0; }
+
+  void Add(const std::string& line);
+  void Flush();
+  void Refresh();
+
+  inline size_t Size() const { return entries_.size(); }
+  inline std::string_view Get(size_t index) const { return entries_[index]; }
+
+  std::vector<std::string_view> SearchPrefix(std::string_view prefix, size_t limit);
+  std::vector<std::string_view> SearchSubstring(std::string_view text, size_t limit);
+
+ private:
+  void ReadRegion(off_t end);
+  void IndexEntries(const std::vector<std::string_view>& entries);
+  void UpdateTrigramIndex();
+  std::vector<std::string_view> MostRecent(std::vector<uint32_t>& unique_ids, size_t limit) const;
+
+  // Comandos que se acumulan antes de escribirlos en el archivo
+  static constexpr size_t kBatchSize = 16;
+
+  int fd_ = -1;
+  off_t read_size_ = 0;
+  std::deque<std::string> chunks_;
+  std::deque<std::string> own_entries_;
+  std::vector<std::string> pending_;
+  std::vector<std::pair<off_t, off_t>> own_ranges_;
+  std::vector<std::string_view> entries_;
+
+  // Índice: comandos distintos, su uso más reciente, orden alfabético y trigramas.
+  // Lo protege index_mutex_ porque el índice inicial se construye en index_thread_.
+  std::thread index_thread_;
+  std::mutex index_mutex_;
+  size_t indexed_entries_ = 0;
+  size_t sorted_unique_ = 0;
+  uint32_t trigram_unique_ = 0;
+  std::unordered_map<std::string_view, uint32_t> unique_ids_;
+  std::vector<std::string_view> unique_entries_;
+  std::vector<uint32_t> last_use_;
+  std::vector<uint32_t> sorted_ids_;
+  std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams_;
+};
+
+std::string DefaultHistoryPath();
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: jobs.h
+ * @brief: job table class
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <sys/types.h>
+#include <map>
+#include <string>
+
+#include "copy_service.h"
+
+/**
+ * @brief Estado de un trabajo de la shell
+ */
+enum class JobState { kRunning, kStopped, kDone };
+
+/**
+ * @brief Estructura que representa un trabajo (proceso lanzado por la shell)
+ * [+] id = número de trabajo (%1, %2...)
+ * [+] pid = pid del proceso (y de su grupo de procesos)
+ * [+] command = línea con la que se lanzó
+ * [+] state = estado actual del trabajo
+ * [+] status = valor de salida cuando ha terminado
+ * [+] copy = copia de los cp y mv internos, que se ejecutan en el CopyService (pid 0)
+ */
+struct Job {
+  int id;
+  pid_t pid;
+  std::string command;
+  JobState state = JobState::kRunning;
+  int status = 0;
+  CopyHandle copy;
+
+  inline bool IsBuiltin() const { return pid == 0; }
+};
+
+/**
+ * @brief Tabla de trabajos de la shell
+ */
+class JobTable {
+ public:
+  Job& Add(pid_t pid, const std::string& command);
+  void Remove(int id);
+
+  Job* Find(const std::string& job_spec);
+  Job* FindByPid(pid_t pid);
+  Job* Current();
+
+  bool UpdateStatus(pid_t pid, int status);
+
+  inline std::map<int, Job>& GetJobs() { return jobs_; }
+  inline bool IsEmpty() const { return jobs_.empty(); }
+
+ private:
+  std::map<int, Job> jobs_;
+};
+
+std::string FormatJob(const Job& job);
+int StatusToReturnValue(int status);
+
+#endif
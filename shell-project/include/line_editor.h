@@ -0,0 +1,85 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: line_editor.h
+ * @brief: raw-mode line editor with history and tab completion
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef LINE_EDITOR_H
+#define LINE_EDITOR_H
+
+#include <termios.h>
+#include <unistd.h>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "completion.h"
+#include "history.h"
+
+/**
+ * @brief Editor de la línea de órdenes de la shell interactiva. Mientras se escribe una línea
+ *        pone el terminal en modo crudo y procesa cada tecla: edición (flechas, Inicio, Fin,
+ *        retroceso, Supr y los atajos de Emacs Ctrl-A/E/B/F/K/U/W/L), el historial con las
+ *        flechas arriba y abajo, y la completación con el tabulador. La entrada le llega desde
+ *        el bucle de eventos, así que nunca se bloquea esperando una tecla.
+ */
+class LineEditor {
+ public:
+  // Devuelve los candidatos para la palabra que acaba en cursor y dónde empieza esa palabra
+  using Completer = std::function<CompletionResult(const std::string& line, size_t cursor, size_t& word_start)>;
+
+  /**
+   * @brief Qué ha pasado con la entrada procesada
+   * [+] kEditing = la línea todavía no está terminada
+   * [+] kLine = se ha pulsado Intro: hay una línea completa y el terminal vuelve al modo normal
+   * [+] kEnd = Ctrl-D con la línea vacía: se acaba la entrada
+   */
+  enum class Status { kEditing, kLine, kEnd };
+
+  explicit LineEditor(int fd = STDIN_FILENO) : fd_(fd) {}
+  ~LineEditor();
+  LineEditor(const LineEditor&) = delete;
+  LineEditor& operator=(const LineEditor&) = delete;
+
+  inline void SetCompleter(const Completer& completer) { completer_ = completer; }
+  inline void SetHistory(const History* history) { history_ = history; }
+
+  void Start(const std::string& prompt);
+  void Stop();
+  void Redraw();
+  Status Feed(std::string& pending_input, std::string& line);
+
+ private:
+  size_t HandleEscape(std::string_view sequence);
+  void Insert(std::string_view text);
+  void MoveLeft();
+  void MoveRight();
+  void ShowHistory(size_t index);
+  void Complete(bool is_repeated);
+  void ListCandidates(const CompletionResult& result);
+  void RefreshLine();
+  void Write(std::string_view text);
+
+  int fd_;
+  bool is_editing_ = false;
+  bool has_original_mode_ = false;
+  struct termios original_mode_{};
+  const History* history_ = nullptr;
+  Completer completer_;
+  std::string prompt_;
+  std::string buffer_;
+  size_t cursor_ = 0;
+  size_t history_index_ = 0;
+  std::string saved_line_;
+  bool was_tab_ = false;
+};
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: output_writer.h
+ * @brief: buffered output writer shared by the builtins and the prompt
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Salida con buffer para los comandos internos y el prompt. Las escrituras se
+ *        acumulan en un buffer reutilizable y se vuelcan con un único writev: al acabar
+ *        cada comando si la salida es un terminal, antes de ejecutar un programa externo
+ *        y cuando el buffer se llena. Si la salida no es un terminal solo se vuelca en los
+ *        dos últimos casos (buffer completo).
+ */
+class OutputWriter {
+ public:
+  explicit OutputWriter(int fd);
+  ~OutputWriter();
+  OutputWriter(const OutputWriter&) = delete;
+  OutputWriter& operator=(const OutputWriter&) = delete;
+
+  void Write(const char* data, size_t size);
+  inline void Write(std::string_view text) { Write(text.data(), text.size()); }
+  void Flush();
+  void EndCommand();
+
+ private:
+  // Tamaño del buffer; las escrituras que no caben salen junto con él en el mismo writev
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  int fd_;
+  bool is_terminal_;
+  std::string buffer_;
+};
+
+OutputWriter& StandardOutput();
+
+#endif
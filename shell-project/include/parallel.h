@@ -0,0 +1,30 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: parallel.h
+ * @brief: concurrency-limited execution of independent commands
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <signal.h>
+#include <string>
+#include <vector>
+
+#include "shell_system.h"
+
+// Valor de salida máximo de parallel (número de trabajos fallidos, como GNU parallel)
+constexpr int kMaxParallelStatus = 101;
+
+int RunParallel(const std::vector<Command>& commands, size_t max_jobs, const sigset_t& child_mask);
+std::vector<std::string> ReadLines(int fd);
+
+#endif
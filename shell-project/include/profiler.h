@@ -0,0 +1,115 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: profiler.h
+ * @brief: command timing and resource usage profiler
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <sys/resource.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * @brief Estructura con las medidas de la ejecución de un comando
+ * [+] wall_us = tiempo real en microsegundos (reloj monotónico)
+ * [+] user_us = tiempo de CPU en modo usuario
+ * [+] sys_us = tiempo de CPU en modo sistema
+ * [+] spawn_us = tiempo desde el fork hasta que el exec del hijo tiene éxito (0 en los comandos internos)
+ * [+] max_rss_kb = memoria residente máxima
+ * [+] voluntary_switches = cambios de contexto voluntarios
+ * [+] involuntary_switches = cambios de contexto involuntarios
+ */
+struct CommandSample {
+  double wall_us = 0;
+  double user_us = 0;
+  double sys_us = 0;
+  double spawn_us = 0;
+  long max_rss_kb = 0;
+  long voluntary_switches = 0;
+  long involuntary_switches = 0;
+};
+
+/**
+ * @brief Histograma de tiempos en microsegundos con cubetas de potencias de 2:
+ *        la cubeta i cuenta los valores menores o iguales que 2^i.
+ */
+class Histogram {
+ public:
+  void Add(double value_us);
+  std::string ToJson() const;
+  inline uint64_t GetCount() const { return count_; }
+
+ private:
+  static constexpr size_t kBuckets = 40;
+  std::array<uint64_t, kBuckets> buckets_{};
+  uint64_t count_ = 0;
+  double sum_ = 0;
+  double min_ = 0;
+  double max_ = 0;
+};
+
+/**
+ * @brief Agrega las medidas de todos los comandos ejecutados por nombre de comando
+ *        y las vuelca en JSON al salir de la shell (modo --profile).
+ */
+class Profiler {
+ public:
+  inline void Enable(const std::string& output_path) { is_enabled_ = true; output_path_ = output_path; }
+  inline bool IsEnabled() const { return is_enabled_; }
+
+  void RecordCommand(const std::string& name, const CommandSample& sample);
+  void RecordParse(double wall_us);
+  std::string ToJson() const;
+  void Dump() const;
+
+ private:
+  /**
+   * @brief Medidas acumuladas de un comando
+   */
+  struct CommandStats {
+    Histogram wall_us;
+    Histogram user_us;
+    Histogram sys_us;
+    Histogram spawn_us;
+    long max_rss_kb = 0;
+    long voluntary_switches = 0;
+    long involuntary_switches = 0;
+  };
+
+  bool is_enabled_ = false;
+  std::string output_path_;
+  Histogram parse_us_;
+  std::map<std::string, CommandStats> commands_;
+};
+
+/**
+ * @brief Cronómetro de un comando: guarda el reloj monotónico y el uso de recursos
+ *        del hilo de la shell al empezar, y calcula la diferencia al parar.
+ */
+class CommandTimer {
+ public:
+  CommandTimer();
+  CommandSample Stop(const struct rusage* child_usage = nullptr) const;
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  struct rusage start_usage_{};
+};
+
+double TimevalToMicroseconds(const struct timeval& time);
+std::string JsonEscape(const std::string& text);
+
+#endif
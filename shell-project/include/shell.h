@@ -15,12 +15,22 @@
 #ifndef SHELL_H
 #define SHELL_H
 
+#include <signal.h>
 #include <sys/types.h>
 #include <string>
 #include <map>
 #include <functional>
 #include <vector>
 
+#include "builtin_plugin.h"
+#include "command_cache.h"
+#include "completion.h"
+#include "copy_service.h"
+#include "event_loop.h"
+#include "history.h"
+#include "profiler.h"
+#include "jobs.h"
+#include "line_editor.h"
 #include "shell_system.h"
 
 /**
@@ -30,27 +40,93 @@ class Shell {
  public:
   // Constructor
   Shell(const pid_t& procces_id) : procces_id_(procces_id) {}
-  Shell() : procces_id_(0) {}
+  Shell() : Shell(0) {}
+  ~Shell();
 
   // Getter
-  inline const std::vector<std::string>& GetInternalCommands() const { return internal_commands_; }
+  std::vector<std::string> GetInternalCommands() const;
 
   // Comandos internos de la shell
   int EchoCommand(const std::vector<std::string>& args);
   int CdCommand(const std::vector<std::string>& args);
   int CpCommand(const std::vector<std::string>& args);
   int MvCommand(const std::vector<std::string>& args);
+  int JobsCommand(const std::vector<std::string>& args);
+  int FgCommand(const std::vector<std::string>& args);
+  int BgCommand(const std::vector<std::string>& args);
+  int WaitCommand(const std::vector<std::string>& args);
+  int ExitCommand(const std::vector<std::string>& args);
+  int EnableCommand(const std::vector<std::string>& args);
+  int TimeCommand(const std::vector<std::string>& args);
+  int HistoryCommand(const std::vector<std::string>& args);
+  int ParallelCommand(const std::vector<std::string>& args);
+  int CacheCommand(const std::vector<std::string>& args);
+
+  // Utilidades ejecutadas dentro de la shell, sin fork ni exec
+  int CatCommand(const std::vector<std::string>& args);
+  int HeadCommand(const std::vector<std::string>& args);
+  int StatCommand(const std::vector<std::string>& args);
+
+  // Comandos internos cargados desde objetos compartidos
+  void LoadBuiltins(const std::string& path);
 
   // Comandos internos y externos
-  CommandResult ExecuteCommand(const std::vector<std::string>& commands);
-  int ExecuteProgram(const std::vector<std::string>& args, bool has_wait);
+  CommandResult ExecuteCommand(const Command& command);
+  int ExecuteProgram(const std::vector<std::string>& args, bool has_wait,
+                     const std::vector<Redirection>& redirections = {});
+
+  // Medidas de los comandos (modo --profile)
+  CommandSample MeasureCommand(const Command& command, CommandResult& result);
+  inline void EnableProfiling(const std::string& output_path) { profiler_.Enable(output_path); }
+
+  // Completación con el tabulador en la shell interactiva
+  CompletionResult CompleteWord(const std::string& line, size_t cursor, size_t& word_start);
 
   // Ejecutar la shell
   void Run();
 
  private:
+  // Bucle de eventos y control de trabajos
+  void SetupJobControl();
+  void HandleInput();
+  void HandleTerminalInput(ssize_t bytes_read);
+  void ShowPrompt();
+  void FlushHistory();
+  void HandleSignal();
+  void ReapChildren();
+  void NotifyJobs();
+  void ExecuteLine(const std::string& line);
+  CommandResult DispatchCommand(const Command& command);
+  int WaitForeground(Job& job);
+  int StartBackgroundCopy(const std::vector<std::string>& args, CopyRequest request);
+  void CopyInForeground(const CopyRequest& request);
+  void HandleIoCompletions();
+  int FinishBuiltinJob(Job& job);
+  void SignalJob(const Job& job, int signal_number);
+
   pid_t procces_id_;
-  std::vector<std::string> internal_commands_ = { "cd", "echo", "cp", "mv", "exit" };
+  std::map<std::string, ShellBuiltinFunction> loaded_builtins_;
+  std::vector<void*> plugin_handles_;
+  bool is_quit_requested_ = false;
+  bool is_background_ = false;
+  CopyService copy_service_;
+  Profiler profiler_;
+  History history_;
+  bool has_history_error_ = false;
+  LineEditor editor_;
+  CompletionIndex completion_;
+  CommandCache cache_;
+  bool is_measuring_ = false;
+  bool has_child_usage_ = false;
+  struct rusage child_usage_{};
+  double spawn_us_ = 0;
+  EventLoop event_loop_;
+  JobTable jobs_;
+  std::string pending_input_;
+  int signal_fd_ = -1;
+  sigset_t original_mask_{};
+  bool is_interactive_ = false;
+  int last_command_status_ = 0;
 };
 
 #endif
\ No newline at end of file
@@ -13,7 +13,7 @@
  * Enlaces de interés
  */
 #ifndef SHELL_SYSTEM_H
-#define SHELL_SYSTEM_h
+#define SHELL_SYSTEM_H
 
 #include <iostream>
 #include <exception>
@@ -28,6 +28,11 @@
 #include <regex>
 #include <vector>
 #include <string>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "fastcopy.h"
 
 /**
  * @brief Estrcutura que contiene el resultado del commando
@@ -44,16 +49,45 @@ struct CommandResult {
   };
 };
 
-std::vector<uint8_t> ReadFile(const int fd);
-std::vector<uint8_t> WriteFile(int fd, std::vector<uint8_t> buffer);
+/**
+ * @brief Estructura con una redirección de un comando (<, >, >>, N> o N>&M)
+ * [+] fd = descriptor que se redirige (0 para '<', 1 para '>' si no se indica otro)
+ * [+] path = archivo al que se redirige (vacío si es una duplicación N>&M)
+ * [+] flags = flags con las que se abre el archivo
+ * [+] dup_fd = descriptor que se duplica en las redirecciones N>&M
+ */
+struct Redirection {
+  int fd = 1;
+  std::string path;
+  int flags = 0;
+  int dup_fd = -1;
+};
+
+/**
+ * @brief Estructura que contiene un comando ya separado en argumentos
+ * [+] args = nombre del comando y sus argumentos
+ * [+] redirections = redirecciones, en el orden en el que se escribieron
+ * [+] is_background = si el comando terminaba en '&' y se debe ejecutar en segundo plano
+ */
+struct Command {
+  std::vector<std::string> args;
+  std::vector<Redirection> redirections;
+  bool is_background = false;
+};
+
+std::vector<std::string> Split(const std::string& input_string, std::vector<char> separators, std::vector<char> tokens);
 std::vector<std::string> SplitSpaces(const std::string& input_string);
+std::string JoinArgs(const std::vector<std::string>& args);
 void PrintPrompt(int last_command_status);
-std::string ReadLine(int fd);
-std::vector<std::vector<std::string>> ParseLine(const std::string& line);
+std::string FormatPrompt(int last_command_status);
+ssize_t ReadInput(int fd, std::string& pending_input);
+bool PopLine(std::string& pending_input, std::string& line);
+std::vector<Command> ParseLine(const std::string& line);
+Command ParseCommand(const std::string& command_line);
+std::vector<std::pair<int, int>> OpenRedirections(const std::vector<Redirection>& redirections);
+void CloseRedirections(const std::vector<Redirection>& redirections, const std::vector<std::pair<int, int>>& fds);
+std::vector<std::pair<int, int>> RedirectFds(const std::vector<Redirection>& redirections);
+void RestoreFds(const std::vector<std::pair<int, int>>& saved_fds);
 void PrintLine(const std::string& output_string);
 
-// COPY AND MOVE FUNCTIONS
-void CopyFile(const std::string& src_path, const std::string& dst_path, bool preserve_all);
-void MoveFile(const std::string& src_path, const std::string& dst_path);
-
 #endif
\ No newline at end of file
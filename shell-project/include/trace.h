@@ -0,0 +1,61 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: trace.h
+ * @brief: lifecycle tracing of the shell in Chrome trace-event format
+ * Referencias:
+ * Enlaces de interés
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Si se están registrando los tramos (SHELL_TRACE); se consulta antes de leer el reloj
+extern std::atomic<bool> tracing_enabled;
+
+void EnableTracing(const std::string& output_path);
+void DumpTrace();
+uint64_t TraceClock();
+void RecordSpan(const char* name, const std::string& detail, uint64_t start_ns, uint64_t end_ns);
+
+/**
+ * @brief Indica si se están registrando los tramos. Con el trazado desactivado es lo único que
+ *        cuesta un TraceSpan.
+ */
+inline bool IsTracing() {
+  return tracing_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Tramo de la vida de la shell (leer, dividir, expandir, crear un proceso...) que se
+ *        registra al salir del ámbito con el tiempo transcurrido desde que se construyó.
+ *        Si el trazado está desactivado no lee el reloj ni copia el detalle.
+ */
+class TraceSpan {
+ public:
+  explicit TraceSpan(const char* name) : name_(name), start_ns_(IsTracing() ? TraceClock() : 0) {}
+  TraceSpan(const char* name, const std::string& detail) : TraceSpan(name) {
+    if (start_ns_ != 0) detail_ = detail;
+  }
+  ~TraceSpan() {
+    if (start_ns_ != 0) RecordSpan(name_, detail_, start_ns_, TraceClock());
+  }
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t start_ns_;
+  std::string detail_;
+};
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: path_builtins.cc
+ * @brief: basename and dirname as loadable builtins
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <libgen.h>
+#include <unistd.h>
+#include <string>
+
+#include "builtin_plugin.h"
+
+namespace {
+
+/**
+ * @brief Aplica una función de libgen a cada argumento e imprime el resultado.
+ * @param argc El número de argumentos
+ * @param argv El vector de argumentos
+ * @param function basename o dirname
+ *
+ * @return 0 si se ha podido escribir, 1 si no hay argumentos o falla la escritura.
+ */
+int PrintPathPart(const int argc, const char* argv[], char* (*function)(char*)) {
+  if (argc < 2) return 1;
+  std::string output;
+  for (int i = 1; i < argc; ++i) {
+    std::string path = argv[i];
+    output += function(path.data());
+    output.push_back('\n');
+  }
+  return write(STDOUT_FILENO, output.data(), output.size()) < 0 ? 1 : 0;
+}
+
+int BasenameBuiltin(const int argc, const char* argv[]) {
+  return PrintPathPart(argc, argv, basename);
+}
+
+int DirnameBuiltin(const int argc, const char* argv[]) {
+  return PrintPathPart(argc, argv, dirname);
+}
+
+}  // namespace
+
+extern "C" const ShellBuiltinEntry shell_builtins[] = {
+  { "basename", BasenameBuiltin },
+  { "dirname", DirnameBuiltin },
+  { nullptr, nullptr },
+};
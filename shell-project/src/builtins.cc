@@ -0,0 +1,703 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: builtins.cc
+ * @brief: builtin commands dispatch table and in-process utilities
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <grp.h>
+#include <sys/sysmacros.h>
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <thread>
+
+#include "builtins.h"
+#include "output_writer.h"
+#include "scope_exit.h"
+#include "unique_handle.h"
+#include "parallel.h"
+#include "shell.h"
+
+namespace {
+
+constexpr std::array<Builtin, 17> kBuiltins = {{
+  { "cd", &Shell::CdCommand },
+  { "echo", &Shell::EchoCommand },
+  { "cp", &Shell::CpCommand },
+  { "mv", &Shell::MvCommand },
+  { "exit", &Shell::ExitCommand },
+  { "jobs", &Shell::JobsCommand },
+  { "fg", &Shell::FgCommand },
+  { "bg", &Shell::BgCommand },
+  { "wait", &Shell::WaitCommand },
+  { "enable", &Shell::EnableCommand },
+  { "cat", &Shell::CatCommand },
+  { "head", &Shell::HeadCommand },
+  { "stat", &Shell::StatCommand },
+  { "time", &Shell::TimeCommand },
+  { "history", &Shell::HistoryCommand },
+  { "parallel", &Shell::ParallelCommand },
+  { "cache", &Shell::CacheCommand },
+}};
+
+// Tamaño de la tabla hash (potencia de 2). Cada comando ocupa la posición hash & (tamaño - 1).
+constexpr size_t kBuiltinTableSize = 64;
+
+/**
+ * @brief Construye en tiempo de compilación la tabla hash de comandos internos
+ *
+ * @return Tabla con el índice en kBuiltins de cada posición (-1 si está vacía).
+ */
+constexpr std::array<int8_t, kBuiltinTableSize> MakeBuiltinTable() {
+  std::array<int8_t, kBuiltinTableSize> table{};
+  for (auto& slot : table) slot = -1;
+  for (size_t i = 0; i < kBuiltins.size(); ++i) {
+    table[HashBuiltinName(kBuiltins[i].name) & (kBuiltinTableSize - 1)] = static_cast<int8_t>(i);
+  }
+  return table;
+}
+
+constexpr std::array<int8_t, kBuiltinTableSize> kBuiltinTable = MakeBuiltinTable();
+
+/**
+ * @brief Comprueba que ningún par de comandos comparte posición en la tabla
+ *
+ * @return Verdadero si el hash es perfecto para los comandos de kBuiltins.
+ */
+constexpr bool IsPerfectBuiltinTable() {
+  for (size_t i = 0; i < kBuiltins.size(); ++i) {
+    if (kBuiltinTable[HashBuiltinName(kBuiltins[i].name) & (kBuiltinTableSize - 1)] != static_cast<int8_t>(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(IsPerfectBuiltinTable(), "Builtin names collide: increase kBuiltinTableSize");
+
+/**
+ * @brief Indica si un comando tiene alguna opción (argumento que empieza por '-', salvo "-").
+ * @param args Vector de strings con los argumentos
+ * @param first Primer argumento a comprobar.
+ */
+bool HasOptions(const std::vector<std::string>& args, size_t first = 1) {
+  for (size_t i = first; i < args.size(); ++i) {
+    if (args[i].size() > 1 && args[i][0] == '-') return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Abre un archivo de entrada de cat o head ("-" es la entrada estándar).
+ * @param path Ruta del archivo.
+ *
+ * @return Descriptor del archivo o -1 si no se puede abrir.
+ */
+int OpenInput(const std::string& path) {
+  if (path == "-") return STDIN_FILENO;
+  return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * @brief Indica si cat o head pueden leer sus entradas dentro de la shell: solo si la salida no
+ *        es un terminal y todas las entradas son archivos regulares, que se acaban. Un terminal,
+ *        una tubería o un dispositivo como /dev/zero pueden no acabar nunca, así que entonces se
+ *        ejecuta el programa externo, que sí recibe Ctrl-C.
+ * @param paths Archivos de entrada ("-" es la entrada estándar).
+ */
+bool HasFiniteInputs(const std::vector<std::string>& paths) {
+  if (isatty(STDOUT_FILENO)) return false;
+  for (const auto& path : paths) {
+    struct stat path_stat{};
+    int result = path == "-" ? fstat(STDIN_FILENO, &path_stat) : stat(path.c_str(), &path_stat);
+    // Si no existe, el error lo muestra la propia utilidad
+    if (result == 0 && !S_ISREG(path_stat.st_mode)) return false;
+  }
+  return true;
+}
+
+// Indicador que marca Ctrl-C mientras hay una InterruptGuard
+std::atomic<bool>* interrupt_flag = nullptr;
+
+/**
+ * @brief Manejador de SIGINT mientras se ejecuta una utilidad interna.
+ */
+void HandleInterrupt(int) {
+  if (interrupt_flag != nullptr) interrupt_flag->store(true);
+}
+
+/**
+ * @brief Mientras existe, Ctrl-C marca un indicador en lugar de ignorarse, para que cat y head
+ *        puedan pararse: la shell interactiva ignora SIGINT y las utilidades internas se
+ *        ejecutan en su propio proceso. Sin SA_RESTART, una llamada bloqueada vuelve con EINTR.
+ */
+class InterruptGuard {
+ public:
+  InterruptGuard(std::atomic<bool>& flag, bool is_enabled) : is_enabled_(is_enabled) {
+    if (!is_enabled_) return;
+    interrupt_flag = &flag;
+    struct sigaction action{};
+    action.sa_handler = HandleInterrupt;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &previous_action_);
+  }
+  ~InterruptGuard() {
+    if (!is_enabled_) return;
+    sigaction(SIGINT, &previous_action_, nullptr);
+    interrupt_flag = nullptr;
+  }
+  InterruptGuard(const InterruptGuard&) = delete;
+  InterruptGuard& operator=(const InterruptGuard&) = delete;
+
+ private:
+  bool is_enabled_;
+  struct sigaction previous_action_{};
+};
+
+// Valor de salida de una utilidad interna parada con Ctrl-C (como un programa que muere por SIGINT)
+constexpr int kInterruptedStatus = 128 + SIGINT;
+
+/**
+ * @brief Muestra en la salida de error un fallo de una utilidad interna.
+ * @param command Nombre del comando.
+ * @param path Archivo con el que ha fallado.
+ */
+void PrintUtilityError(const std::string& command, const std::string& path) {
+  int error = errno;
+  StandardOutput().Flush();
+  errno = error;
+  std::cerr << command << ": " << path << ": " << strerror(errno) << '\n';
+}
+
+/**
+ * @brief Convierte el modo de un archivo a la cadena de permisos de ls (-rw-r--r--).
+ * @param mode Modo del archivo.
+ */
+std::string ModeToString(mode_t mode) {
+  std::string permissions = "?rwxrwxrwx";
+  if (S_ISREG(mode)) permissions[0] = '-';
+  else if (S_ISDIR(mode)) permissions[0] = 'd';
+  else if (S_ISLNK(mode)) permissions[0] = 'l';
+  else if (S_ISCHR(mode)) permissions[0] = 'c';
+  else if (S_ISBLK(mode)) permissions[0] = 'b';
+  else if (S_ISFIFO(mode)) permissions[0] = 'p';
+  else if (S_ISSOCK(mode)) permissions[0] = 's';
+  for (int i = 0; i < 9; ++i) {
+    if (!(mode & (1 << (8 - i)))) permissions[i + 1] = '-';
+  }
+  return permissions;
+}
+
+/**
+ * @brief Describe el tipo de un archivo como lo hace stat.
+ * @param mode Modo del archivo.
+ */
+std::string FileType(mode_t mode) {
+  if (S_ISREG(mode)) return "regular file";
+  if (S_ISDIR(mode)) return "directory";
+  if (S_ISLNK(mode)) return "symbolic link";
+  if (S_ISCHR(mode)) return "character special file";
+  if (S_ISBLK(mode)) return "block special file";
+  if (S_ISFIFO(mode)) return "fifo";
+  if (S_ISSOCK(mode)) return "socket";
+  return "unknown";
+}
+
+/**
+ * @brief Da formato a una marca de tiempo como lo hace stat.
+ * @param time Marca de tiempo.
+ */
+std::string FormatTime(const struct timespec& time) {
+  struct tm local_time{};
+  localtime_r(&time.tv_sec, &local_time);
+  char date[64];
+  strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local_time);
+  char zone[16];
+  strftime(zone, sizeof(zone), "%z", &local_time);
+  std::stringstream output;
+  output << date << '.' << std::setw(9) << std::setfill('0') << time.tv_nsec << ' ' << zone;
+  return output.str();
+}
+
+/**
+ * @brief Da formato a un tiempo en microsegundos como lo hace el time de bash (0m0.000s).
+ * @param time_us Tiempo en microsegundos.
+ */
+std::string FormatDuration(double time_us) {
+  long minutes = static_cast<long>(time_us / 60e6);
+  std::stringstream output;
+  output << minutes << 'm' << std::fixed << std::setprecision(3) << (time_us - minutes * 60e6) / 1e6 << 's';
+  return output.str();
+}
+
+}  // namespace
+
+/**
+ * @brief Busca un comando interno en la tabla hash perfecta generada en compilación.
+ * @param name Nombre del comando.
+ *
+ * @return Puntero al comando o nullptr si no es un comando interno.
+ */
+const Builtin* FindBuiltin(std::string_view name) {
+  int8_t index = kBuiltinTable[HashBuiltinName(name) & (kBuiltinTableSize - 1)];
+  if (index < 0 || kBuiltins[index].name != name) return nullptr;
+  return &kBuiltins[index];
+}
+
+/**
+ * @brief Devuelve los nombres de los comandos internos compilados en la shell.
+ */
+std::vector<std::string> GetBuiltinNames() {
+  std::vector<std::string> names;
+  for (const auto& builtin : kBuiltins) names.emplace_back(builtin.name);
+  return names;
+}
+
+/**
+ * @brief Devuelve los comandos internos, tanto los compilados como los cargados con enable -f.
+ */
+std::vector<std::string> Shell::GetInternalCommands() const {
+  std::vector<std::string> names = GetBuiltinNames();
+  for (const auto& [name, function] : loaded_builtins_) names.push_back(name);
+  return names;
+}
+
+/**
+ * @brief Pide a la shell que termine.
+ * @param args Vector de strings con los argumentos (valor de salida opcional)
+ *
+ * @return El valor de salida indicado, o el del último comando.
+ */
+int Shell::ExitCommand(const std::vector<std::string>& args) {
+  if (args.size() > 2) throw std::runtime_error("ERROR: exit: Too many arguments!");
+  is_quit_requested_ = true;
+  if (args.size() == 2) return std::stoi(args[1]);
+  return last_command_status_;
+}
+
+/**
+ * @brief Muestra los comandos internos o carga nuevos desde un objeto compartido (enable -f ruta).
+ * @param args Vector de strings con los argumentos
+ * @throw std::runtime_error Si los argumentos no son válidos.
+ *
+ * @return Un entero indicando el éxito (0) o fallo (1) de la función.
+ */
+int Shell::EnableCommand(const std::vector<std::string>& args) {
+  if (args.size() == 1) {
+    std::stringstream output;
+    for (const auto& name : GetInternalCommands()) output << "enable " << name << '\n';
+    PrintLine(output.str());
+    return 0;
+  }
+  if (args.size() < 3 || args[1] != "-f") throw std::runtime_error("ERROR: enable: Usage: enable [-f file.so...]");
+  for (size_t i = 2; i < args.size(); ++i) LoadBuiltins(args[i]);
+  return 0;
+}
+
+/**
+ * @brief Carga los comandos internos exportados por un objeto compartido.
+ * @param path Ruta del objeto compartido.
+ * @throw std::runtime_error Si no se puede cargar o no exporta comandos.
+ */
+void Shell::LoadBuiltins(const std::string& path) {
+  void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) throw std::runtime_error(std::string("ERROR: enable: ") + dlerror());
+  auto* entries = static_cast<const ShellBuiltinEntry*>(dlsym(handle, SHELL_BUILTINS_SYMBOL));
+  if (entries == nullptr) {
+    dlclose(handle);
+    throw std::runtime_error("ERROR: enable: " + path + " does not export " SHELL_BUILTINS_SYMBOL);
+  }
+  for (; entries->name != nullptr; ++entries) {
+    loaded_builtins_[entries->name] = entries->function;
+  }
+  plugin_handles_.push_back(handle);
+}
+
+/**
+ * @brief Concatena archivos (o la entrada estándar) en la salida estándar sin crear procesos.
+ *        Los archivos regulares se copian con copy_file_range, splice o sendfile, y Ctrl-C para
+ *        la copia. Si se le pasan opciones, la salida es un terminal o alguna entrada no es un
+ *        archivo regular se ejecuta el programa externo.
+ * @param args Vector de strings con los argumentos
+ *
+ * @return Un entero indicando el éxito (0) o fallo (1) de la función.
+ */
+int Shell::CatCommand(const std::vector<std::string>& args) {
+  std::vector<std::string> paths(args.begin() + 1, args.end());
+  if (paths.empty()) paths.emplace_back("-");
+  if (HasOptions(args) || !HasFiniteInputs(paths)) return ExecuteProgram(args, true);
+  std::vector<char> buffer(128ul * 1024);
+  int return_value = 0;
+  CopyProgress progress;
+  InterruptGuard interrupt_guard(progress.is_cancelled, is_interactive_);
+  for (const auto& path : paths) {
+    if (progress.is_cancelled) return kInterruptedStatus;
+    int fd = OpenInput(path);
+    if (fd < 0) {
+      PrintUtilityError("cat", path);
+      return_value = 1;
+      continue;
+    }
+    // Si el archivo es regular (por ejemplo con cat archivo > otro) se copia dentro del kernel
+    bool is_copied = false;
+    try {
+      StandardOutput().Flush();
+      is_copied = KernelCopy(fd, STDOUT_FILENO, &progress);
+    } catch (const CopyCancelled&) {
+      if (fd != STDIN_FILENO) close(fd);
+      return kInterruptedStatus;
+    } catch (const std::system_error& error) {
+      errno = error.code().value();
+      PrintUtilityError("cat", path);
+      return_value = 1;
+      is_copied = true;
+    }
+    ssize_t bytes_read;
+    while (!is_copied && !progress.is_cancelled && (bytes_read = read(fd, buffer.data(), buffer.size())) != 0) {
+      if (bytes_read < 0 && errno == EINTR) continue;
+      if (bytes_read < 0) {
+        PrintUtilityError("cat", path);
+        return_value = 1;
+        break;
+      }
+      StandardOutput().Write(buffer.data(), bytes_read);
+    }
+    if (fd != STDIN_FILENO) close(fd);
+  }
+  return progress.is_cancelled ? kInterruptedStatus : return_value;
+}
+
+/**
+ * @brief Muestra las primeras líneas (10 por defecto, -n N o -N) de cada archivo sin crear procesos.
+ *        Si se le pasan otras opciones, la salida es un terminal o alguna entrada no es un archivo
+ *        regular se ejecuta el programa externo.
+ * @param args Vector de strings con los argumentos
+ *
+ * @return Un entero indicando el éxito (0) o fallo (1) de la función.
+ */
+int Shell::HeadCommand(const std::vector<std::string>& args) {
+  long lines = 10;
+  size_t first_path = 1;
+  if (args.size() > 2 && args[1] == "-n") {
+    first_path = 3;
+    lines = std::stol(args[2]);
+  } else if (args.size() > 1 && args[1].size() > 1 && args[1][0] == '-' &&
+             args[1].find_first_not_of("0123456789", 1) == std::string::npos) {
+    first_path = 2;
+    lines = std::stol(args[1].substr(1));
+  }
+  std::vector<std::string> paths(args.begin() + first_path, args.end());
+  if (paths.empty()) paths.emplace_back("-");
+  if (HasOptions(args, first_path) || lines < 0 || !HasFiniteInputs(paths)) return ExecuteProgram(args, true);
+  std::vector<char> buffer(64ul * 1024);
+  int return_value = 0;
+  std::atomic<bool> is_interrupted{false};
+  InterruptGuard interrupt_guard(is_interrupted, is_interactive_);
+  for (size_t i = 0; i < paths.size() && !is_interrupted; ++i) {
+    int fd = OpenInput(paths[i]);
+    if (fd < 0) {
+      PrintUtilityError("head", paths[i]);
+      return_value = 1;
+      continue;
+    }
+    if (paths.size() > 1) {
+      std::string header = (i > 0 ? "\n==> " : "==> ") + paths[i] + " <==\n";
+      StandardOutput().Write(header.data(), header.size());
+    }
+    long remaining = lines;
+    while (remaining > 0 && !is_interrupted) {
+      ssize_t bytes_read = read(fd, buffer.data(), buffer.size());
+      if (bytes_read < 0 && errno == EINTR) continue;
+      if (bytes_read < 0) {
+        PrintUtilityError("head", paths[i]);
+        return_value = 1;
+      }
+      if (bytes_read <= 0) break;
+      // Busca el salto de línea que completa las líneas pedidas dentro del bloque leído
+      const char* end = buffer.data();
+      const char* buffer_end = buffer.data() + bytes_read;
+      while (remaining > 0 && end < buffer_end) {
+        const char* new_line = static_cast<const char*>(memchr(end, '\n', buffer_end - end));
+        if (new_line == nullptr) {
+          end = buffer_end;
+          break;
+        }
+        end = new_line + 1;
+        --remaining;
+      }
+      StandardOutput().Write(buffer.data(), end - buffer.data());
+    }
+    if (fd != STDIN_FILENO) close(fd);
+  }
+  return is_interrupted ? kInterruptedStatus : return_value;
+}
+
+/**
+ * @brief Muestra la información de stat de cada archivo sin crear procesos.
+ *        Si se le pasan opciones se ejecuta el programa externo.
+ * @param args Vector de strings con los argumentos
+ *
+ * @return Un entero indicando el éxito (0) o fallo (1) de la función.
+ */
+int Shell::StatCommand(const std::vector<std::string>& args) {
+  if (HasOptions(args) || args.size() < 2) return ExecuteProgram(args, true);
+  int return_value = 0;
+  std::stringstream output;
+  for (size_t i = 1; i < args.size(); ++i) {
+    struct stat file_stat{};
+    if (lstat(args[i].c_str(), &file_stat) < 0) {
+      PrintUtilityError("stat", args[i]);
+      return_value = 1;
+      continue;
+    }
+    struct passwd* user = getpwuid(file_stat.st_uid);
+    struct group* group = getgrgid(file_stat.st_gid);
+    output << "  File: " << args[i] << '\n'
+           << "  Size: " << std::left << std::setw(16) << file_stat.st_size
+           << "Blocks: " << std::setw(11) << file_stat.st_blocks
+           << "IO Block: " << std::setw(7) << file_stat.st_blksize << FileType(file_stat.st_mode) << '\n'
+           << "Device: " << std::hex << file_stat.st_dev << "h/" << std::dec << file_stat.st_dev << "d\t"
+           << "Inode: " << std::setw(12) << file_stat.st_ino << "Links: " << file_stat.st_nlink << '\n'
+           << "Access: (" << std::oct << std::setw(4) << std::setfill('0') << std::right << (file_stat.st_mode & 07777)
+           << std::dec << std::setfill(' ') << '/' << ModeToString(file_stat.st_mode) << ")  "
+           << "Uid: (" << std::setw(5) << file_stat.st_uid << '/' << std::setw(8) << (user ? user->pw_name : "UNKNOWN") << ")   "
+           << "Gid: (" << std::setw(5) << file_stat.st_gid << '/' << std::setw(8) << (group ? group->gr_name : "UNKNOWN") << ")\n"
+           << "Access: " << FormatTime(file_stat.st_atim) << '\n'
+           << "Modify: " << FormatTime(file_stat.st_mtim) << '\n'
+           << "Change: " << FormatTime(file_stat.st_ctim) << '\n';
+    output << std::left;
+  }
+  PrintLine(output.str());
+  return return_value;
+}
+
+/**
+ * @brief Ejecuta un comando y muestra en la salida de error su tiempo real, de usuario y de sistema,
+ *        la memoria residente máxima y los cambios de contexto.
+ * @param args Vector de strings con los argumentos (el comando a medir)
+ *
+ * @return El valor de salida del comando medido.
+ */
+int Shell::TimeCommand(const std::vector<std::string>& args) {
+  CommandSample sample;
+  CommandResult result(0);
+  if (args.size() > 1) {
+    Command command{std::vector<std::string>(args.begin() + 1, args.end())};
+    sample = MeasureCommand(command, result);
+    is_quit_requested_ = result.is_quit_requested;
+  }
+  StandardOutput().Flush();
+  std::cerr << "\nreal\t" << FormatDuration(sample.wall_us)
+            << "\nuser\t" << FormatDuration(sample.user_us)
+            << "\nsys\t" << FormatDuration(sample.sys_us);
+  if (sample.spawn_us > 0) std::cerr << "\nspawn\t" << FormatDuration(sample.spawn_us);
+  std::cerr << "\nmaxrss\t" << sample.max_rss_kb << "KB"
+            << "\nctxsw\t" << sample.voluntary_switches << " voluntary, "
+            << sample.involuntary_switches << " involuntary\n";
+  return result.return_value;
+}
+
+/**
+ * @brief Muestra el historial de comandos o busca en él.
+ *        history [N]: los últimos N comandos (todos si no se indica).
+ *        history -p PREFIJO: comandos que empiezan por PREFIJO, del más reciente al más antiguo.
+ *        history -s TEXTO: comandos que contienen TEXTO, del más reciente al más antiguo.
+ *        history -w: escribe en el archivo los comandos pendientes.
+ * @param args Vector de strings con los argumentos
+ * @throw std::runtime_error Si los argumentos no son válidos.
+ *
+ * @return Un entero indicando el éxito (0) o fallo (1) de la función.
+ */
+int Shell::HistoryCommand(const std::vector<std::string>& args) {
+  const size_t kSearchLimit = 20;
+  std::stringstream output;
+  if (args.size() == 2 && args[1] == "-w") {
+    history_.Flush();
+    return 0;
+  }
+  if (args.size() >= 3 && (args[1] == "-p" || args[1] == "-s")) {
+    std::vector<std::string> query_args(args.begin() + 2, args.end());
+    std::string query = JoinArgs(query_args);
+    auto matches = args[1] == "-p" ? history_.SearchPrefix(query, kSearchLimit) : history_.SearchSubstring(query, kSearchLimit);
+    for (const auto& match : matches) output << match << '\n';
+    PrintLine(output.str());
+    return matches.empty() ? 1 : 0;
+  }
+  if (args.size() > 2 || (args.size() == 2 && args[1].find_first_not_of("0123456789") != std::string::npos)) {
+    throw std::runtime_error("ERROR: history: Usage: history [N] | -p prefix | -s text | -w");
+  }
+  history_.Refresh();
+  size_t count = args.size() == 2 ? std::stoul(args[1]) : history_.Size();
+  size_t first = history_.Size() - std::min(count, history_.Size());
+  for (size_t i = first; i < history_.Size(); ++i) {
+    output << std::setw(5) << std::right << i + 1 << "  " << history_.Get(i) << '\n';
+  }
+  PrintLine(output.str());
+  return 0;
+}
+
+/**
+ * @brief Ejecuta comandos independientes en paralelo, con como mucho N procesos a la vez
+ *        (por defecto, uno por CPU). La salida de cada comando se muestra en orden.
+ *        parallel [-j N] comando [args...] ::: valor...: ejecuta el comando con cada valor
+ *        (en el lugar de {} o al final de los argumentos).
+ *        parallel [-j N] comando [args...] < archivo: igual, con un valor por línea (como xargs -P).
+ *        parallel [-j N] < archivo: ejecuta cada línea del archivo como un comando.
+ * @param args Vector de strings con los argumentos
+ * @throw std::runtime_error Si los argumentos no son válidos.
+ *
+ * @return El número de comandos que han fallado (0 si todos han terminado bien).
+ */
+int Shell::ParallelCommand(const std::vector<std::string>& args) {
+  size_t max_jobs = std::thread::hardware_concurrency();
+  size_t first_arg = 1;
+  if (args.size() > 2 && args[1] == "-j") {
+    max_jobs = std::stoul(args[2]);
+    first_arg = 3;
+  } else if (args.size() > 1 && args[1].size() > 2 && args[1].rfind("-j", 0) == 0) {
+    max_jobs = std::stoul(args[1].substr(2));
+    first_arg = 2;
+  }
+  if (max_jobs == 0) throw std::runtime_error("ERROR: parallel: -j must be greater than 0");
+  auto separator = std::find(args.begin() + first_arg, args.end(), ":::");
+  std::vector<std::string> base(args.begin() + first_arg, separator);
+  std::vector<Command> commands;
+  if (base.empty()) {
+    if (separator != args.end()) throw std::runtime_error("ERROR: parallel: Usage: parallel [-j N] command [args...] [::: values...]");
+    for (const auto& line : ReadLines(STDIN_FILENO)) {
+      Command command = ParseCommand(line);
+      if (!command.args.empty()) commands.emplace_back(std::move(command));
+    }
+    return RunParallel(commands, max_jobs, original_mask_);
+  }
+  std::vector<std::string> values;
+  if (separator != args.end()) values.assign(separator + 1, args.end());
+  else values = ReadLines(STDIN_FILENO);
+  bool has_placeholder = std::any_of(base.begin(), base.end(), [](const std::string& arg) {
+    return arg.find("{}") != std::string::npos;
+  });
+  for (const auto& value : values) {
+    Command command{base};
+    for (auto& arg : command.args) {
+      for (size_t position = arg.find("{}"); position != std::string::npos; position = arg.find("{}", position + value.size())) {
+        arg.replace(position, 2, value);
+      }
+    }
+    if (!has_placeholder) command.args.push_back(value);
+    commands.emplace_back(std::move(command));
+  }
+  return RunParallel(commands, max_jobs, original_mask_);
+}
+
+/**
+ * @brief Ejecuta un comando determinista guardando su salida estándar y su valor de salida,
+ *        y las siguientes veces muestra lo guardado sin crear ningún proceso.
+ *        cache [--key-file ARCHIVO]... [--env VARIABLE]... -- comando [args...]
+ *        cache --stats: aciertos y fallos de esta sesión y tamaño del almacén.
+ *        cache --clear: borra el almacén.
+ * @param args Vector de strings con los argumentos
+ * @throw std::runtime_error Si los argumentos no son válidos.
+ *
+ * @return El valor de salida del comando (el guardado si estaba en el almacén).
+ */
+int Shell::CacheCommand(const std::vector<std::string>& args) {
+  if (cache_.GetDirectory().empty()) cache_.SetDirectory(DefaultCacheDirectory());
+  if (args.size() == 2 && args[1] == "--stats") {
+    std::error_code error;
+    size_t entries = 0;
+    size_t objects = 0;
+    uintmax_t object_bytes = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(cache_.GetDirectory() + "/keys", error)) {
+      if (entry.is_regular_file(error)) ++entries;
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(cache_.GetDirectory() + "/objects", error)) {
+      if (!entry.is_regular_file(error)) continue;
+      ++objects;
+      object_bytes += entry.file_size(error);
+    }
+    std::stringstream output;
+    output << "hits: " << cache_.GetHits() << '\n'
+           << "misses: " << cache_.GetMisses() << '\n'
+           << "bytes served: " << cache_.GetBytesServed() << '\n'
+           << "entries: " << entries << '\n'
+           << "objects: " << objects << " (" << object_bytes << " bytes)\n"
+           << "directory: " << cache_.GetDirectory() << '\n';
+    PrintLine(output.str());
+    return 0;
+  }
+  if (args.size() == 2 && args[1] == "--clear") {
+    cache_.Clear();
+    return 0;
+  }
+  std::vector<std::string> key_files;
+  std::vector<std::string> env_names;
+  size_t separator = 1;
+  for (; separator < args.size() && args[separator] != "--"; ++separator) {
+    if (args[separator] == "--key-file" && separator + 1 < args.size()) key_files.push_back(args[++separator]);
+    else if (args[separator] == "--env" && separator + 1 < args.size()) env_names.push_back(args[++separator]);
+    else break;
+  }
+  if (separator + 1 >= args.size() || args[separator] != "--") {
+    throw std::runtime_error("ERROR: cache: Usage: cache [--key-file file]... [--env name]... -- command [args...]");
+  }
+  Command command{std::vector<std::string>(args.begin() + separator + 1, args.end())};
+  std::string key = cache_.Key(command.args, env_names, key_files);
+  // Acierto: se copia el objeto guardado a la salida, sin fork ni exec
+  int return_value = 0;
+  UniqueFd object_fd(cache_.Lookup(key, return_value));
+  if (object_fd) {
+    struct stat object_stat{};
+    fstat(object_fd.Get(), &object_stat);
+    StandardOutput().Flush();
+    if (!KernelCopy(object_fd.Get(), STDOUT_FILENO)) {
+      std::vector<uint8_t> buffer(kCopyBufferSize);
+      ssize_t bytes_read;
+      while ((bytes_read = ReadFile(object_fd.Get(), buffer)) > 0) {
+        StandardOutput().Write(reinterpret_cast<const char*>(buffer.data()), bytes_read);
+      }
+    }
+    cache_.AddBytesServed(object_stat.st_size);
+    return return_value;
+  }
+  // Fallo: se ejecuta el comando con la salida en un archivo en memoria, que luego se muestra y se guarda
+  UniqueFd output(memfd_create("cache-stdout", MFD_CLOEXEC));
+  if (!output) throw std::system_error(errno, std::system_category());
+  const int output_fd = output.Get();
+  {
+    Redirection to_output;
+    to_output.fd = STDOUT_FILENO;
+    to_output.dup_fd = output_fd;
+    std::vector<std::pair<int, int>> saved_fds = RedirectFds({ to_output });
+    auto restore_fds = ScopeExit([&saved_fds] {
+      RestoreFds(saved_fds);
+    });
+    CommandResult result = DispatchCommand(command);
+    return_value = result.return_value;
+    is_quit_requested_ = is_quit_requested_ || result.is_quit_requested;
+  }
+  if (lseek(output_fd, 0, SEEK_SET) < 0) throw std::system_error(errno, std::system_category());
+  if (!KernelCopy(output_fd, STDOUT_FILENO)) {
+    std::vector<uint8_t> buffer(kCopyBufferSize);
+    ssize_t bytes_read;
+    while ((bytes_read = ReadFile(output_fd, buffer)) > 0) {
+      StandardOutput().Write(reinterpret_cast<const char*>(buffer.data()), bytes_read);
+    }
+  }
+  cache_.Store(key, return_value, output_fd);
+  return return_value;
+}
@@ -0,0 +1,216 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: command_cache.cc
+ * @brief: on-disk content-addressed cache of command output functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <sys/stat.h>
+#include <climits>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <pwd.h>
+
+#include "command_cache.h"
+#include "unique_handle.h"
+#include "shell_system.h"
+
+namespace {
+
+/**
+ * @brief Hash FNV-1a de 128 bits, suficiente para direccionar la salida de los comandos
+ *        por su contenido sin depender de una biblioteca criptográfica.
+ */
+class Hasher {
+ public:
+  void Update(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      state_ ^= bytes[i];
+      state_ *= kPrime;
+    }
+  }
+
+  // Las cadenas se separan con su '\0' para que ("ab", "c") y ("a", "bc") no coincidan
+  void Update(const std::string& text) { Update(text.c_str(), text.size() + 1); }
+
+  std::string ToHex() const {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string hex(32, '0');
+    unsigned __int128 value = state_;
+    for (size_t i = hex.size(); i-- > 0; value >>= 4) hex[i] = kDigits[value & 0xf];
+    return hex;
+  }
+
+ private:
+  static constexpr unsigned __int128 kPrime = (static_cast<unsigned __int128>(1) << 88) + 0x13b;
+  unsigned __int128 state_ = (static_cast<unsigned __int128>(0x6c62272e07bb0142) << 64) | 0x62b821756295c58d;
+};
+
+/**
+ * @brief Calcula el hash del contenido de un descriptor desde el principio.
+ * @param fd Descriptor de archivo.
+ * @throw std::system_error Si se produce un error al leer.
+ */
+std::string HashContents(int fd) {
+  if (lseek(fd, 0, SEEK_SET) < 0) throw std::system_error(errno, std::system_category());
+  Hasher hasher;
+  std::vector<uint8_t> buffer(kCopyBufferSize);
+  ssize_t bytes_read;
+  while ((bytes_read = ReadFile(fd, buffer)) > 0) hasher.Update(buffer.data(), bytes_read);
+  return hasher.ToHex();
+}
+
+}  // namespace
+
+/**
+ * @brief Calcula la clave de una ejecución: los argumentos, el directorio actual, el valor de
+ *        las variables de entorno elegidas y el contenido de los archivos de entrada.
+ *        El tamaño y la fecha de modificación de cada archivo solo se usan para no volver
+ *        a calcular el hash de su contenido si no ha cambiado.
+ * @param args Comando y argumentos.
+ * @param env_names Variables de entorno de las que depende el comando.
+ * @param key_files Archivos de entrada del comando.
+ * @throw std::system_error Si no se puede leer alguno de los archivos de entrada.
+ *
+ * @return Clave en hexadecimal.
+ */
+std::string CommandCache::Key(const std::vector<std::string>& args, const std::vector<std::string>& env_names,
+                              const std::vector<std::string>& key_files) {
+  Hasher hasher;
+  hasher.Update(std::string("cache-v1"));
+  char current_directory[PATH_MAX];
+  if (getcwd(current_directory, sizeof(current_directory)) != nullptr) hasher.Update(std::string(current_directory));
+  for (const auto& arg : args) hasher.Update(arg);
+  for (const auto& name : env_names) {
+    const char* value = getenv(name.c_str());
+    hasher.Update(name);
+    // Una variable sin definir no es lo mismo que una vacía
+    hasher.Update(value != nullptr ? std::string("=") + value : std::string("\1"));
+  }
+  for (const auto& path : key_files) {
+    struct stat file_stat{};
+    if (stat(path.c_str(), &file_stat) < 0) throw std::system_error(errno, std::system_category(), path);
+    hasher.Update(path);
+    hasher.Update(HashFile(path, file_stat));
+  }
+  return hasher.ToHex();
+}
+
+/**
+ * @brief Busca una clave en el almacén.
+ * @param key Clave calculada con Key.
+ * @param return_value Donde se guarda el valor de salida si la clave está.
+ *
+ * @return Descriptor del objeto con la salida guardada (el llamante lo cierra), o -1 si no está.
+ */
+int CommandCache::Lookup(const std::string& key, int& return_value) {
+  std::ifstream record(directory_ + "/keys/" + key);
+  int status;
+  std::string object;
+  if (record >> status >> object) {
+    int fd = open((directory_ + "/objects/" + object).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+      ++hits_;
+      return_value = status;
+      return fd;
+    }
+  }
+  ++misses_;
+  return -1;
+}
+
+/**
+ * @brief Guarda la salida y el valor de salida de una ejecución. El objeto solo se escribe
+ *        si no existe ya otro con el mismo contenido.
+ * @param key Clave calculada con Key.
+ * @param return_value Valor de salida del comando.
+ * @param output_fd Descriptor con la salida estándar del comando.
+ * @throw std::system_error Si no se puede escribir en el almacén.
+ */
+void CommandCache::Store(const std::string& key, int return_value, int output_fd) {
+  std::filesystem::create_directories(directory_ + "/objects");
+  std::filesystem::create_directories(directory_ + "/keys");
+  std::string object = HashContents(output_fd);
+  std::string object_path = directory_ + "/objects/" + object;
+  if (access(object_path.c_str(), F_OK) < 0) WriteAtomically(object_path, output_fd, "");
+  WriteAtomically(directory_ + "/keys/" + key, -1, std::to_string(return_value) + " " + object + "\n");
+}
+
+/**
+ * @brief Borra todo el almacén.
+ */
+void CommandCache::Clear() {
+  std::filesystem::remove_all(directory_);
+}
+
+/**
+ * @brief Calcula el hash del contenido de un archivo de entrada, reutilizando el de la
+ *        última vez si el inodo, el tamaño y la fecha de modificación no han cambiado.
+ * @param path Ruta del archivo.
+ * @param file_stat stat del archivo.
+ * @throw std::system_error Si no se puede leer el archivo.
+ */
+std::string CommandCache::HashFile(const std::string& path, const struct stat& file_stat) {
+  int64_t mtime_ns = file_stat.st_mtim.tv_sec * 1000000000ll + file_stat.st_mtim.tv_nsec;
+  auto memo = file_hashes_.find(path);
+  if (memo != file_hashes_.end() && memo->second.inode == file_stat.st_ino &&
+      memo->second.size == file_stat.st_size && memo->second.mtime_ns == mtime_ns) {
+    return memo->second.hash;
+  }
+  UniqueFd fd = OpenFile(path, O_RDONLY);
+  std::string hash = HashContents(fd.Get());
+  file_hashes_[path] = FileHash{ file_stat.st_ino, file_stat.st_size, mtime_ns, hash };
+  return hash;
+}
+
+/**
+ * @brief Escribe un archivo del almacén en un temporal y lo renombra, para que otra shell
+ *        que lea a la vez nunca vea un archivo a medias.
+ * @param path Ruta final.
+ * @param source_fd Descriptor a copiar desde el principio, o -1 para escribir data.
+ * @param data Contenido si no se copia de un descriptor.
+ * @throw std::system_error Si no se puede escribir.
+ */
+void CommandCache::WriteAtomically(const std::string& path, int source_fd, const std::string& data) {
+  std::string temporary_path = directory_ + "/tmp." + std::to_string(getpid()) + "." + std::to_string(temporary_files_++);
+  UniqueFd fd = OpenFile(temporary_path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+  try {
+    if (source_fd < 0) {
+      WriteFile(fd.Get(), reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    } else {
+      if (lseek(source_fd, 0, SEEK_SET) < 0) throw std::system_error(errno, std::system_category());
+      CopyContents(source_fd, fd.Get(), CopyEngine::kKernel);
+    }
+    fd.Reset();
+  } catch (...) {
+    unlink(temporary_path.c_str());
+    throw;
+  }
+  if (rename(temporary_path.c_str(), path.c_str()) < 0) {
+    int error = errno;
+    unlink(temporary_path.c_str());
+    throw std::system_error(error, std::system_category(), path);
+  }
+}
+
+/**
+ * @brief Directorio del almacén: $SHELL_CACHE_DIR, o shell-cache dentro de $XDG_CACHE_HOME
+ *        o de ~/.cache.
+ */
+std::string DefaultCacheDirectory() {
+  if (const char* cache_directory = getenv("SHELL_CACHE_DIR")) return cache_directory;
+  if (const char* xdg_cache = getenv("XDG_CACHE_HOME")) return std::string(xdg_cache) + "/shell-cache";
+  const char* home_directory = getenv("HOME");
+  if (home_directory == nullptr) home_directory = getpwuid(getuid())->pw_dir;
+  return std::string(home_directory) + "/.cache/shell-cache";
+}
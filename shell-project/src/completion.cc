@@ -0,0 +1,253 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: completion.cc
+ * @brief: cached directory and PATH index for tab completion functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+
+#include "completion.h"
+#include "expansion.h"
+#include "unique_handle.h"
+
+namespace {
+
+/**
+ * @brief Prefijo común de dos cadenas.
+ */
+std::string_view CommonPrefix(std::string_view first, std::string_view second) {
+  size_t length = 0;
+  size_t limit = std::min(first.size(), second.size());
+  while (length < limit && first[length] == second[length]) ++length;
+  return first.substr(0, length);
+}
+
+/**
+ * @brief Directorio de trabajo actual (vacío si no se puede obtener).
+ */
+std::string CurrentDirectory() {
+  char buffer[PATH_MAX];
+  return getcwd(buffer, sizeof(buffer)) == nullptr ? std::string() : std::string(buffer);
+}
+
+/**
+ * @brief Convierte la parte de directorio de una palabra (como "src/", "~/docs/" o "/usr/")
+ *        en la ruta absoluta del directorio, sin la barra final, que es la clave del índice.
+ * @param directory_part Parte de la palabra hasta la última barra incluida (vacía para el actual).
+ * @param current_directory Directorio de trabajo actual.
+ */
+std::string ResolveDirectory(std::string_view directory_part, const std::string& current_directory) {
+  std::string directory;
+  if (!directory_part.empty() && directory_part[0] == '/') {
+    directory = directory_part;
+  } else if (directory_part.substr(0, 2) == "~/") {
+    const char* home = getenv("HOME");
+    directory = std::string(home != nullptr ? home : "") + std::string(directory_part.substr(1));
+  } else {
+    directory = current_directory + "/" + std::string(directory_part);
+  }
+  while (directory.size() > 1 && directory.back() == '/') directory.pop_back();
+  return directory;
+}
+
+}  // namespace
+
+/**
+ * @brief Completa el nombre de un comando: comandos internos y ejecutables de los
+ *        directorios de PATH que empiezan por el prefijo, sin repetir.
+ * @param prefix Lo que se ha escrito del comando.
+ * @param builtins Nombres de los comandos internos.
+ *
+ * @return Los candidatos ordenados y su prefijo común.
+ */
+CompletionResult CompletionIndex::CompleteCommand(std::string_view prefix, const std::vector<std::string>& builtins) {
+  std::vector<std::string> names;
+  for (const auto& builtin : builtins) {
+    if (builtin.compare(0, prefix.size(), prefix) == 0) names.push_back(builtin);
+  }
+  const char* path = getenv("PATH");
+  std::string_view directories = path != nullptr ? path : "";
+  std::string current_directory = CurrentDirectory();
+  while (true) {
+    size_t colon = directories.find(':');
+    std::string_view directory_part = directories.substr(0, colon);
+    // Un componente vacío de PATH es el directorio actual
+    std::string directory = ResolveDirectory(directory_part.empty() ? "./" : directory_part, current_directory);
+    if (Listing* listing = GetListing(directory)) {
+      auto first = std::lower_bound(listing->entries.begin(), listing->entries.end(), prefix,
+                                    [&listing](const Entry& entry, std::string_view text) {
+        return std::string_view(listing->names.data() + entry.offset, entry.length) < text;
+      });
+      for (auto entry = first; entry != listing->entries.end(); ++entry) {
+        std::string_view name(listing->names.data() + entry->offset, entry->length);
+        if (name.compare(0, prefix.size(), prefix) != 0) break;
+        if (entry->type != DT_DIR && (Resolve(directory, *listing, *entry) & kExecutable)) names.emplace_back(name);
+      }
+    }
+    if (colon == std::string_view::npos) break;
+    directories.remove_prefix(colon + 1);
+  }
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+
+  CompletionResult result;
+  result.total = names.size();
+  if (names.empty()) return result;
+  result.common_prefix = CommonPrefix(names.front(), names.back());
+  if (names.size() > kMaxCompletions) names.resize(kMaxCompletions);
+  result.candidates = std::move(names);
+  return result;
+}
+
+/**
+ * @brief Completa una ruta: las entradas del directorio de la palabra que empiezan por su
+ *        último componente. Los ocultos solo salen si ese componente empieza por '.'.
+ * @param word Palabra a completar, relativa al directorio actual, absoluta o con "~/".
+ *
+ * @return Los candidatos ordenados (la palabra entera, con '/' al final si es un directorio),
+ *         su número total y su prefijo común.
+ */
+CompletionResult CompletionIndex::CompletePath(std::string_view word) {
+  CompletionResult result;
+  size_t slash = word.rfind('/');
+  std::string_view directory_part = slash == std::string_view::npos ? std::string_view() : word.substr(0, slash + 1);
+  std::string_view prefix = word.substr(directory_part.size());
+  std::string directory = ResolveDirectory(directory_part, CurrentDirectory());
+  Listing* listing = GetListing(directory);
+  if (listing == nullptr) return result;
+
+  bool show_hidden = !prefix.empty() && prefix[0] == '.';
+  std::string_view common;
+  auto first = std::lower_bound(listing->entries.begin(), listing->entries.end(), prefix,
+                                [&listing](const Entry& entry, std::string_view text) {
+    return std::string_view(listing->names.data() + entry.offset, entry.length) < text;
+  });
+  for (auto entry = first; entry != listing->entries.end(); ++entry) {
+    std::string_view name(listing->names.data() + entry->offset, entry->length);
+    if (name.compare(0, prefix.size(), prefix) != 0) break;
+    if (name[0] == '.' && !show_hidden) continue;
+    common = result.total == 0 ? name : CommonPrefix(common, name);
+    ++result.total;
+    // Solo se averigua si es un directorio (a veces con stat) para los candidatos que se guardan
+    if (result.candidates.size() >= kMaxCompletions) continue;
+    std::string candidate(directory_part);
+    candidate += name;
+    bool is_directory = entry->type == DT_DIR ||
+                        ((entry->type == DT_LNK || entry->type == DT_UNKNOWN) && (Resolve(directory, *listing, *entry) & kDirectory));
+    if (is_directory) candidate.push_back('/');
+    result.candidates.push_back(std::move(candidate));
+  }
+  if (result.total == 1) {
+    result.common_prefix = result.candidates.front();
+  } else {
+    result.common_prefix = std::string(directory_part) + std::string(common);
+  }
+  return result;
+}
+
+/**
+ * @brief Listado de un directorio: el que hay en el índice si el directorio no ha cambiado
+ *        desde que se leyó, o uno nuevo. Si hay más de kMaxCachedDirectories se descarta el
+ *        que lleva más tiempo sin usarse.
+ * @param directory Ruta absoluta del directorio, sin barra final.
+ *
+ * @return El listado, válido hasta la siguiente llamada, o nulo si el directorio no se puede leer.
+ */
+CompletionIndex::Listing* CompletionIndex::GetListing(const std::string& directory) {
+  struct stat directory_stat{};
+  if (stat(directory.c_str(), &directory_stat) < 0 || !S_ISDIR(directory_stat.st_mode)) return nullptr;
+  auto found = listings_.find(directory);
+  bool is_current = found != listings_.end() && !found->second.is_racy &&
+                    found->second.device == directory_stat.st_dev && found->second.inode == directory_stat.st_ino &&
+                    found->second.mtime.tv_sec == directory_stat.st_mtim.tv_sec &&
+                    found->second.mtime.tv_nsec == directory_stat.st_mtim.tv_nsec;
+  if (!is_current) {
+    Listing listing;
+    listing.device = directory_stat.st_dev;
+    listing.inode = directory_stat.st_ino;
+    listing.mtime = directory_stat.st_mtim;
+    // Si el directorio cambió en el último segundo, otro cambio con la misma fecha no se notaría
+    struct timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+    listing.is_racy = directory_stat.st_mtim.tv_sec >= now.tv_sec - 1;
+    ScanListing(directory, listing);
+    found = listings_.insert_or_assign(directory, std::move(listing)).first;
+  }
+  found->second.last_use = ++uses_;
+  if (listings_.size() > kMaxCachedDirectories) {
+    auto oldest = std::min_element(listings_.begin(), listings_.end(), [](const auto& first, const auto& second) {
+      return first.second.last_use < second.second.last_use;
+    });
+    listings_.erase(oldest);
+  }
+  return &found->second;
+}
+
+/**
+ * @brief Lee un directorio entero con getdents64 (miles de entradas por llamada), copia los
+ *        nombres a un único bloque de memoria y ordena las entradas por nombre.
+ * @param directory Ruta del directorio.
+ * @param listing Listado donde se guardan las entradas.
+ */
+void CompletionIndex::ScanListing(const std::string& directory, Listing& listing) {
+  UniqueDirFd fd(open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+  if (!fd) return;
+  ++scans_;
+  thread_local std::vector<char> buffer(kDirentBufferSize);
+  while (true) {
+    long bytes_read = syscall(SYS_getdents64, fd.Get(), buffer.data(), buffer.size());
+    if (bytes_read <= 0) break;
+    for (long position = 0; position < bytes_read;) {
+      const auto* entry = reinterpret_cast<const LinuxDirent64*>(buffer.data() + position);
+      position += entry->d_reclen;
+      std::string_view name(entry->d_name);
+      if (name == "." || name == "..") continue;
+      listing.entries.push_back(Entry{ static_cast<uint32_t>(listing.names.size()), static_cast<uint32_t>(name.size()),
+                                       entry->d_type, 0 });
+      listing.names += name;
+    }
+  }
+  std::sort(listing.entries.begin(), listing.entries.end(), [&listing](const Entry& first, const Entry& second) {
+    return std::string_view(listing.names.data() + first.offset, first.length) <
+           std::string_view(listing.names.data() + second.offset, second.length);
+  });
+}
+
+/**
+ * @brief Averigua con stat y access si una entrada es un directorio o un ejecutable (siguiendo
+ *        los enlaces simbólicos) y lo guarda en la entrada, para no repetirlo.
+ * @param directory Directorio del listado.
+ * @param listing Listado de la entrada.
+ * @param entry Entrada.
+ *
+ * @return Los indicadores kDirectory y kExecutable de la entrada.
+ */
+uint8_t CompletionIndex::Resolve(const std::string& directory, const Listing& listing, Entry& entry) const {
+  if (entry.flags & kResolved) return entry.flags;
+  entry.flags = kResolved;
+  std::string path = directory + "/" + std::string(listing.names.data() + entry.offset, entry.length);
+  struct stat path_stat{};
+  if (stat(path.c_str(), &path_stat) < 0) return entry.flags;
+  if (S_ISDIR(path_stat.st_mode)) {
+    entry.flags |= kDirectory;
+  } else if (S_ISREG(path_stat.st_mode) && access(path.c_str(), X_OK) == 0) {
+    entry.flags |= kExecutable;
+  }
+  return entry.flags;
+}
@@ -0,0 +1,151 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: event_loop.cc
+ * @brief: event_loop class functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+#include "event_loop.h"
+
+/**
+ * @brief Crea la instancia de epoll del bucle
+ * @throw std::system_error Si no se puede crear la instancia de epoll.
+ */
+EventLoop::EventLoop() {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) throw std::system_error(errno, std::system_category());
+}
+
+/**
+ * @brief Cierra los temporizadores pendientes y la instancia de epoll
+ */
+EventLoop::~EventLoop() {
+  for (const auto& [timer_fd, is_periodic] : timers_) close(timer_fd);
+  close(epoll_fd_);
+}
+
+/**
+ * @brief Vigila un descriptor y llama al callback cada vez que tenga datos para leer.
+ * @param fd Descriptor a vigilar.
+ * @param callback Función a llamar cuando el descriptor esté listo. Los archivos regulares, que
+ *                 epoll no admite (EPERM), se leen sin bloquearse, así que se consideran siempre
+ *                 listos y su callback se llama en cada vuelta del bucle.
+ * @throw std::system_error Si epoll no acepta el descriptor por otro motivo.
+ */
+void EventLoop::AddFd(int fd, const Callback& callback) {
+  struct epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+    if (errno != EPERM) throw std::system_error(errno, std::system_category());
+    always_ready_.insert(fd);
+  }
+  callbacks_[fd] = callback;
+}
+
+/**
+ * @brief Deja de vigilar un descriptor. No lo cierra.
+ * @param fd Descriptor a eliminar del bucle.
+ */
+void EventLoop::RemoveFd(int fd) {
+  if (always_ready_.erase(fd) == 0) epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  callbacks_.erase(fd);
+}
+
+/**
+ * @brief Programa un temporizador con timerfd.
+ * @param timeout Tiempo hasta que salta el temporizador (y periodo si es periódico).
+ * @param callback Función a llamar cuando venza el temporizador.
+ * @param is_periodic Si el temporizador se rearma automáticamente.
+ * @throw std::system_error Si no se puede crear el temporizador.
+ *
+ * @return Identificador del temporizador para CancelTimer.
+ */
+int EventLoop::AddTimer(std::chrono::milliseconds timeout, const Callback& callback, bool is_periodic) {
+  int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer_fd < 0) throw std::system_error(errno, std::system_category());
+  struct itimerspec spec{};
+  // Un it_value a cero desarma el temporizador, así que se fuerza al menos 1 ns
+  spec.it_value.tv_sec = timeout.count() / 1000;
+  spec.it_value.tv_nsec = (timeout.count() % 1000) * 1000000 + (timeout.count() == 0 ? 1 : 0);
+  if (is_periodic) spec.it_interval = spec.it_value;
+  if (timerfd_settime(timer_fd, 0, &spec, nullptr) < 0) {
+    int error = errno;
+    close(timer_fd);
+    throw std::system_error(error, std::system_category());
+  }
+  timers_[timer_fd] = is_periodic;
+  AddFd(timer_fd, [this, timer_fd, callback] {
+    uint64_t expirations;
+    if (read(timer_fd, &expirations, sizeof(expirations)) < 0) return;
+    auto timer = timers_.find(timer_fd);
+    if (timer == timers_.end()) return;
+    if (!timer->second) CancelTimer(timer_fd);
+    callback();
+  });
+  return timer_fd;
+}
+
+/**
+ * @brief Cancela un temporizador y libera su descriptor.
+ * @param timer_id Identificador devuelto por AddTimer.
+ */
+void EventLoop::CancelTimer(int timer_id) {
+  if (timers_.erase(timer_id) == 0) return;
+  RemoveFd(timer_id);
+  close(timer_id);
+}
+
+/**
+ * @brief Espera eventos y llama a sus callbacks. Si hay descriptores siempre listos no se
+ *        espera: se atienden los eventos que haya y después esos descriptores.
+ * @param timeout_ms Milisegundos máximos de espera (-1 para esperar indefinidamente).
+ * @throw std::system_error Si epoll_wait falla.
+ */
+void EventLoop::RunOnce(int timeout_ms) {
+  struct epoll_event events[16];
+  int ready = epoll_wait(epoll_fd_, events, 16, always_ready_.empty() ? timeout_ms : 0);
+  if (ready < 0) {
+    if (errno == EINTR) return;
+    throw std::system_error(errno, std::system_category());
+  }
+  for (int i = 0; i < ready; ++i) {
+    // Se copia el callback: puede eliminar su propio descriptor mientras se ejecuta
+    auto callback = callbacks_.find(events[i].data.fd);
+    if (callback == callbacks_.end()) continue;
+    Callback function = callback->second;
+    function();
+  }
+  // Se copian: un callback puede eliminar su propio descriptor
+  std::set<int> always_ready = always_ready_;
+  for (int fd : always_ready) {
+    auto callback = callbacks_.find(fd);
+    if (callback == callbacks_.end()) continue;
+    Callback function = callback->second;
+    function();
+  }
+}
+
+/**
+ * @brief Ejecuta el bucle hasta que se llame a Stop()
+ */
+void EventLoop::Run() {
+  is_running_ = true;
+  while (is_running_) RunOnce();
+}
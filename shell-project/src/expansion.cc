@@ -0,0 +1,462 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: expansion.cc
+ * @brief: variable and glob word expansion functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <thread>
+
+#include "expansion.h"
+#include "io_pool.h"
+#include "unique_handle.h"
+
+namespace {
+
+// Número máximo de hilos para recorrer varios directorios a la vez
+constexpr size_t kMaxScanThreads = 16;
+
+/**
+ * @brief Lee una clase de caracteres ([abc], [a-z], [!x] o [^x]) de un patrón.
+ * @param pattern Patrón de glob.
+ * @param start Posición del '['.
+ * @param characters Conjunto donde se marcan los caracteres de la clase.
+ *
+ * @return Posición del ']' que cierra la clase, o npos si no se cierra.
+ */
+size_t ParseClass(std::string_view pattern, size_t start, std::bitset<256>& characters) {
+  size_t i = start + 1;
+  bool is_negated = i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^');
+  if (is_negated) ++i;
+  // Un ']' justo al principio forma parte de la clase
+  if (i < pattern.size() && pattern[i] == ']') {
+    characters.set(']', true);
+    ++i;
+  }
+  while (i < pattern.size() && pattern[i] != ']') {
+    if (pattern[i] == '\\' && i + 1 < pattern.size()) ++i;
+    unsigned char first = pattern[i];
+    if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+      unsigned char last = pattern[i + 2];
+      for (unsigned symbol = first; symbol <= last; ++symbol) characters.set(symbol, true);
+      i += 3;
+    } else {
+      characters.set(first, true);
+      ++i;
+    }
+  }
+  if (i >= pattern.size()) return std::string_view::npos;
+  if (is_negated) characters.flip();
+  return i;
+}
+
+/**
+ * @brief Une un directorio y un nombre con '/'.
+ * @param directory Directorio (vacío para el directorio actual).
+ * @param name Nombre dentro del directorio.
+ */
+std::string JoinPath(const std::string& directory, std::string_view name) {
+  std::string path;
+  path.reserve(directory.size() + name.size() + 1);
+  path = directory;
+  if (!path.empty() && path.back() != '/') path.push_back('/');
+  path += name;
+  return path;
+}
+
+/**
+ * @brief Quita las barras invertidas de escape de un componente sin comodines, o de un glob
+ *        que no encaja con nada y se usa tal cual.
+ * @param component Componente de la ruta.
+ */
+std::string Unescape(std::string_view component) {
+  std::string result;
+  for (size_t i = 0; i < component.size(); ++i) {
+    if (component[i] == '\\' && i + 1 < component.size()) ++i;
+    result.push_back(component[i]);
+  }
+  return result;
+}
+
+/**
+ * @brief Recorre un directorio con getdents64 y guarda, ordenadas, las entradas que encajan con
+ *        el patrón. Los nombres se copian a un único bloque de memoria y se ordenan ahí antes de
+ *        construir las rutas. Para saber si una entrada es un directorio se usa d_type; solo se
+ *        hace stat con los enlaces simbólicos y los sistemas de archivos que no lo rellenan.
+ * @param directory Directorio a recorrer (vacío para el directorio actual).
+ * @param pattern Patrón compilado.
+ * @param only_directories Si solo interesan los directorios (niveles intermedios del patrón).
+ * @param matches Vector donde se añaden las rutas encontradas.
+ */
+void ScanDirectory(const std::string& directory, const GlobPattern& pattern, bool only_directories,
+                   std::vector<std::string>& matches) {
+  UniqueDirFd fd(open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+  // Si no existe o no es un directorio simplemente no hay coincidencias
+  if (!fd) return;
+  thread_local std::vector<char> buffer(kDirentBufferSize);
+  std::string names;
+  std::vector<std::pair<uint32_t, uint32_t>> found;
+  while (true) {
+    long bytes_read = syscall(SYS_getdents64, fd.Get(), buffer.data(), buffer.size());
+    if (bytes_read <= 0) break;
+    for (long position = 0; position < bytes_read;) {
+      const auto* entry = reinterpret_cast<const LinuxDirent64*>(buffer.data() + position);
+      position += entry->d_reclen;
+      std::string_view name(entry->d_name);
+      if (name == "." || name == "..") continue;
+      if (name[0] == '.' && !pattern.MatchesHidden()) continue;
+      if (!pattern.Match(name)) continue;
+      if (only_directories && entry->d_type != DT_DIR) {
+        struct stat path_stat{};
+        bool is_unknown = entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK;
+        if (!is_unknown || stat(JoinPath(directory, name).c_str(), &path_stat) < 0 || !S_ISDIR(path_stat.st_mode)) continue;
+      }
+      found.emplace_back(names.size(), name.size());
+      names += name;
+    }
+  }
+  auto name_at = [&names](const std::pair<uint32_t, uint32_t>& entry) {
+    return std::string_view(names.data() + entry.first, entry.second);
+  };
+  std::sort(found.begin(), found.end(), [&name_at](const auto& first, const auto& second) {
+    return name_at(first) < name_at(second);
+  });
+  matches.reserve(matches.size() + found.size());
+  for (const auto& entry : found) matches.emplace_back(JoinPath(directory, name_at(entry)));
+}
+
+/**
+ * @brief Hilos que recorren los directorios de los globs. Se crean con el primer glob que
+ *        recorre varios directorios y se reutilizan en los siguientes, así que cada uno reserva
+ *        su buffer de getdents64 una sola vez.
+ */
+IoPool& ScanPool() {
+  static IoPool pool(std::min(kMaxScanThreads, static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()))) - 1);
+  return pool;
+}
+
+/**
+ * @brief Busca las entradas que encajan con el patrón en varios directorios. Si hay más de uno
+ *        se reparten entre los hilos de ScanPool y el hilo actual; el resultado mantiene el
+ *        orden de los directorios.
+ * @param directories Directorios a recorrer.
+ * @param pattern Patrón compilado.
+ * @param only_directories Si solo interesan los directorios.
+ */
+std::vector<std::string> ScanDirectories(const std::vector<std::string>& directories, const GlobPattern& pattern,
+                                         bool only_directories) {
+  std::vector<std::vector<std::string>> results(directories.size());
+  size_t threads = std::min({ directories.size(), kMaxScanThreads,
+                              static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency())) });
+  if (threads <= 1) {
+    for (size_t i = 0; i < directories.size(); ++i) ScanDirectory(directories[i], pattern, only_directories, results[i]);
+  } else {
+    std::atomic<size_t> next_directory{0};
+    auto scan = [&] {
+      for (size_t i = next_directory++; i < directories.size(); i = next_directory++) {
+        ScanDirectory(directories[i], pattern, only_directories, results[i]);
+      }
+    };
+    std::vector<std::shared_future<int>> workers;
+    for (size_t i = 1; i < threads; ++i) {
+      workers.push_back(ScanPool().Submit([&scan] {
+        scan();
+        return 0;
+      }));
+    }
+    scan();
+    for (auto& worker : workers) worker.get();
+    ScanPool().ClearEvents();
+  }
+  size_t total = 0;
+  for (const auto& result : results) total += result.size();
+  std::vector<std::string> matches;
+  matches.reserve(total);
+  for (auto& result : results) {
+    std::move(result.begin(), result.end(), std::back_inserter(matches));
+  }
+  return matches;
+}
+
+/**
+ * @brief Expande una palabra: variables, división en palabras del resultado de las variables
+ *        y globs. Si un glob no encaja con nada la palabra se deja tal cual, sin los escapes.
+ * @param word Palabra a expandir.
+ * @param last_status Valor de salida del último comando ($?).
+ * @param words Vector donde se añaden las palabras resultantes.
+ */
+void ExpandWord(const std::string& word, int last_status, std::vector<std::string>& words) {
+  if (word.find_first_of("$~*?[") == std::string::npos) {
+    words.push_back(word);
+    return;
+  }
+  std::string value = ExpandVariables(word, last_status);
+  std::vector<std::string> fields;
+  if (word.find('$') == std::string::npos) {
+    fields.emplace_back(std::move(value));
+  } else {
+    // El resultado de las variables se divide por los espacios; si queda vacío la palabra desaparece
+    size_t start = value.find_first_not_of(" \t\n");
+    while (start != std::string::npos) {
+      size_t end = value.find_first_of(" \t\n", start);
+      fields.emplace_back(value.substr(start, end - start));
+      start = end == std::string::npos ? end : value.find_first_not_of(" \t\n", end);
+    }
+  }
+  for (auto& field : fields) {
+    if (HasGlobCharacters(field)) {
+      std::vector<std::string> matches = ExpandGlob(field);
+      if (!matches.empty()) {
+        std::move(matches.begin(), matches.end(), std::back_inserter(words));
+        continue;
+      }
+    }
+    words.emplace_back(HasGlobCharacters(field) ? Unescape(field) : std::move(field));
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Compila un patrón de glob.
+ * @param pattern Patrón (un único componente de una ruta, sin '/').
+ */
+GlobPattern::GlobPattern(std::string_view pattern) {
+  matches_hidden_ = !pattern.empty() && pattern[0] == '.';
+  auto add_literal = [this](char symbol) {
+    if (tokens_.empty() || tokens_.back().type != TokenType::kLiteral) {
+      tokens_.push_back({ TokenType::kLiteral, static_cast<uint32_t>(literals_.size()), 0 });
+    }
+    literals_.push_back(symbol);
+    ++tokens_.back().length;
+  };
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    char symbol = pattern[i];
+    if (symbol == '\\' && i + 1 < pattern.size()) {
+      add_literal(pattern[++i]);
+    } else if (symbol == '*') {
+      // Varios '*' seguidos equivalen a uno
+      if (tokens_.empty() || tokens_.back().type != TokenType::kStar) tokens_.push_back({ TokenType::kStar, 0, 0 });
+    } else if (symbol == '?') {
+      tokens_.push_back({ TokenType::kAnyChar, 0, 0 });
+    } else if (symbol == '[') {
+      std::bitset<256> characters;
+      size_t end = ParseClass(pattern, i, characters);
+      if (end == std::string_view::npos) {
+        add_literal(symbol);
+        continue;
+      }
+      tokens_.push_back({ TokenType::kClass, static_cast<uint32_t>(classes_.size()), 0 });
+      classes_.push_back(characters);
+      i = end;
+    } else {
+      add_literal(symbol);
+    }
+  }
+  size_t stars = 0;
+  for (const auto& token : tokens_) {
+    if (token.type == TokenType::kStar) ++stars;
+    else min_length_ += token.type == TokenType::kLiteral ? token.length : 1;
+  }
+  if (!tokens_.empty() && tokens_.front().type == TokenType::kLiteral) {
+    prefix_ = literals_.substr(tokens_.front().index, tokens_.front().length);
+  }
+  if (stars > 0 && tokens_.back().type == TokenType::kLiteral) {
+    suffix_ = literals_.substr(tokens_.back().index, tokens_.back().length);
+  }
+  // prefijo*sufijo: un solo '*' y como mucho un literal a cada lado
+  is_prefix_suffix_ = stars == 1 && tokens_.size() == 1 + !prefix_.empty() + !suffix_.empty();
+}
+
+/**
+ * @brief Comprueba si un nombre encaja con el patrón. Con '*' se vuelve atrás solo
+ *        hasta el último '*' visto, así que el coste es lineal en la práctica.
+ * @param name Nombre a comprobar.
+ */
+bool GlobPattern::Match(std::string_view name) const {
+  if (name.size() < min_length_) return false;
+  if (name.compare(0, prefix_.size(), prefix_) != 0) return false;
+  if (!suffix_.empty() && name.compare(name.size() - suffix_.size(), suffix_.size(), suffix_) != 0) return false;
+  if (is_prefix_suffix_) return true;
+  size_t token = 0;
+  size_t position = 0;
+  size_t star_token = std::string_view::npos;
+  size_t star_position = 0;
+  while (position < name.size() || token < tokens_.size()) {
+    if (token < tokens_.size()) {
+      const Token& current = tokens_[token];
+      switch (current.type) {
+        case TokenType::kStar:
+          star_token = ++token;
+          star_position = position;
+          continue;
+        case TokenType::kLiteral:
+          if (name.size() - position >= current.length &&
+              name.compare(position, current.length, literals_, current.index, current.length) == 0) {
+            position += current.length;
+            ++token;
+            continue;
+          }
+          break;
+        case TokenType::kAnyChar:
+          if (position < name.size()) {
+            ++position;
+            ++token;
+            continue;
+          }
+          break;
+        case TokenType::kClass:
+          if (position < name.size() && classes_[current.index][static_cast<unsigned char>(name[position])]) {
+            ++position;
+            ++token;
+            continue;
+          }
+          break;
+      }
+    }
+    // No encaja: el último '*' se traga un carácter más
+    if (star_token != std::string_view::npos && star_position < name.size()) {
+      token = star_token;
+      position = ++star_position;
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Indica si una palabra contiene comodines de glob.
+ * @param word Palabra a comprobar.
+ */
+bool HasGlobCharacters(std::string_view word) {
+  return word.find_first_of("*?[") != std::string_view::npos;
+}
+
+/**
+ * @brief Expande un patrón de glob con uno o varios niveles separados por '/'. Cada componente
+ *        con comodines se compila una vez, y los directorios de cada nivel se recorren en paralelo.
+ * @param pattern Patrón a expandir.
+ *
+ * @return Rutas que encajan con el patrón, ordenadas (vacío si no hay ninguna).
+ */
+std::vector<std::string> ExpandGlob(const std::string& pattern) {
+  std::vector<std::string> components;
+  for (size_t start = 0; start < pattern.size();) {
+    size_t end = pattern.find('/', start);
+    if (end == std::string::npos) end = pattern.size();
+    if (end > start) components.push_back(pattern.substr(start, end - start));
+    start = end + 1;
+  }
+  if (components.empty()) return {};
+  bool has_trailing_slash = pattern.back() == '/';
+  std::vector<std::string> paths{ pattern[0] == '/' ? "/" : "" };
+  for (size_t level = 0; level < components.size(); ++level) {
+    const std::string& component = components[level];
+    if (!HasGlobCharacters(component)) {
+      std::string name = Unescape(component);
+      for (auto& path : paths) path = JoinPath(path, name);
+      continue;
+    }
+    bool is_last = level + 1 == components.size();
+    paths = ScanDirectories(paths, GlobPattern(component), !is_last || has_trailing_slash);
+    if (paths.empty()) return paths;
+  }
+  // Si el último componente no tenía comodines hay que comprobar que existe
+  if (!HasGlobCharacters(components.back())) {
+    paths.erase(std::remove_if(paths.begin(), paths.end(), [](const std::string& path) {
+      struct stat path_stat{};
+      return lstat(path.c_str(), &path_stat) < 0;
+    }), paths.end());
+  }
+  if (has_trailing_slash) {
+    for (auto& path : paths) path.push_back('/');
+  }
+  // Cada directorio ya sale ordenado: solo hace falta ordenar si se han recorrido varios
+  if (!std::is_sorted(paths.begin(), paths.end())) std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+/**
+ * @brief Sustituye las variables de una palabra: $NOMBRE, ${NOMBRE}, $? (valor de salida del último
+ *        comando), $$ (pid de la shell) y ~ al principio (directorio personal). Las variables que
+ *        no existen se sustituyen por una cadena vacía.
+ * @param word Palabra a expandir.
+ * @param last_status Valor de salida del último comando.
+ */
+std::string ExpandVariables(const std::string& word, int last_status) {
+  std::string result;
+  size_t i = 0;
+  if (!word.empty() && word[0] == '~' && (word.size() == 1 || word[1] == '/')) {
+    const char* home = getenv("HOME");
+    result = home != nullptr ? home : "~";
+    i = 1;
+  }
+  while (i < word.size()) {
+    size_t dollar = word.find('$', i);
+    result.append(word, i, dollar == std::string::npos ? std::string::npos : dollar - i);
+    if (dollar == std::string::npos) break;
+    i = dollar + 1;
+    if (i < word.size() && word[i] == '?') {
+      result += std::to_string(last_status);
+      ++i;
+    } else if (i < word.size() && word[i] == '$') {
+      result += std::to_string(getpid());
+      ++i;
+    } else if (i < word.size() && word[i] == '{') {
+      size_t end = word.find('}', i);
+      if (end == std::string::npos) {
+        result += word.substr(dollar);
+        break;
+      }
+      const char* value = getenv(word.substr(i + 1, end - i - 1).c_str());
+      if (value != nullptr) result += value;
+      i = end + 1;
+    } else if (i < word.size() && (std::isalpha(static_cast<unsigned char>(word[i])) || word[i] == '_')) {
+      size_t end = i;
+      while (end < word.size() && (std::isalnum(static_cast<unsigned char>(word[end])) || word[end] == '_')) ++end;
+      const char* value = getenv(word.substr(i, end - i).c_str());
+      if (value != nullptr) result += value;
+      i = end;
+    } else {
+      result.push_back('$');
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Expande las palabras de un comando (y las rutas de sus redirecciones) antes de ejecutarlo.
+ *        En las redirecciones el glob solo se aplica si encaja con un único archivo.
+ * @param command Comando tal y como lo ha dividido ParseLine.
+ * @param last_status Valor de salida del último comando ($?).
+ */
+Command ExpandCommand(const Command& command, int last_status) {
+  Command expanded;
+  expanded.is_background = command.is_background;
+  expanded.args.reserve(command.args.size());
+  for (const auto& word : command.args) ExpandWord(word, last_status, expanded.args);
+  expanded.redirections = command.redirections;
+  for (auto& redirection : expanded.redirections) {
+    if (redirection.path.empty()) continue;
+    redirection.path = ExpandVariables(redirection.path, last_status);
+    if (!HasGlobCharacters(redirection.path)) continue;
+    std::vector<std::string> matches = ExpandGlob(redirection.path);
+    redirection.path = matches.size() == 1 ? std::move(matches.front()) : Unescape(redirection.path);
+  }
+  return expanded;
+}
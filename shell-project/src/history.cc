@@ -0,0 +1,323 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: history.cc
+ * @brief: persistent command history functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <pwd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include "history.h"
+
+namespace {
+
+// Número de comandos nuevos que se buscan linealmente antes de mezclarlos en el orden alfabético
+constexpr size_t kMaxUnsorted = 256;
+
+/**
+ * @brief Obtiene los trigramas distintos de una cadena, empaquetados en un entero.
+ * @param text Cadena de la que obtener los trigramas.
+ *
+ * @return Vector ordenado y sin repetidos de trigramas.
+ */
+std::vector<uint32_t> Trigrams(std::string_view text) {
+  std::vector<uint32_t> trigrams;
+  for (size_t i = 0; i + 3 <= text.size(); ++i) {
+    trigrams.push_back(static_cast<uint8_t>(text[i]) << 16 | static_cast<uint8_t>(text[i + 1]) << 8 |
+                       static_cast<uint8_t>(text[i + 2]));
+  }
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+  return trigrams;
+}
+
+/**
+ * @brief Indica si una cadena empieza por un prefijo.
+ */
+bool StartsWith(std::string_view text, std::string_view prefix) {
+  return text.substr(0, prefix.size()) == prefix;
+}
+
+}  // namespace
+
+/**
+ * @brief Devuelve la ruta del archivo de historial: $HISTFILE o ~/.shell_history.
+ */
+std::string DefaultHistoryPath() {
+  if (const char* history_file = getenv("HISTFILE")) return history_file;
+  const char* home_directory = getenv("HOME");
+  if (home_directory == nullptr) home_directory = getpwuid(getuid())->pw_dir;
+  return std::string(home_directory) + "/.shell_history";
+}
+
+/**
+ * @brief Escribe los comandos pendientes y cierra el descriptor.
+ */
+History::~History() {
+  if (index_thread_.joinable()) index_thread_.join();
+  try {
+    Flush();
+  } catch (...) {}
+  if (fd_ >= 0) close(fd_);
+}
+
+/**
+ * @brief Abre (o crea) el archivo de historial y lee su contenido.
+ * @param path Ruta del archivo.
+ * @throw std::system_error Si no se puede abrir o leer el archivo.
+ */
+void History::Open(const std::string& path) {
+  fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+  if (fd_ < 0) throw std::system_error(errno, std::system_category());
+  Refresh();
+  // El índice de lo que ya había en el archivo se construye sin bloquear la shell, sobre una copia
+  // de las entradas: el hilo principal puede seguir añadiendo comandos mientras tanto
+  if (entries_.empty()) return;
+  index_thread_ = std::thread([this, entries = entries_] {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    IndexEntries(entries);
+    UpdateTrigramIndex();
+  });
+}
+
+/**
+ * @brief Lee la parte nueva del archivo a un bloque propio y añade sus líneas al historial.
+ *        Se omiten las líneas que escribió esta misma shell, que ya están en memoria. Las
+ *        entradas apuntan al bloque, que no se mueve mientras exista el historial.
+ * @param end Tamaño actual del archivo.
+ * @throw std::system_error Si falla la lectura.
+ */
+void History::ReadRegion(off_t end) {
+  if (end <= read_size_) return;
+  std::string chunk(end - read_size_, '\0');
+  size_t length = 0;
+  while (length < chunk.size()) {
+    ssize_t bytes_read = pread(fd_, chunk.data() + length, chunk.size() - length, read_size_ + length);
+    if (bytes_read < 0 && errno == EINTR) continue;
+    if (bytes_read < 0) throw std::system_error(errno, std::system_category());
+    // Si el archivo ha encogido mientras tanto se usa lo que se haya podido leer
+    if (bytes_read == 0) break;
+    length += bytes_read;
+  }
+  // Una línea sin terminar aún no está completa: se leerá en la próxima actualización
+  size_t complete = std::string_view(chunk.data(), length).rfind('\n') + 1;
+  if (complete == 0) return;
+  chunk.resize(complete);
+  chunk.shrink_to_fit();
+  const std::string& data = chunks_.emplace_back(std::move(chunk));
+  size_t entries_before = entries_.size();
+  size_t own_range = 0;
+  for (size_t position = 0; position < data.size();) {
+    size_t line_end = data.find('\n', position);
+    off_t offset = read_size_ + position;
+    while (own_range < own_ranges_.size() && own_ranges_[own_range].second <= offset) ++own_range;
+    bool is_own = own_range < own_ranges_.size() && own_ranges_[own_range].first <= offset;
+    if (!is_own && line_end > position) entries_.emplace_back(data.data() + position, line_end - position);
+    position = line_end + 1;
+  }
+  // Si todo eran líneas de esta shell el bloque no hace falta
+  if (entries_.size() == entries_before) chunks_.pop_back();
+  read_size_ += complete;
+  own_ranges_.erase(own_ranges_.begin(), own_ranges_.begin() + own_range);
+}
+
+/**
+ * @brief Lee los comandos que otras shells hayan añadido al archivo desde la última vez. Si el
+ *        archivo ha encogido (se ha vaciado o rotado) se lee de nuevo desde el principio; lo que
+ *        ya estaba en memoria se conserva.
+ * @throw std::system_error Si no se puede consultar o leer el archivo.
+ */
+void History::Refresh() {
+  if (fd_ < 0) return;
+  struct stat file_stat{};
+  if (fstat(fd_, &file_stat) < 0) throw std::system_error(errno, std::system_category());
+  if (file_stat.st_size < read_size_) {
+    read_size_ = 0;
+    // Lo que esta shell escribió antes de vaciarse el archivo ya no está; lo de después está al principio
+    own_ranges_.erase(std::remove_if(own_ranges_.begin(), own_ranges_.end(),
+                                     [&file_stat](const auto& range) { return range.second > file_stat.st_size; }),
+                      own_ranges_.end());
+    std::sort(own_ranges_.begin(), own_ranges_.end());
+  }
+  ReadRegion(file_stat.st_size);
+}
+
+/**
+ * @brief Añade un comando al historial. Se escribe en el archivo cuando se completa un lote.
+ *        No se guarda si es igual que el comando anterior.
+ * @param line Línea de comando.
+ */
+void History::Add(const std::string& line) {
+  if (line.empty() || (!entries_.empty() && entries_.back() == line)) return;
+  own_entries_.push_back(line);
+  entries_.emplace_back(own_entries_.back());
+  pending_.push_back(line);
+  if (pending_.size() < kBatchSize) return;
+  // Si falla (disco lleno, error de E/S) el lote se queda pendiente y se reintenta en el siguiente
+  // Flush, que es el que informa del error
+  try {
+    Flush();
+  } catch (const std::system_error&) {}
+}
+
+/**
+ * @brief Escribe los comandos pendientes al final del archivo en una sola escritura,
+ *        con el archivo bloqueado para no mezclarse con otras shells.
+ * @throw std::system_error Si no se puede escribir el archivo.
+ */
+void History::Flush() {
+  if (fd_ < 0 || pending_.empty()) return;
+  std::string batch;
+  for (const auto& line : pending_) {
+    batch += line;
+    batch.push_back('\n');
+  }
+  flock(fd_, LOCK_EX);
+  const char* data = batch.data();
+  size_t remaining = batch.size();
+  while (remaining > 0) {
+    ssize_t bytes_written = write(fd_, data, remaining);
+    if (bytes_written < 0 && errno == EINTR) continue;
+    if (bytes_written < 0) {
+      int error = errno;
+      flock(fd_, LOCK_UN);
+      throw std::system_error(error, std::system_category());
+    }
+    data += bytes_written;
+    remaining -= bytes_written;
+  }
+  // Con O_APPEND la posición queda justo al final de lo que acabamos de escribir
+  off_t end = lseek(fd_, 0, SEEK_CUR);
+  flock(fd_, LOCK_UN);
+  own_ranges_.emplace_back(end - static_cast<off_t>(batch.size()), end);
+  pending_.clear();
+}
+
+/**
+ * @brief Añade al índice los comandos que aún no estén: los agrupa en comandos distintos con
+ *        su uso más reciente y los añade al orden alfabético. Se llama con index_mutex_ tomado.
+ * @param entries Entradas del historial (entries_ o una copia de su comienzo).
+ */
+void History::IndexEntries(const std::vector<std::string_view>& entries) {
+  if (unique_ids_.empty()) unique_ids_.reserve(entries.size());
+  for (; indexed_entries_ < entries.size(); ++indexed_entries_) {
+    std::string_view entry = entries[indexed_entries_];
+    auto [unique_id, is_new] = unique_ids_.try_emplace(entry, unique_entries_.size());
+    if (!is_new) {
+      last_use_[unique_id->second] = indexed_entries_;
+      continue;
+    }
+    unique_entries_.push_back(entry);
+    last_use_.push_back(indexed_entries_);
+    sorted_ids_.push_back(unique_id->second);
+  }
+  if (sorted_ids_.size() - sorted_unique_ <= kMaxUnsorted) return;
+  auto by_text = [this](uint32_t first, uint32_t second) { return unique_entries_[first] < unique_entries_[second]; };
+  std::sort(sorted_ids_.begin() + sorted_unique_, sorted_ids_.end(), by_text);
+  std::inplace_merge(sorted_ids_.begin(), sorted_ids_.begin() + sorted_unique_, sorted_ids_.end(), by_text);
+  sorted_unique_ = sorted_ids_.size();
+}
+
+/**
+ * @brief Añade al índice de trigramas los comandos distintos que aún no estén. Solo lo
+ *        necesitan las búsquedas de subcadenas, así que se construye aparte. Se llama con index_mutex_ tomado.
+ */
+void History::UpdateTrigramIndex() {
+  for (; trigram_unique_ < unique_entries_.size(); ++trigram_unique_) {
+    for (uint32_t trigram : Trigrams(unique_entries_[trigram_unique_])) {
+      trigrams_[trigram].push_back(trigram_unique_);
+    }
+  }
+}
+
+/**
+ * @brief Ordena los comandos candidatos del uso más reciente al más antiguo.
+ * @param unique_ids Identificadores de los comandos candidatos.
+ * @param limit Número máximo de resultados.
+ *
+ * @return Los comandos más recientes.
+ */
+std::vector<std::string_view> History::MostRecent(std::vector<uint32_t>& unique_ids, size_t limit) const {
+  size_t count = std::min(limit, unique_ids.size());
+  std::partial_sort(unique_ids.begin(), unique_ids.begin() + count, unique_ids.end(),
+                    [this](uint32_t first, uint32_t second) { return last_use_[first] > last_use_[second]; });
+  std::vector<std::string_view> result;
+  for (size_t i = 0; i < count; ++i) result.push_back(unique_entries_[unique_ids[i]]);
+  return result;
+}
+
+/**
+ * @brief Busca los comandos que empiezan por un prefijo.
+ * @param prefix Prefijo a buscar.
+ * @param limit Número máximo de resultados.
+ *
+ * @return Los comandos distintos que empiezan por el prefijo, del más reciente al más antiguo.
+ */
+std::vector<std::string_view> History::SearchPrefix(std::string_view prefix, size_t limit) {
+  Refresh();
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  IndexEntries(entries_);
+  std::vector<uint32_t> candidates;
+  auto sorted_end = sorted_ids_.begin() + sorted_unique_;
+  auto first = std::lower_bound(sorted_ids_.begin(), sorted_end, prefix,
+                                [this](uint32_t id, std::string_view text) { return unique_entries_[id] < text; });
+  for (auto id = first; id != sorted_end && StartsWith(unique_entries_[*id], prefix); ++id) candidates.push_back(*id);
+  for (auto id = sorted_end; id != sorted_ids_.end(); ++id) {
+    if (StartsWith(unique_entries_[*id], prefix)) candidates.push_back(*id);
+  }
+  return MostRecent(candidates, limit);
+}
+
+/**
+ * @brief Busca los comandos que contienen una subcadena (como Ctrl-R). Con tres o más caracteres
+ *        se intersectan las listas de los trigramas de la subcadena y solo se comprueban esos comandos.
+ * @param text Subcadena a buscar.
+ * @param limit Número máximo de resultados.
+ *
+ * @return Los comandos distintos que contienen la subcadena, del más reciente al más antiguo.
+ */
+std::vector<std::string_view> History::SearchSubstring(std::string_view text, size_t limit) {
+  Refresh();
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  IndexEntries(entries_);
+  std::vector<uint32_t> candidates;
+  if (text.size() < 3) {
+    for (uint32_t id = 0; id < unique_entries_.size(); ++id) candidates.push_back(id);
+  } else {
+    UpdateTrigramIndex();
+    std::vector<const std::vector<uint32_t>*> postings;
+    for (uint32_t trigram : Trigrams(text)) {
+      auto posting = trigrams_.find(trigram);
+      if (posting == trigrams_.end()) return {};
+      postings.push_back(&posting->second);
+    }
+    std::sort(postings.begin(), postings.end(), [](auto first, auto second) { return first->size() < second->size(); });
+    candidates = *postings[0];
+    for (size_t i = 1; i < postings.size() && !candidates.empty(); ++i) {
+      std::vector<uint32_t> intersection;
+      std::set_intersection(candidates.begin(), candidates.end(), postings[i]->begin(), postings[i]->end(),
+                            std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+  }
+  candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                  [this, text](uint32_t id) { return unique_entries_[id].find(text) == std::string_view::npos; }),
+                   candidates.end());
+  return MostRecent(candidates, limit);
+}
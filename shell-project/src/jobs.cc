@@ -0,0 +1,147 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: jobs.cc
+ * @brief: job table functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <sys/wait.h>
+#include <sstream>
+
+#include "jobs.h"
+#include "shell_system.h"
+
+/**
+ * @brief Añade un trabajo nuevo a la tabla. Su número es el mayor actual más uno.
+ * @param pid Pid del proceso del trabajo (0 si es un comando interno ejecutado en el pool de E/S).
+ * @param command Línea de comando con la que se lanzó.
+ *
+ * @return Referencia al trabajo añadido.
+ */
+Job& JobTable::Add(pid_t pid, const std::string& command) {
+  int id = jobs_.empty() ? 1 : jobs_.rbegin()->first + 1;
+  Job job{id, pid, command};
+  return jobs_[id] = job;
+}
+
+/**
+ * @brief Elimina un trabajo de la tabla
+ * @param id Número del trabajo.
+ */
+void JobTable::Remove(int id) {
+  jobs_.erase(id);
+}
+
+/**
+ * @brief Busca un trabajo a partir de su especificación (%n, n o vacía para el actual)
+ * @param job_spec Especificación del trabajo.
+ *
+ * @return Puntero al trabajo o nullptr si no existe.
+ */
+Job* JobTable::Find(const std::string& job_spec) {
+  if (job_spec.empty() || job_spec == "%+" || job_spec == "%%") return Current();
+  std::string number = job_spec[0] == '%' ? job_spec.substr(1) : job_spec;
+  if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos) return nullptr;
+  auto job = jobs_.find(std::stoi(number));
+  return job == jobs_.end() ? nullptr : &job->second;
+}
+
+/**
+ * @brief Busca un trabajo a partir del pid de su proceso
+ * @param pid Pid del proceso.
+ *
+ * @return Puntero al trabajo o nullptr si no existe.
+ */
+Job* JobTable::FindByPid(pid_t pid) {
+  if (pid <= 0) return nullptr;
+  for (auto& [id, job] : jobs_) {
+    if (job.pid == pid) return &job;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Devuelve el trabajo actual: el más reciente que no haya terminado.
+ *
+ * @return Puntero al trabajo o nullptr si no hay ninguno.
+ */
+Job* JobTable::Current() {
+  for (auto job = jobs_.rbegin(); job != jobs_.rend(); ++job) {
+    if (job->second.state != JobState::kDone) return &job->second;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Actualiza el estado del trabajo de un proceso con el estado devuelto por waitpid.
+ * @param pid Pid del proceso.
+ * @param status Estado devuelto por waitpid.
+ *
+ * @return Verdadero si el pid pertenece a algún trabajo de la tabla.
+ */
+bool JobTable::UpdateStatus(pid_t pid, int status) {
+  Job* job = FindByPid(pid);
+  if (job == nullptr) return false;
+  if (WIFSTOPPED(status)) {
+    job->state = JobState::kStopped;
+  } else if (WIFCONTINUED(status)) {
+    job->state = JobState::kRunning;
+  } else {
+    job->state = JobState::kDone;
+    job->status = StatusToReturnValue(status);
+  }
+  return true;
+}
+
+/**
+ * @brief Da formato a un trabajo tal y como lo muestra el comando jobs
+ * @param job Trabajo a mostrar.
+ *
+ * @return Cadena con el número, el estado y el comando del trabajo.
+ */
+std::string FormatJob(const Job& job) {
+  std::stringstream line;
+  line << "[" << job.id << "]  ";
+  switch (job.state) {
+    case JobState::kRunning:
+      line << "Running";
+      break;
+    case JobState::kStopped:
+      line << "Stopped";
+      break;
+    case JobState::kDone:
+      if (job.status == 0) line << "Done";
+      else line << "Exit " << job.status;
+      break;
+  }
+  line << "\t\t" << job.command;
+  if (job.copy.IsValid() && job.state != JobState::kDone && job.copy.GetTotalBytes() > 0) {
+    line << " (" << job.copy.GetBytesCopied() * 100 / job.copy.GetTotalBytes() << "%)";
+  }
+  // Con --bwlimit se muestra la velocidad conseguida, también al terminar
+  if (job.copy.IsValid() && job.copy.GetRequest().rate_limiter != nullptr) {
+    line << " [" << FormatRate(job.copy.GetRequest().rate_limiter->GetAchievedRate()) << "]";
+  }
+  return line.str();
+}
+
+/**
+ * @brief Convierte el estado devuelto por waitpid en un valor de retorno al estilo de la shell
+ * @param status Estado devuelto por waitpid.
+ *
+ * @return El código de salida, o 128 + la señal si el proceso acabó o se paró por una señal.
+ */
+int StatusToReturnValue(int status) {
+  if (WIFEXITED(status)) return WEXITSTATUS(status);
+  if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+  if (WIFSTOPPED(status)) return 128 + WSTOPSIG(status);
+  return 0;
+}
@@ -0,0 +1,366 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: line_editor.cc
+ * @brief: raw-mode line editor with history and tab completion functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <sys/ioctl.h>
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <vector>
+
+#include "line_editor.h"
+#include "output_writer.h"
+
+namespace {
+
+// Bytes como mucho de una secuencia de escape antes de darla por mala
+constexpr size_t kMaxEscapeLength = 16;
+
+/**
+ * @brief Número de caracteres (no de bytes) de un texto en UTF-8.
+ */
+size_t CountCharacters(std::string_view text) {
+  return std::count_if(text.begin(), text.end(), [](char symbol) {
+    return (static_cast<unsigned char>(symbol) & 0xC0) != 0x80;
+  });
+}
+
+/**
+ * @brief Indica si un byte es un carácter de control (las teclas de edición).
+ */
+bool IsControl(unsigned char symbol) {
+  return symbol < 0x20 || symbol == 0x7f;
+}
+
+}  // namespace
+
+/**
+ * @brief Devuelve el terminal a su modo normal si se estaba editando.
+ */
+LineEditor::~LineEditor() {
+  Stop();
+}
+
+/**
+ * @brief Empieza a leer una línea: muestra el prompt y pone el terminal en modo crudo (sin
+ *        eco, sin esperar al salto de línea y sin que Ctrl-C genere una señal).
+ * @param prompt Prompt de la línea; puede ocupar varias líneas.
+ * @throw std::system_error Si no se puede cambiar el modo del terminal.
+ */
+void LineEditor::Start(const std::string& prompt) {
+  prompt_ = prompt;
+  buffer_.clear();
+  cursor_ = 0;
+  history_index_ = history_ != nullptr ? history_->Size() : 0;
+  saved_line_.clear();
+  was_tab_ = false;
+  if (!is_editing_) {
+    // El modo normal se guarda una vez: si un programa deja el terminal mal, al volver se repara
+    if (!has_original_mode_) {
+      if (tcgetattr(fd_, &original_mode_) < 0) throw std::system_error(errno, std::system_category());
+      has_original_mode_ = true;
+    }
+    struct termios raw_mode = original_mode_;
+    raw_mode.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    raw_mode.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    raw_mode.c_cflag |= CS8;
+    raw_mode.c_cc[VMIN] = 1;
+    raw_mode.c_cc[VTIME] = 0;
+    if (tcsetattr(fd_, TCSADRAIN, &raw_mode) < 0) throw std::system_error(errno, std::system_category());
+    is_editing_ = true;
+  }
+  Redraw();
+}
+
+/**
+ * @brief Deja de editar y devuelve el terminal al modo normal, para ejecutar los comandos.
+ */
+void LineEditor::Stop() {
+  if (!is_editing_) return;
+  is_editing_ = false;
+  tcsetattr(fd_, TCSADRAIN, &original_mode_);
+}
+
+/**
+ * @brief Vuelve a mostrar el prompt entero y la línea, por ejemplo después de escribir los
+ *        candidatos de la completación o el aviso de un trabajo terminado.
+ */
+void LineEditor::Redraw() {
+  if (!is_editing_) return;
+  size_t last_line = prompt_.rfind('\n');
+  if (last_line != std::string::npos) Write(std::string_view(prompt_).substr(0, last_line + 1));
+  RefreshLine();
+}
+
+/**
+ * @brief Procesa las teclas recibidas hasta que se termina la línea o se acaba lo recibido.
+ *        Las secuencias de escape a medias se quedan en la entrada hasta que llegue el resto.
+ * @param pending_input Entrada recibida del terminal; se quita lo que se ha procesado.
+ * @param line Cadena donde se guarda la línea cuando se pulsa Intro.
+ *
+ * @return kLine si hay una línea completa, kEnd si se ha pulsado Ctrl-D con la línea vacía y
+ *         kEditing si hay que esperar más teclas.
+ */
+LineEditor::Status LineEditor::Feed(std::string& pending_input, std::string& line) {
+  Status status = Status::kEditing;
+  bool needs_refresh = false;
+  size_t position = 0;
+  while (is_editing_ && status == Status::kEditing && position < pending_input.size()) {
+    unsigned char key = pending_input[position];
+    bool is_tab = false;
+    size_t used = 1;
+    if (!IsControl(key)) {
+      // Lo que se pega llega de una vez: se inserta todo el texto seguido
+      size_t end = position;
+      while (end < pending_input.size() && !IsControl(pending_input[end])) ++end;
+      Insert(std::string_view(pending_input).substr(position, end - position));
+      used = end - position;
+    } else if (key == '\r' || key == '\n') {
+      cursor_ = buffer_.size();
+      RefreshLine();
+      Write("\n");
+      line = buffer_;
+      Stop();
+      status = Status::kLine;
+    } else if (key == 0x1b) {
+      used = HandleEscape(std::string_view(pending_input).substr(position));
+      if (used == 0) break;
+    } else if (key == 0x03) {  // Ctrl-C: se descarta la línea
+      Write("^C\n");
+      buffer_.clear();
+      cursor_ = 0;
+      history_index_ = history_ != nullptr ? history_->Size() : 0;
+      Redraw();
+    } else if (key == 0x04 && buffer_.empty()) {  // Ctrl-D
+      Write("\n");
+      Stop();
+      status = Status::kEnd;
+    } else if (key == 0x04) {
+      size_t start = cursor_;
+      MoveRight();
+      buffer_.erase(start, cursor_ - start);
+      cursor_ = start;
+    } else if (key == 0x08 || key == 0x7f) {
+      size_t end = cursor_;
+      MoveLeft();
+      buffer_.erase(cursor_, end - cursor_);
+    } else if (key == '\t') {
+      Complete(was_tab_);
+      is_tab = true;
+    } else if (key == 0x01) {
+      cursor_ = 0;
+    } else if (key == 0x05) {
+      cursor_ = buffer_.size();
+    } else if (key == 0x02) {
+      MoveLeft();
+    } else if (key == 0x06) {
+      MoveRight();
+    } else if (key == 0x0b) {
+      buffer_.erase(cursor_);
+    } else if (key == 0x15) {
+      buffer_.erase(0, cursor_);
+      cursor_ = 0;
+    } else if (key == 0x17) {  // Ctrl-W: borra la palabra anterior
+      size_t end = cursor_;
+      while (cursor_ > 0 && buffer_[cursor_ - 1] == ' ') --cursor_;
+      while (cursor_ > 0 && buffer_[cursor_ - 1] != ' ') --cursor_;
+      buffer_.erase(cursor_, end - cursor_);
+    } else if (key == 0x0c) {  // Ctrl-L: limpia la pantalla
+      Write("\x1b[H\x1b[2J");
+      Redraw();
+    } else if (key == 0x10) {
+      if (history_index_ > 0) ShowHistory(history_index_ - 1);
+    } else if (key == 0x0e) {
+      if (history_ != nullptr && history_index_ < history_->Size()) ShowHistory(history_index_ + 1);
+    }
+    was_tab_ = is_tab;
+    needs_refresh = status == Status::kEditing;
+    position += used;
+  }
+  pending_input.erase(0, position);
+  if (needs_refresh) RefreshLine();
+  return status;
+}
+
+/**
+ * @brief Atiende una secuencia de escape (flechas, Inicio, Fin y Supr, en las formas ESC [ y ESC O).
+ * @param sequence Entrada desde el ESC.
+ *
+ * @return Bytes de la secuencia, o 0 si todavía no ha llegado entera.
+ */
+size_t LineEditor::HandleEscape(std::string_view sequence) {
+  if (sequence.size() < 2) return 0;
+  // Alt+tecla u otra secuencia que no se usa: se ignora el ESC
+  if (sequence[1] != '[' && sequence[1] != 'O') return 1;
+  size_t end = 2;
+  while (end < sequence.size() && end < kMaxEscapeLength && (sequence[end] < 0x40 || sequence[end] > 0x7e)) ++end;
+  if (end == kMaxEscapeLength) return 1;
+  if (end == sequence.size()) return 0;
+  std::string_view parameters = sequence.substr(2, end - 2);
+  switch (sequence[end]) {
+    case 'A':
+      if (history_index_ > 0) ShowHistory(history_index_ - 1);
+      break;
+    case 'B':
+      if (history_ != nullptr && history_index_ < history_->Size()) ShowHistory(history_index_ + 1);
+      break;
+    case 'C':
+      MoveRight();
+      break;
+    case 'D':
+      MoveLeft();
+      break;
+    case 'H':
+      cursor_ = 0;
+      break;
+    case 'F':
+      cursor_ = buffer_.size();
+      break;
+    case '~':
+      if (parameters == "1" || parameters == "7") {
+        cursor_ = 0;
+      } else if (parameters == "4" || parameters == "8") {
+        cursor_ = buffer_.size();
+      } else if (parameters == "3") {
+        size_t start = cursor_;
+        MoveRight();
+        buffer_.erase(start, cursor_ - start);
+        cursor_ = start;
+      }
+      break;
+  }
+  return end + 1;
+}
+
+/**
+ * @brief Inserta texto en la posición del cursor y avanza el cursor.
+ */
+void LineEditor::Insert(std::string_view text) {
+  buffer_.insert(cursor_, text);
+  cursor_ += text.size();
+}
+
+/**
+ * @brief Mueve el cursor un carácter a la izquierda (saltando los bytes de continuación de UTF-8).
+ */
+void LineEditor::MoveLeft() {
+  if (cursor_ == 0) return;
+  --cursor_;
+  while (cursor_ > 0 && (static_cast<unsigned char>(buffer_[cursor_]) & 0xC0) == 0x80) --cursor_;
+}
+
+/**
+ * @brief Mueve el cursor un carácter a la derecha.
+ */
+void LineEditor::MoveRight() {
+  if (cursor_ == buffer_.size()) return;
+  ++cursor_;
+  while (cursor_ < buffer_.size() && (static_cast<unsigned char>(buffer_[cursor_]) & 0xC0) == 0x80) ++cursor_;
+}
+
+/**
+ * @brief Sustituye la línea por una entrada del historial. La posición Size() es la línea que
+ *        se estaba escribiendo antes de empezar a recorrer el historial.
+ * @param index Posición en el historial.
+ */
+void LineEditor::ShowHistory(size_t index) {
+  if (history_ == nullptr) return;
+  if (history_index_ == history_->Size()) saved_line_ = buffer_;
+  history_index_ = index;
+  buffer_ = index == history_->Size() ? saved_line_ : std::string(history_->Get(index));
+  cursor_ = buffer_.size();
+}
+
+/**
+ * @brief Completa la palabra que acaba en el cursor. Con un solo candidato se escribe entero
+ *        (con un espacio detrás, o '/' si es un directorio); con varios se escribe su prefijo
+ *        común y, si no añade nada, la segunda tabulación seguida muestra los candidatos.
+ * @param is_repeated Si la tecla anterior también era un tabulador.
+ */
+void LineEditor::Complete(bool is_repeated) {
+  if (!completer_) return;
+  size_t word_start = cursor_;
+  CompletionResult result = completer_(buffer_, cursor_, word_start);
+  size_t word_length = cursor_ - word_start;
+  if (result.total == 0) {
+    Write("\a");
+    return;
+  }
+  std::string replacement = result.common_prefix;
+  if (result.total == 1 && !replacement.empty() && replacement.back() != '/') replacement.push_back(' ');
+  if (replacement.size() > word_length) {
+    buffer_.replace(word_start, word_length, replacement);
+    cursor_ = word_start + replacement.size();
+  } else if (is_repeated) {
+    ListCandidates(result);
+  } else {
+    Write("\a");
+  }
+}
+
+/**
+ * @brief Escribe los candidatos en columnas debajo de la línea (solo el último componente de
+ *        las rutas) y vuelve a mostrar el prompt.
+ * @param result Candidatos.
+ */
+void LineEditor::ListCandidates(const CompletionResult& result) {
+  struct winsize window{};
+  size_t terminal_width = ioctl(fd_, TIOCGWINSZ, &window) == 0 && window.ws_col > 0 ? window.ws_col : 80;
+  std::vector<std::string_view> names;
+  size_t width = 0;
+  for (const auto& candidate : result.candidates) {
+    std::string_view name = candidate;
+    size_t slash = name.substr(0, name.size() - 1).rfind('/');
+    if (slash != std::string_view::npos) name.remove_prefix(slash + 1);
+    names.push_back(name);
+    width = std::max(width, CountCharacters(name));
+  }
+  size_t columns = std::max<size_t>(1, terminal_width / (width + 2));
+  std::string text = "\n";
+  for (size_t i = 0; i < names.size(); ++i) {
+    text += names[i];
+    if ((i + 1) % columns == 0 || i + 1 == names.size()) {
+      text += '\n';
+    } else {
+      text.append(width + 2 - CountCharacters(names[i]), ' ');
+    }
+  }
+  if (result.total > names.size()) text += "... " + std::to_string(result.total - names.size()) + " more\n";
+  Write(text);
+  Redraw();
+}
+
+/**
+ * @brief Vuelve a escribir la última línea del prompt y la línea, borra lo que quedara detrás y
+ *        coloca el cursor en su sitio.
+ */
+void LineEditor::RefreshLine() {
+  size_t last_line = prompt_.rfind('\n');
+  std::string text = "\r";
+  text += last_line == std::string::npos ? prompt_ : prompt_.substr(last_line + 1);
+  text += buffer_;
+  text += "\x1b[K";
+  size_t characters_after = CountCharacters(std::string_view(buffer_).substr(cursor_));
+  if (characters_after > 0) text += "\x1b[" + std::to_string(characters_after) + "D";
+  Write(text);
+}
+
+/**
+ * @brief Escribe en el terminal a través de la salida con buffer de la shell, para que no se
+ *        desordene con lo que ya hubiera en ella.
+ */
+void LineEditor::Write(std::string_view text) {
+  StandardOutput().Write(text);
+  StandardOutput().Flush();
+}
@@ -0,0 +1,120 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: output_writer.cc
+ * @brief: buffered output writer functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#include <system_error>
+
+#include "output_writer.h"
+#include "scope_exit.h"
+
+namespace {
+
+/**
+ * @brief Escribe todos los bloques con writev, reintentando las escrituras parciales.
+ * @param fd Descriptor de archivo.
+ * @param blocks Bloques a escribir (se modifican al avanzar).
+ * @param count Número de bloques.
+ * @throw std::system_error Si se produce un error al escribir.
+ */
+void WriteBlocks(int fd, struct iovec* blocks, int count) {
+  while (count > 0) {
+    ssize_t bytes_written = writev(fd, blocks, count);
+    if (bytes_written < 0 && errno == EINTR) continue;
+    if (bytes_written < 0) throw std::system_error(errno, std::system_category());
+    while (count > 0 && static_cast<size_t>(bytes_written) >= blocks->iov_len) {
+      bytes_written -= blocks->iov_len;
+      ++blocks;
+      --count;
+    }
+    if (count > 0) {
+      blocks->iov_base = static_cast<char*>(blocks->iov_base) + bytes_written;
+      blocks->iov_len -= bytes_written;
+    }
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Crea la salida sobre un descriptor. Se decide aquí si es un terminal.
+ * @param fd Descriptor de archivo.
+ */
+OutputWriter::OutputWriter(int fd) : fd_(fd), is_terminal_(isatty(fd)) {
+  buffer_.reserve(kBufferSize);
+}
+
+/**
+ * @brief Vuelca lo que quede en el buffer (los errores se ignoran al salir).
+ */
+OutputWriter::~OutputWriter() {
+  try {
+    Flush();
+  } catch (const std::exception&) { }
+}
+
+/**
+ * @brief Añade datos a la salida. Si no caben en el buffer se escriben junto con
+ *        lo acumulado en un solo writev, sin copiarlos.
+ * @param data Datos a escribir.
+ * @param size Número de bytes.
+ * @throw std::system_error Si se produce un error al escribir.
+ */
+void OutputWriter::Write(const char* data, size_t size) {
+  if (buffer_.size() + size <= kBufferSize) {
+    buffer_.append(data, size);
+    return;
+  }
+  struct iovec blocks[2] = {
+    { buffer_.data(), buffer_.size() },
+    { const_cast<char*>(data), size },
+  };
+  bool is_empty = buffer_.empty();
+  // El buffer se vacía aunque falle la escritura, para no repetir la salida en el siguiente intento
+  auto clear_buffer = ScopeExit([this] {
+    buffer_.clear();
+  });
+  WriteBlocks(fd_, is_empty ? blocks + 1 : blocks, is_empty ? 1 : 2);
+}
+
+/**
+ * @brief Escribe todo lo acumulado en el buffer.
+ * @throw std::system_error Si se produce un error al escribir.
+ */
+void OutputWriter::Flush() {
+  if (buffer_.empty()) return;
+  struct iovec block = { buffer_.data(), buffer_.size() };
+  auto clear_buffer = ScopeExit([this] {
+    buffer_.clear();
+  });
+  WriteBlocks(fd_, &block, 1);
+}
+
+/**
+ * @brief Marca el final de un comando: si la salida es un terminal se vuelca el buffer.
+ * @throw std::system_error Si se produce un error al escribir.
+ */
+void OutputWriter::EndCommand() {
+  if (is_terminal_) Flush();
+}
+
+/**
+ * @brief Salida estándar compartida por toda la shell.
+ */
+OutputWriter& StandardOutput() {
+  static OutputWriter output(STDOUT_FILENO);
+  return output;
+}
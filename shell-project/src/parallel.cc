@@ -0,0 +1,222 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: parallel.cc
+ * @brief: concurrency-limited execution of independent commands functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <system_error>
+
+#include "output_writer.h"
+#include "parallel.h"
+#include "scope_exit.h"
+#include "unique_handle.h"
+
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+
+namespace {
+
+/**
+ * @brief Estructura con el estado de un trabajo de parallel
+ * [+] pid = proceso hijo
+ * [+] pidfd = descriptor del proceso, que se puede leer cuando termina
+ * [+] output_fd = archivo en memoria con la salida estándar del hijo
+ * [+] error_fd = archivo en memoria con la salida de error del hijo
+ * [+] return_value = valor de salida del hijo
+ * [+] is_done = si el hijo ya ha terminado
+ */
+struct ParallelJob {
+  pid_t pid = -1;
+  int pidfd = -1;
+  int output_fd = -1;
+  int error_fd = -1;
+  int return_value = 0;
+  bool is_done = false;
+};
+
+/**
+ * @brief Cierra un descriptor si está abierto y lo marca como cerrado.
+ * @param fd Descriptor de archivo.
+ */
+void CloseFd(int& fd) {
+  if (fd >= 0) close(fd);
+  fd = -1;
+}
+
+/**
+ * @brief Lanza un comando con su salida y su salida de error en archivos en memoria (memfd),
+ *        para mostrarlas en orden cuando termine. La entrada estándar es /dev/null.
+ * @param job Trabajo donde se guardan el proceso y sus descriptores.
+ * @param command Comando a ejecutar.
+ * @param child_mask Máscara de señales que se restaura en el hijo.
+ * @throw std::system_error Si no se puede crear el proceso o sus descriptores.
+ */
+void SpawnJob(ParallelJob& job, const Command& command, const sigset_t& child_mask) {
+  // Todo lo que necesita el hijo se prepara antes del fork
+  std::vector<char*> argv;
+  for (const auto& arg : command.args) argv.push_back(const_cast<char*>(arg.c_str()));
+  argv.push_back(nullptr);
+  std::vector<std::pair<int, int>> redirection_fds = OpenRedirections(command.redirections);
+  auto close_redirections = ScopeExit([&command, &redirection_fds] {
+    CloseRedirections(command.redirections, redirection_fds);
+  });
+  job.output_fd = memfd_create("parallel-stdout", MFD_CLOEXEC);
+  job.error_fd = memfd_create("parallel-stderr", MFD_CLOEXEC);
+  UniqueFd null_fd(open("/dev/null", O_RDONLY | O_CLOEXEC));
+  if (job.output_fd < 0 || job.error_fd < 0 || !null_fd) throw std::system_error(errno, std::system_category());
+  pid_t pid = fork();
+  if (pid < 0) throw std::system_error(errno, std::system_category());
+  if (pid == 0) {
+    // Ctrl-C llega a los hijos porque siguen en el grupo de procesos de la shell;
+    // Ctrl-Z sigue ignorado para que la shell no se quede esperando a hijos parados
+    signal(SIGINT, SIG_DFL);
+    signal(SIGQUIT, SIG_DFL);
+    sigprocmask(SIG_SETMASK, &child_mask, nullptr);
+    if (dup2(null_fd.Get(), STDIN_FILENO) < 0 || dup2(job.output_fd, STDOUT_FILENO) < 0 ||
+        dup2(job.error_fd, STDERR_FILENO) < 0) {
+      _exit(EXIT_FAILURE);
+    }
+    for (const auto& [target_fd, source_fd] : redirection_fds) {
+      if (target_fd == source_fd) {
+        fcntl(target_fd, F_SETFD, 0);
+      } else if (dup2(source_fd, target_fd) < 0) {
+        _exit(EXIT_FAILURE);
+      }
+    }
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  job.pid = pid;
+  job.pidfd = syscall(SYS_pidfd_open, pid, 0);
+  if (job.pidfd < 0) {
+    int error = errno;
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    throw std::system_error(error, std::system_category());
+  }
+}
+
+/**
+ * @brief Recoge un trabajo terminado a través de su pidfd.
+ * @param job Trabajo cuyo pidfd se puede leer.
+ * @throw std::system_error Si falla waitid.
+ */
+void ReapJob(ParallelJob& job) {
+  siginfo_t info{};
+  while (waitid(static_cast<idtype_t>(P_PIDFD), job.pidfd, &info, WEXITED) < 0) {
+    if (errno != EINTR) throw std::system_error(errno, std::system_category());
+  }
+  job.return_value = info.si_code == CLD_EXITED ? info.si_status : 128 + info.si_status;
+  job.is_done = true;
+  CloseFd(job.pidfd);
+}
+
+/**
+ * @brief Copia la salida guardada en un archivo en memoria a un descriptor.
+ * @param fd Archivo en memoria.
+ * @param destination_fd Descriptor de destino.
+ */
+void CopyOutput(int fd, int destination_fd) {
+  if (lseek(fd, 0, SEEK_SET) < 0) throw std::system_error(errno, std::system_category());
+  if (KernelCopy(fd, destination_fd)) return;
+  std::vector<uint8_t> buffer(64 * 1024);
+  ssize_t bytes_read;
+  while ((bytes_read = ReadFile(fd, buffer)) > 0) WriteFile(destination_fd, buffer.data(), bytes_read);
+}
+
+}  // namespace
+
+/**
+ * @brief Ejecuta comandos independientes con, como mucho, max_jobs procesos a la vez.
+ *        Los hijos se esperan con poll sobre sus pidfd y se recogen con waitid(P_PIDFD),
+ *        y la salida de cada uno se muestra entera y en el orden de los comandos.
+ * @param commands Comandos a ejecutar.
+ * @param max_jobs Número máximo de procesos a la vez.
+ * @param child_mask Máscara de señales que se restaura en los hijos.
+ * @throw std::system_error Si no se puede lanzar o esperar un comando (se matan los que queden).
+ *
+ * @return Número de comandos que han fallado (como mucho kMaxParallelStatus).
+ */
+int RunParallel(const std::vector<Command>& commands, size_t max_jobs, const sigset_t& child_mask) {
+  std::vector<ParallelJob> jobs(commands.size());
+  std::vector<size_t> running;
+  // Si algo falla se matan y se recogen los hijos que sigan en marcha
+  auto cleanup = ScopeExit([&jobs, &running] {
+    for (size_t index : running) {
+      kill(jobs[index].pid, SIGTERM);
+      waitpid(jobs[index].pid, nullptr, 0);
+    }
+    for (auto& job : jobs) {
+      CloseFd(job.pidfd);
+      CloseFd(job.output_fd);
+      CloseFd(job.error_fd);
+    }
+  });
+  StandardOutput().Flush();
+  size_t next_to_start = 0;
+  size_t next_to_print = 0;
+  int failed_jobs = 0;
+  std::vector<struct pollfd> pidfds;
+  while (next_to_print < jobs.size()) {
+    while (running.size() < max_jobs && next_to_start < jobs.size()) {
+      SpawnJob(jobs[next_to_start], commands[next_to_start], child_mask);
+      running.push_back(next_to_start++);
+    }
+    pidfds.clear();
+    for (size_t index : running) pidfds.push_back({ jobs[index].pidfd, POLLIN, 0 });
+    if (poll(pidfds.data(), pidfds.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::system_category());
+    }
+    for (size_t i = pidfds.size(); i-- > 0;) {
+      if ((pidfds[i].revents & (POLLIN | POLLHUP)) == 0) continue;
+      ReapJob(jobs[running[i]]);
+      running.erase(running.begin() + i);
+    }
+    // Se muestra la salida de los trabajos ya terminados, sin adelantar a los anteriores
+    while (next_to_print < jobs.size() && jobs[next_to_print].is_done) {
+      ParallelJob& job = jobs[next_to_print++];
+      CopyOutput(job.output_fd, STDOUT_FILENO);
+      CopyOutput(job.error_fd, STDERR_FILENO);
+      CloseFd(job.output_fd);
+      CloseFd(job.error_fd);
+      if (job.return_value != 0) ++failed_jobs;
+    }
+  }
+  if (failed_jobs > 0) {
+    std::cerr << "parallel: " << failed_jobs << " of " << jobs.size() << " jobs failed\n";
+  }
+  return failed_jobs < kMaxParallelStatus ? failed_jobs : kMaxParallelStatus;
+}
+
+/**
+ * @brief Lee un descriptor hasta el final y lo divide en líneas (se descartan las vacías).
+ * @param fd Descriptor de archivo.
+ * @throw std::system_error Si se produce un error al leer.
+ */
+std::vector<std::string> ReadLines(int fd) {
+  std::string pending_input;
+  while (ReadInput(fd, pending_input) > 0) { }
+  if (!pending_input.empty() && pending_input.back() != '\n') pending_input.push_back('\n');
+  std::vector<std::string> lines;
+  std::string line;
+  while (PopLine(pending_input, line)) {
+    if (!line.empty()) lines.push_back(line);
+  }
+  return lines;
+}
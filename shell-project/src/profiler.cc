@@ -0,0 +1,177 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: profiler.cc
+ * @brief: command timing and resource usage profiler functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+
+#include "fastcopy.h"
+#include "profiler.h"
+#include "unique_handle.h"
+
+/**
+ * @brief Escapa una cadena para poder escribirla dentro de un JSON.
+ * @param text Cadena a escapar.
+ */
+std::string JsonEscape(const std::string& text) {
+  std::stringstream escaped;
+  for (char symbol : text) {
+    if (symbol == '"' || symbol == '\\') {
+      escaped << '\\' << symbol;
+    } else if (static_cast<unsigned char>(symbol) < 0x20) {
+      escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(symbol) << std::dec;
+    } else {
+      escaped << symbol;
+    }
+  }
+  return escaped.str();
+}
+
+/**
+ * @brief Convierte un timeval (como los de rusage) a microsegundos.
+ * @param time Tiempo a convertir.
+ */
+double TimevalToMicroseconds(const struct timeval& time) {
+  return time.tv_sec * 1e6 + time.tv_usec;
+}
+
+/**
+ * @brief Añade un valor al histograma.
+ * @param value_us Valor en microsegundos.
+ */
+void Histogram::Add(double value_us) {
+  size_t bucket = value_us <= 1 ? 0 : static_cast<size_t>(std::ceil(std::log2(value_us)));
+  if (bucket >= kBuckets) bucket = kBuckets - 1;
+  ++buckets_[bucket];
+  if (count_ == 0 || value_us < min_) min_ = value_us;
+  if (count_ == 0 || value_us > max_) max_ = value_us;
+  sum_ += value_us;
+  ++count_;
+}
+
+/**
+ * @brief Da formato JSON al histograma. Solo se incluyen las cubetas no vacías,
+ *        como pares [límite superior en us, número de valores].
+ */
+std::string Histogram::ToJson() const {
+  std::stringstream json;
+  json << std::fixed << std::setprecision(1);
+  json << "{\"count\": " << count_ << ", \"min\": " << min_ << ", \"max\": " << max_
+       << ", \"mean\": " << (count_ == 0 ? 0 : sum_ / count_) << ", \"buckets\": [";
+  bool is_first = true;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    if (buckets_[i] == 0) continue;
+    json << (is_first ? "" : ", ") << "[" << (1ull << i) << ", " << buckets_[i] << "]";
+    is_first = false;
+  }
+  json << "]}";
+  return json.str();
+}
+
+/**
+ * @brief Acumula las medidas de una ejecución de un comando.
+ * @param name Nombre del comando.
+ * @param sample Medidas de la ejecución.
+ */
+void Profiler::RecordCommand(const std::string& name, const CommandSample& sample) {
+  CommandStats& stats = commands_[name];
+  stats.wall_us.Add(sample.wall_us);
+  stats.user_us.Add(sample.user_us);
+  stats.sys_us.Add(sample.sys_us);
+  if (sample.spawn_us > 0) stats.spawn_us.Add(sample.spawn_us);
+  if (sample.max_rss_kb > stats.max_rss_kb) stats.max_rss_kb = sample.max_rss_kb;
+  stats.voluntary_switches += sample.voluntary_switches;
+  stats.involuntary_switches += sample.involuntary_switches;
+}
+
+/**
+ * @brief Acumula el tiempo que ha tardado ParseLine en dividir una línea.
+ * @param wall_us Tiempo en microsegundos.
+ */
+void Profiler::RecordParse(double wall_us) {
+  parse_us_.Add(wall_us);
+}
+
+/**
+ * @brief Da formato JSON a todas las medidas acumuladas.
+ */
+std::string Profiler::ToJson() const {
+  std::stringstream json;
+  json << "{\n  \"parse_us\": " << parse_us_.ToJson() << ",\n  \"commands\": {";
+  bool is_first = true;
+  for (const auto& [name, stats] : commands_) {
+    json << (is_first ? "\n" : ",\n") << "    \"" << JsonEscape(name) << "\": {\n"
+         << "      \"wall_us\": " << stats.wall_us.ToJson() << ",\n"
+         << "      \"user_us\": " << stats.user_us.ToJson() << ",\n"
+         << "      \"sys_us\": " << stats.sys_us.ToJson() << ",\n"
+         << "      \"spawn_us\": " << stats.spawn_us.ToJson() << ",\n"
+         << "      \"max_rss_kb\": " << stats.max_rss_kb << ",\n"
+         << "      \"voluntary_switches\": " << stats.voluntary_switches << ",\n"
+         << "      \"involuntary_switches\": " << stats.involuntary_switches << "\n    }";
+    is_first = false;
+  }
+  json << "\n  }\n}\n";
+  return json.str();
+}
+
+/**
+ * @brief Escribe el JSON de las medidas en el archivo de salida ("-" para la salida de error).
+ * @throw std::system_error Si no se puede escribir el archivo.
+ */
+void Profiler::Dump() const {
+  if (!is_enabled_) return;
+  std::string json = ToJson();
+  UniqueFd file;
+  if (output_path_ != "-") file = OpenFile(output_path_, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  WriteFile(file ? file.Get() : STDERR_FILENO, reinterpret_cast<const uint8_t*>(json.data()), json.size());
+}
+
+/**
+ * @brief Empieza a cronometrar: guarda el reloj monotónico y el rusage del hilo actual.
+ */
+CommandTimer::CommandTimer() : start_(std::chrono::steady_clock::now()) {
+  getrusage(RUSAGE_THREAD, &start_usage_);
+}
+
+/**
+ * @brief Para el cronómetro y calcula las medidas del comando.
+ * @param child_usage rusage del proceso hijo devuelto por wait4, si el comando era externo.
+ *
+ * @return Medidas del comando: lo que ha consumido el hilo de la shell más lo del hijo.
+ */
+CommandSample CommandTimer::Stop(const struct rusage* child_usage) const {
+  CommandSample sample;
+  std::chrono::duration<double, std::micro> wall = std::chrono::steady_clock::now() - start_;
+  struct rusage usage{};
+  getrusage(RUSAGE_THREAD, &usage);
+  sample.wall_us = wall.count();
+  sample.user_us = TimevalToMicroseconds(usage.ru_utime) - TimevalToMicroseconds(start_usage_.ru_utime);
+  sample.sys_us = TimevalToMicroseconds(usage.ru_stime) - TimevalToMicroseconds(start_usage_.ru_stime);
+  sample.voluntary_switches = usage.ru_nvcsw - start_usage_.ru_nvcsw;
+  sample.involuntary_switches = usage.ru_nivcsw - start_usage_.ru_nivcsw;
+  sample.max_rss_kb = usage.ru_maxrss;
+  if (child_usage != nullptr) {
+    sample.user_us += TimevalToMicroseconds(child_usage->ru_utime);
+    sample.sys_us += TimevalToMicroseconds(child_usage->ru_stime);
+    sample.voluntary_switches += child_usage->ru_nvcsw;
+    sample.involuntary_switches += child_usage->ru_nivcsw;
+    sample.max_rss_kb = child_usage->ru_maxrss;
+  }
+  return sample;
+}
@@ -13,22 +13,64 @@
  * Enlaces de interés
  */
 
+#include <dlfcn.h>
+#include <sys/signalfd.h>
 #include <sys/wait.h>
 
+#include "builtins.h"
+#include "expansion.h"
+#include "output_writer.h"
+#include "scope_exit.h"
 #include "shell.h"
+#include "trace.h"
 #include "usages.h"
 
+namespace {
+
 /**
- * @brief Imprime los argumentos a la salida estándar
+ * @brief Separa las opciones de cp y mv de las rutas y las guarda en una petición de copia.
+ * @param args Comando y argumentos.
+ * @param request Petición donde se guardan las opciones: -a, -m, --bwlimit=RATE e
+ *                --ionice=idle|best-effort:N.
+ * @throw std::invalid_argument Si la velocidad o la prioridad no son válidas.
+ *
+ * @return Las rutas, en el orden en el que se han dado.
+ */
+std::vector<std::string> ParseCopyOptions(const std::vector<std::string>& args, CopyRequest& request) {
+  std::vector<std::string> paths;
+  for (size_t i = 1; i < args.size(); ++i) {
+    const auto& parameter = args[i];
+    if (parameter == "-a") {
+      request.preserve_all = true;
+    } else if (parameter == "-m") {
+      request.operation = CopyOperation::kMove;
+    } else if (parameter.rfind("--bwlimit=", 0) == 0) {
+      request.rate_limiter = std::make_shared<RateLimiter>(ParseRate(parameter.substr(10)));
+    } else if (parameter.rfind("--ionice=", 0) == 0) {
+      request.io_priority = ParseIoPriority(parameter.substr(9));
+    } else {
+      paths.push_back(parameter);
+    }
+  }
+  return paths;
+}
+
+}  // namespace
+
+/**
+ * @brief Imprime los argumentos separados por espacios y un salto de línea en la salida estándar
  * @param args Vector containing the command and its arguments.
  * 
  * @return Un entero indicando el éxito (0) o fallo (1) de la función.
  */
 int Shell::EchoCommand(const std::vector<std::string>& args) {
   try {
+    OutputWriter& output = StandardOutput();
     for (int i = 1; i < args.size(); ++i) {
-      std::cout << args[i] << " ";
+      if (i > 1) output.Write(" ", 1);
+      output.Write(args[i]);
     }
+    output.Write("\n", 1);
   } catch (const std::system_error& error) {
     std::throw_with_nested(std::runtime_error("ERROR: echo command failed!"));
   }
@@ -66,7 +108,7 @@ int Shell::CdCommand(const std::vector<std::string>& args) {
 }
 
 /**
- * @brief Copia o mueve un archivo de una ubicacion a otra
+ * @brief Copia un archivo de una ubicación a otra (con -m lo mueve).
  * @param args Vector de strings con los argumentos
  * @throw std::system_error Si la funcion falla da un system error.
  * 
@@ -74,34 +116,17 @@ int Shell::CdCommand(const std::vector<std::string>& args) {
  */
 int Shell::CpCommand(const std::vector<std::string>& args) {
   try {
-    // Comprueba si existe los argumentos -a y -m del copyfile
-    bool copy_attributes = false;
-    bool move_file = false;
-    for (const auto& parameter : args) {
-      if (parameter == "-m") {
-        move_file = true;
-        break;
-      }
-      if (parameter == "-a") {
-        copy_attributes = true;
-        break;
-      } 
-    }
-    // Calcula los shift necesarioa para evitar los parametros si es necesario
-    int shift = 0;
-    if (args.size() == 4) shift += 1;
-    // Determina si se debe preservar todos los atributos
-    bool preserve_all = false;
-    if (copy_attributes || move_file) preserve_all = true;
+    CopyRequest request;
+    std::vector<std::string> paths = ParseCopyOptions(args, request);
+    // Al mover siempre se preservan todos los atributos
+    if (request.operation == CopyOperation::kMove) request.preserve_all = true;
+    if (paths.size() < 2) throw std::runtime_error("ERROR: cp: Missing file operand!");
     // Obtenemos los caminos del origen y destino
-    std::string src_path = args[1 + shift];
-    std::string dst_path = args[2 + shift];
-    // Llama a la función correspondiente para aplicarselo al archivo
-    if (!move_file) {
-      CopyFile(src_path, dst_path, preserve_all);
-    } else {
-      MvCommand(args);
-    }
+    request.source_path = paths[0];
+    request.destination_path = paths[1];
+    // Con '&' la copia se hace en el CopyService y se sigue como un trabajo más
+    if (is_background_) return StartBackgroundCopy(args, request);
+    CopyInForeground(request);
   } catch (const std::system_error& error) {
     std::throw_with_nested(std::runtime_error("ERROR: cp command failed!"));
     return 1;
@@ -118,14 +143,17 @@ int Shell::CpCommand(const std::vector<std::string>& args) {
  */
 int Shell::MvCommand(const std::vector<std::string>& args) {
   try {
-    // Calcula los shift necesarioa para evitar los parametros si es necesario
-    int shift = 0;
-    if (args.size() == 4) shift += 1;
+    CopyRequest request;
+    std::vector<std::string> paths = ParseCopyOptions(args, request);
+    request.operation = CopyOperation::kMove;
+    request.preserve_all = true;
+    if (paths.size() < 2) throw std::runtime_error("ERROR: mv: Missing file operand!");
     // Obtenemos los caminos del origen y destino
-    std::string src_path = args[1 + shift];
-    std::string dst_path = args[2 + shift];
-    // Llama a la función MoveFile para aplicarselo al archivo
-    MoveFile(src_path, dst_path);
+    request.source_path = paths[0];
+    request.destination_path = paths[1];
+    // Con '&' el movimiento se hace en el CopyService y se sigue como un trabajo más
+    if (is_background_) return StartBackgroundCopy(args, request);
+    CopyInForeground(request);
   } catch (const std::system_error& error) {
     std::throw_with_nested(std::runtime_error("ERROR: mv command failed!"));
     return 1;
@@ -134,39 +162,224 @@ int Shell::MvCommand(const std::vector<std::string>& args) {
 }
 
 /**
- * @brief Ejecuta los comandos que se les pase (internos o externos)
- * @param commands Vector que contiene los comandos a evaluar
+ * @brief Hace un cp o mv en primer plano, con el límite de velocidad y la prioridad de E/S
+ *        pedidos, y muestra la velocidad conseguida si había límite.
+ * @param request Copia a realizar.
+ */
+void Shell::CopyInForeground(const CopyRequest& request) {
+  CopyProgress progress;
+  progress.rate_limiter = request.rate_limiter.get();
+  int previous_priority = request.io_priority != 0 ? SetThreadIoPriority(request.io_priority) : 0;
+  auto restore_priority = ScopeExit([&request, previous_priority] {
+    if (request.io_priority == 0) return;
+    try {
+      SetThreadIoPriority(previous_priority);
+    } catch (...) {}
+  });
+  if (request.operation == CopyOperation::kMove) {
+    MoveFile(request.source_path, request.destination_path, nullptr, &progress);
+  } else {
+    CopyFile(request.source_path, request.destination_path, request.preserve_all, nullptr, &progress);
+  }
+  if (request.rate_limiter != nullptr) {
+    PrintLine("Average rate: " + FormatRate(request.rate_limiter->GetAchievedRate()) + "\n");
+  }
+}
+
+/**
+ * @brief Muestra los trabajos de la shell y olvida los que ya han terminado.
+ * @param args Vector de strings con los argumentos
+ * 
+ * @return Un entero indicando el éxito (0) o fallo (1) de la función.
+ */
+int Shell::JobsCommand(const std::vector<std::string>& args) {
+  ReapChildren();
+  std::stringstream output;
+  auto& jobs = jobs_.GetJobs();
+  for (auto job = jobs.begin(); job != jobs.end();) {
+    output << FormatJob(job->second) << '\n';
+    if (job->second.state == JobState::kDone) job = jobs.erase(job);
+    else ++job;
+  }
+  PrintLine(output.str());
+  return 0;
+}
+
+/**
+ * @brief Pasa un trabajo a primer plano, reanudándolo si estaba parado, y espera a que termine.
+ * @param args Vector de strings con los argumentos (especificación del trabajo opcional)
+ * @throw std::runtime_error Si el trabajo no existe.
+ * 
+ * @return El valor de salida del trabajo.
+ */
+int Shell::FgCommand(const std::vector<std::string>& args) {
+  if (args.size() > 2) throw std::runtime_error("ERROR: fg: Too many arguments!");
+  Job* job = jobs_.Find(args.size() == 2 ? args[1] : "");
+  if (job == nullptr || job->state == JobState::kDone) throw std::runtime_error("ERROR: fg: No such job!");
+  PrintLine(job->command + "\n");
+  if (job->state == JobState::kStopped) SignalJob(*job, SIGCONT);
+  job->state = JobState::kRunning;
+  return WaitForeground(*job);
+}
+
+/**
+ * @brief Reanuda en segundo plano un trabajo parado.
+ * @param args Vector de strings con los argumentos (especificación del trabajo opcional)
+ * @throw std::runtime_error Si el trabajo no existe.
+ * 
+ * @return Un entero indicando el éxito (0) o fallo (1) de la función.
+ */
+int Shell::BgCommand(const std::vector<std::string>& args) {
+  if (args.size() > 2) throw std::runtime_error("ERROR: bg: Too many arguments!");
+  Job* job = jobs_.Find(args.size() == 2 ? args[1] : "");
+  if (job == nullptr || job->state == JobState::kDone) throw std::runtime_error("ERROR: bg: No such job!");
+  if (job->state == JobState::kStopped) SignalJob(*job, SIGCONT);
+  job->state = JobState::kRunning;
+  PrintLine("[" + std::to_string(job->id) + "] " + job->command + " &\n");
+  return 0;
+}
+
+/**
+ * @brief Espera a que terminen los trabajos en segundo plano indicados, o todos si no se indica ninguno.
+ * @param args Vector de strings con los argumentos (especificaciones de trabajo %n o pids)
+ * 
+ * @return El valor de salida del último trabajo esperado (127 si no existe).
+ */
+int Shell::WaitCommand(const std::vector<std::string>& args) {
+  std::vector<int> job_ids;
+  int return_value = 0;
+  if (args.size() == 1) {
+    for (const auto& [id, job] : jobs_.GetJobs()) {
+      if (job.state == JobState::kRunning) job_ids.push_back(id);
+    }
+  }
+  for (size_t i = 1; i < args.size(); ++i) {
+    Job* job = nullptr;
+    if (args[i][0] == '%') {
+      job = jobs_.Find(args[i]);
+    } else if (args[i].find_first_not_of("0123456789") == std::string::npos) {
+      job = jobs_.FindByPid(std::stoi(args[i]));
+    }
+    if (job == nullptr) {
+      return_value = 127;
+      continue;
+    }
+    job_ids.push_back(job->id);
+  }
+  for (int id : job_ids) {
+    Job* job = jobs_.Find(std::to_string(id));
+    if (job == nullptr) continue;
+    if (job->IsBuiltin() && job->state == JobState::kRunning) FinishBuiltinJob(*job);
+    while (job->state == JobState::kRunning) {
+      int status;
+      pid_t pid = waitpid(job->pid, &status, WUNTRACED);
+      if (pid < 0 && errno == EINTR) continue;
+      if (pid < 0) {
+        job->state = JobState::kDone;
+        break;
+      }
+      jobs_.UpdateStatus(pid, status);
+    }
+    return_value = job->status;
+    if (job->state == JobState::kDone) jobs_.Remove(id);
+  }
+  return return_value;
+}
+
+/**
+ * @brief Ejecuta los comandos que se les pase (internos o externos). En modo --profile
+ *        además se miden y se acumulan en el perfil.
+ * @param command Comando a evaluar con sus argumentos
+ * 
+ * @return Un CommandResult indicando el éxito o fallo del comando y de la salida.
+ */
+CommandResult Shell::ExecuteCommand(const Command& command) {
+  if (!profiler_.IsEnabled()) return DispatchCommand(command);
+  CommandResult result(0);
+  CommandSample sample = MeasureCommand(command, result);
+  profiler_.RecordCommand(command.args[0], sample);
+  return result;
+}
+
+/**
+ * @brief Ejecuta un comando midiendo el tiempo real, el de CPU, la memoria y los cambios de contexto.
+ *        En los comandos externos se incluyen el rusage del hijo y el coste del fork y el exec.
+ * @param command Comando a ejecutar.
+ * @param result Resultado del comando.
+ * 
+ * @return Las medidas de la ejecución.
+ */
+CommandSample Shell::MeasureCommand(const Command& command, CommandResult& result) {
+  bool was_measuring = is_measuring_;
+  is_measuring_ = true;
+  has_child_usage_ = false;
+  spawn_us_ = 0;
+  CommandTimer timer;
+  try {
+    result = DispatchCommand(command);
+  } catch (...) {
+    is_measuring_ = was_measuring;
+    throw;
+  }
+  CommandSample sample = timer.Stop(has_child_usage_ ? &child_usage_ : nullptr);
+  sample.spawn_us = spawn_us_;
+  is_measuring_ = was_measuring;
+  return sample;
+}
+
+/**
+ * @brief Busca el comando (interno, cargado o externo) y lo ejecuta
+ * @param command Comando a evaluar con sus argumentos
  * 
  * @return Un CommandResult indicando el éxito o fallo del comando y de la salida.
  */
-CommandResult Shell::ExecuteCommand(const std::vector<std::string>& commands) {
+CommandResult Shell::DispatchCommand(const Command& command) {
   try {
-    // Comprobar si los comandos recibidos son internos o no.
-    bool incorrect_command = true;
-    for (const auto& internal_command : internal_commands_) {
-      if (commands[0] == internal_command) {
-        incorrect_command = false;
-        break;
+    const std::vector<std::string>& commands = command.args;
+    // Si es un comando interno se llama directamente a su método (exit pide salir de la shell)
+    if (const Builtin* builtin = FindBuiltin(commands[0])) {
+      TraceSpan builtin_span("builtin", commands[0]);
+      // Los comandos internos escriben directamente en el destino de las redirecciones
+      std::vector<std::pair<int, int>> saved_fds = RedirectFds(command.redirections);
+      auto restore_fds = ScopeExit([&saved_fds] {
+        RestoreFds(saved_fds);
+      });
+      is_background_ = command.is_background;
+      int return_value;
+      try {
+        return_value = (this->*builtin->function)(commands);
+      } catch (...) {
+        is_background_ = false;
+        throw;
       }
+      is_background_ = false;
+      return CommandResult(return_value, is_quit_requested_);
     }
-    // Si es exit sale de la shell
-    if (commands[0] == "exit") return CommandResult::Quit();
-    // Si es cp -> COPYFILE
-    else if (commands[0] == "echo") {
-      return CommandResult(EchoCommand(commands), false);
-    // Si es cd -> Comando cd
-    } else if (commands[0] == "cd") {
-      return CommandResult(CdCommand(commands), false);
-    // Si es mv -> Comando mv
-    } else if (commands[0] == "cp") {
-      return CommandResult(CpCommand(commands), false);
-    // Si es echo -> Comando echo
-    } else if (commands[0] == "mv") {
-      return CommandResult(MvCommand(commands), false);
-      // En el caso de que no sea ningún comando interno, se ejecutará como comando externo.
-    } else {
-      return CommandResult(ExecuteProgram(commands, true), false);
+    // Si es un comando cargado con enable -f se llama a la función del objeto compartido
+    auto loaded_builtin = loaded_builtins_.find(commands[0]);
+    if (loaded_builtin != loaded_builtins_.end()) {
+      TraceSpan builtin_span("builtin", commands[0]);
+      std::vector<std::pair<int, int>> saved_fds = RedirectFds(command.redirections);
+      auto restore_fds = ScopeExit([&saved_fds] {
+        RestoreFds(saved_fds);
+      });
+      std::vector<const char*> argv;
+      for (const auto& arg : commands) argv.push_back(arg.c_str());
+      argv.push_back(nullptr);
+      // Los comandos cargados escriben con su propia stdio
+      StandardOutput().Flush();
+      int return_value = loaded_builtin->second(commands.size(), argv.data());
+      fflush(stdout);
+      return CommandResult(return_value, false);
+    }
+    // En el caso de que no sea ningún comando interno, se ejecutará como comando externo.
+    if (command.is_background) {
+      pid_t pid = ExecuteProgram(commands, false, command.redirections);
+      const Job& job = jobs_.Add(pid, JoinArgs(commands));
+      PrintLine("[" + std::to_string(job.id) + "] " + std::to_string(pid) + "\n");
+      return CommandResult(0, false);
     }
+    return CommandResult(ExecuteProgram(commands, true, command.redirections), false);
   } catch (const std::exception& error) {
     std::throw_with_nested(std::runtime_error("ERROR: Executing commands failed!"));
   }
@@ -177,39 +390,86 @@ CommandResult Shell::ExecuteCommand(const std::vector<std::string>& commands) {
  * @brief Ejecuta un programa externo
  * @param args Vector que contiene los comandos a evaluar
  * @param has_wait Bool que indica si esperar a que finalice el programa antes de volver a iniciar.
+ * @param redirections Redirecciones del programa: los archivos se abren en la shell (para informar
+ *                     de los errores) y el hijo los coloca con dup2 antes del exec.
  * 
  * @return El estado de salida del programa si has_wait es verdadero, la identificación del proceso 
  *         secundario si has_wait es falso, un valor distinto de cero en caso de error.
  */
-int Shell::ExecuteProgram(const std::vector<std::string>& args, bool has_wait = true) {
+int Shell::ExecuteProgram(const std::vector<std::string>& args, bool has_wait = true,
+                          const std::vector<Redirection>& redirections) {
   try {
+    // Convierte el vector de string a un vector de char* (strings). Se hace antes del fork:
+    // con hilos en el pool de E/S el hijo no debe reservar memoria antes del exec.
+    std::vector<char*> argv;
+    for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    std::vector<std::pair<int, int>> redirection_fds = OpenRedirections(redirections);
+    auto close_redirections = ScopeExit([&redirections, &redirection_fds] {
+      CloseRedirections(redirections, redirection_fds);
+    });
+    // Si se está midiendo o trazando, una tubería con O_CLOEXEC se cierra justo cuando el exec tiene éxito
+    int exec_pipe[2] = { -1, -1 };
+    // Lo que haya en el buffer de salida tiene que salir antes que lo que escriba el programa
+    StandardOutput().Flush();
+    if ((is_measuring_ || IsTracing()) && pipe2(exec_pipe, O_CLOEXEC) < 0) {
+      throw std::system_error(errno, std::system_category());
+    }
+    auto spawn_start = std::chrono::steady_clock::now();
+    uint64_t spawn_start_ns = IsTracing() ? TraceClock() : 0;
     // Crea un proceso hijo
     pid_t pid = fork();
     // Si falla lanza una excepcion
     if (pid < 0) {
+      if (exec_pipe[0] >= 0) {
+        close(exec_pipe[0]);
+        close(exec_pipe[1]);
+      }
       std::throw_with_nested(std::runtime_error("ERROR: Creating the process!"));
     }
     // Si estamos en el proceso padre
     if (pid > 0) {
+      if (exec_pipe[0] >= 0) {
+        char byte;
+        close(exec_pipe[1]);
+        while (read(exec_pipe[0], &byte, 1) < 0 && errno == EINTR) { }
+        close(exec_pipe[0]);
+        std::chrono::duration<double, std::micro> spawn_time = std::chrono::steady_clock::now() - spawn_start;
+        spawn_us_ = spawn_time.count();
+        if (spawn_start_ns != 0) RecordSpan("spawn", args[0], spawn_start_ns, TraceClock());
+      }
+      // Con control de trabajos cada programa va en su propio grupo de procesos
+      if (is_interactive_) setpgid(pid, pid);
       // Si tenemos que esperar a que el proceso hijo termine y retornar la salida
       if (has_wait) {
-        int status;
-        waitpid(pid, &status, 0);
-        return WEXITSTATUS(status);
+        Job& job = jobs_.Add(pid, JoinArgs(args));
+        return WaitForeground(job);
         // Si no tenemos que esperar, se retorna el id del proceso hijo
       } else {
         return pid;
       }
       // Si estamos en el proceso hijo
     } else {
-      // Convierte el vector de string a un vector de char* (strings)
-      char** argv = new char*[args.size() + 1];
-      for (int i = 0; i < args.size(); i++) {
-        argv[i] = const_cast<char*>(args[i].c_str());
+      // Restaura las señales que la shell bloquea o ignora. Antes toma el terminal, como hace el
+      // padre: si no, podría leer de él antes que el padre se lo ceda y pararse con SIGTTIN
+      if (is_interactive_) {
+        setpgid(0, 0);
+        if (has_wait) tcsetpgrp(STDIN_FILENO, getpgrp());
+      }
+      for (int signal_number : { SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU }) {
+        signal(signal_number, SIG_DFL);
+      }
+      sigprocmask(SIG_SETMASK, &original_mask_, nullptr);
+      // Coloca las redirecciones en orden (así "> archivo 2>&1" manda las dos salidas al archivo)
+      for (const auto& [target_fd, source_fd] : redirection_fds) {
+        if (target_fd == source_fd) {
+          fcntl(target_fd, F_SETFD, 0);
+        } else if (dup2(source_fd, target_fd) < 0) {
+          _exit(EXIT_FAILURE);
+        }
       }
-      argv[args.size()] = nullptr;
       // Ejecuta el programa. Si la ejecución falla, se sale del programa.
-      if (execvp(argv[0], argv) < 0) exit(EXIT_FAILURE);
+      if (execvp(argv[0], argv.data()) < 0) _exit(EXIT_FAILURE);
     }
     return 0;
   } catch (const std::exception& error) {
@@ -222,43 +482,379 @@ int Shell::ExecuteProgram(const std::vector<std::string>& args, bool has_wait =
  * @param error El error a imprimir.
  */
 void PrintError(const std::string& error) {
+  StandardOutput().Flush();
   std::cerr << "ERROR: " << error << '\n' << '\n';
   std::cerr.flush();
 }
 
 /**
- * @brief Ejecuta la shell
+ * @brief Cierra el descriptor de señales de la shell y las bibliotecas de comandos cargadas
  */
-void Shell::Run() {
-  std::vector<std::vector<std::string>> commands;
+Shell::~Shell() {
+  if (signal_fd_ >= 0) close(signal_fd_);
+  for (void* handle : plugin_handles_) dlclose(handle);
+}
+
+/**
+ * @brief Prepara el control de trabajos: SIGCHLD se recibe por un signalfd y,
+ *        si la shell es interactiva, toma el control del terminal.
+ * @throw std::system_error Si no se puede crear el signalfd.
+ */
+void Shell::SetupJobControl() {
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGCHLD);
+  sigprocmask(SIG_BLOCK, &mask, &original_mask_);
+  signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (signal_fd_ < 0) throw std::system_error(errno, std::system_category());
+  is_interactive_ = isatty(STDIN_FILENO);
+  if (!is_interactive_) return;
+  // La shell ignora las señales de teclado; las reciben los trabajos en primer plano
+  for (int signal_number : { SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU }) {
+    signal(signal_number, SIG_IGN);
+  }
+  setpgid(0, 0);
+  tcsetpgrp(STDIN_FILENO, getpgrp());
+}
+
+/**
+ * @brief Envía una señal al trabajo (a todo su grupo de procesos si hay control de trabajos)
+ * @param job Trabajo al que enviar la señal.
+ * @param signal_number Señal a enviar.
+ */
+void Shell::SignalJob(const Job& job, int signal_number) {
+  // Los comandos internos se ejecutan en hilos de la shell: no hay proceso al que enviarla,
+  // pero las señales que terminarían el proceso cancelan la copia
+  if (job.IsBuiltin()) {
+    if (signal_number == SIGINT || signal_number == SIGTERM || signal_number == SIGKILL) job.copy.Cancel();
+    return;
+  }
+  kill(is_interactive_ ? -job.pid : job.pid, signal_number);
+}
+
+/**
+ * @brief Espera a un trabajo en primer plano, cediéndole el terminal mientras se ejecuta.
+ *        Si el trabajo se para (Ctrl-Z) se queda en la tabla de trabajos.
+ * @param job Trabajo al que esperar.
+ * 
+ * @return El valor de salida del trabajo.
+ */
+int Shell::WaitForeground(Job& job) {
+  int id = job.id;
+  if (job.IsBuiltin()) {
+    int return_value = FinishBuiltinJob(job);
+    jobs_.Remove(id);
+    return return_value;
+  }
+  pid_t pid = job.pid;
+  TraceSpan wait_span("wait", job.command);
+  StandardOutput().Flush();
+  if (is_interactive_) tcsetpgrp(STDIN_FILENO, pid);
+  int status = 0;
+  pid_t waited_pid;
+  do {
+    waited_pid = wait4(pid, &status, WUNTRACED, &child_usage_);
+  } while (waited_pid < 0 && errno == EINTR);
+  has_child_usage_ = waited_pid > 0;
+  if (is_interactive_) tcsetpgrp(STDIN_FILENO, getpgrp());
+  if (waited_pid < 0) {
+    jobs_.Remove(id);
+    throw std::system_error(errno, std::system_category());
+  }
+  jobs_.UpdateStatus(pid, status);
+  if (WIFSTOPPED(status)) {
+    PrintLine("\n" + FormatJob(job) + "\n");
+  } else {
+    jobs_.Remove(id);
+  }
+  return StatusToReturnValue(status);
+}
+
+/**
+ * @brief Lanza un cp o mv en el CopyService y lo añade a la tabla de trabajos.
+ * @param args Comando y argumentos, para mostrarlo en jobs.
+ * @param request Copia a realizar.
+ * 
+ * @return Un entero indicando el éxito (0) o fallo (1) del lanzamiento.
+ */
+int Shell::StartBackgroundCopy(const std::vector<std::string>& args, CopyRequest request) {
+  // Las rutas se resuelven ya: la copia no debe verse afectada por un cd posterior
+  request.source_path = std::filesystem::absolute(request.source_path).string();
+  request.destination_path = std::filesystem::absolute(request.destination_path).string();
+  Job& job = jobs_.Add(0, JoinArgs(args));
+  job.copy = copy_service_.Submit(std::move(request));
+  PrintLine("[" + std::to_string(job.id) + "] " + job.command + "\n");
+  return 0;
+}
+
+/**
+ * @brief Espera a que termine un comando interno del pool de E/S y guarda su resultado.
+ * @param job Trabajo a esperar.
+ * 
+ * @return El valor de salida del comando (1 si ha fallado).
+ */
+int Shell::FinishBuiltinJob(Job& job) {
+  try {
+    job.status = job.copy.Wait();
+  } catch (const std::exception& error) {
+    std::cerr << job.command << ": ";
+    PrintException(error);
+    job.status = 1;
+  }
+  job.state = JobState::kDone;
+  return job.status;
+}
+
+/**
+ * @brief Atiende el eventfd del pool de E/S: marca como terminados los comandos internos acabados.
+ */
+void Shell::HandleIoCompletions() {
+  copy_service_.ClearEvents();
+  for (auto& [id, job] : jobs_.GetJobs()) {
+    if (!job.IsBuiltin() || job.state == JobState::kDone) continue;
+    if (job.copy.IsDone()) FinishBuiltinJob(job);
+  }
+  NotifyJobs();
+}
+
+/**
+ * @brief Recoge el estado de todos los hijos que hayan cambiado, sin bloquearse.
+ */
+void Shell::ReapChildren() {
+  int status;
+  pid_t pid;
+  while ((pid = waitpid(-1, &status, WNOHANG | WUNTRACED | WCONTINUED)) > 0) {
+    jobs_.UpdateStatus(pid, status);
+  }
+}
+
+/**
+ * @brief Avisa de los trabajos en segundo plano que han terminado y los elimina de la tabla.
+ */
+void Shell::NotifyJobs() {
+  std::stringstream notification;
+  auto& jobs = jobs_.GetJobs();
+  for (auto job = jobs.begin(); job != jobs.end();) {
+    if (job->second.state != JobState::kDone) {
+      ++job;
+      continue;
+    }
+    notification << FormatJob(job->second) << '\n';
+    job = jobs.erase(job);
+  }
+  if (!is_interactive_ || notification.str().empty()) return;
+  PrintLine("\n" + notification.str());
+  // Se vuelve a mostrar el prompt con lo que se estuviera escribiendo
+  editor_.Redraw();
+}
+
+/**
+ * @brief Atiende el signalfd: vacía las señales pendientes y recoge los hijos terminados.
+ */
+void Shell::HandleSignal() {
+  struct signalfd_siginfo info;
+  while (read(signal_fd_, &info, sizeof(info)) == sizeof(info)) { }
+  ReapChildren();
+  NotifyJobs();
+}
+
+/**
+ * @brief Atiende la entrada estándar: lee lo disponible y ejecuta cada línea completa.
+ */
+void Shell::HandleInput() {
+  ssize_t bytes_read;
+  try {
+    TraceSpan read_span("read");
+    bytes_read = ReadInput(STDIN_FILENO, pending_input_);
+  } catch (const std::exception& error) {
+    PrintError(error.what());
+    event_loop_.Stop();
+    return;
+  }
+  // En un terminal las teclas pasan por el editor de línea
+  if (is_interactive_) {
+    HandleTerminalInput(bytes_read);
+    return;
+  }
+  // Al final de la entrada se ejecuta la última línea aunque no acabe en salto de línea
+  if (bytes_read == 0 && !pending_input_.empty()) pending_input_.push_back('\n');
   std::string line;
-  int last_command_status = 0;
-  // Bucle principal de la SHELL
-  while (true) {
-    try {
-      // Imprimir el prompt
-      PrintPrompt(last_command_status);
-      // Lee la línea 
-      line = ReadLine(STDIN_FILENO);
-      // Divide la entrada en comandos
+  bool has_lines = false;
+  while (event_loop_.IsRunning() && PopLine(pending_input_, line)) {
+    history_.Add(line);
+    ExecuteLine(line);
+    has_lines = true;
+  }
+  if (bytes_read == 0) event_loop_.Stop();
+  if (has_lines && event_loop_.IsRunning()) ShowPrompt();
+}
+
+/**
+ * @brief Pasa al editor de línea las teclas leídas del terminal. Cada línea terminada se
+ *        ejecuta con el terminal en modo normal y después se vuelve a editar con un prompt
+ *        nuevo; lo que se haya tecleado mientras tanto se procesa a continuación.
+ * @param bytes_read Bytes leídos (0 si el terminal se ha cerrado).
+ */
+void Shell::HandleTerminalInput(ssize_t bytes_read) {
+  std::string line;
+  while (event_loop_.IsRunning()) {
+    LineEditor::Status status = editor_.Feed(pending_input_, line);
+    if (status == LineEditor::Status::kEditing) break;
+    if (status == LineEditor::Status::kEnd) {
+      event_loop_.Stop();
+      break;
+    }
+    history_.Add(line);
+    ExecuteLine(line);
+    if (event_loop_.IsRunning()) ShowPrompt();
+  }
+  if (bytes_read == 0) event_loop_.Stop();
+}
+
+/**
+ * @brief Muestra el prompt. En un terminal lo hace el editor de línea, que empieza una línea nueva.
+ */
+void Shell::ShowPrompt() {
+  if (!is_interactive_) {
+    PrintPrompt(last_command_status_);
+    return;
+  }
+  try {
+    editor_.Start(FormatPrompt(last_command_status_));
+  } catch (const std::exception& error) {
+    PrintError(error.what());
+    event_loop_.Stop();
+  }
+}
+
+/**
+ * @brief Completa la palabra que acaba en el cursor: si es la primera de un comando, con los
+ *        comandos internos y los ejecutables de PATH; si no (o si tiene '/'), con las rutas.
+ *        Los separadores son los espacios, las tuberías, ';', '&' y las redirecciones.
+ * @param line Línea que se está escribiendo.
+ * @param cursor Posición del cursor.
+ * @param word_start Posición donde se guarda el inicio de la palabra.
+ *
+ * @return Los candidatos de la palabra.
+ */
+CompletionResult Shell::CompleteWord(const std::string& line, size_t cursor, size_t& word_start) {
+  TraceSpan complete_span("complete");
+  size_t separator = cursor == 0 ? std::string::npos : line.find_last_of(" \t|;&<>", cursor - 1);
+  word_start = separator == std::string::npos ? 0 : separator + 1;
+  size_t previous = word_start == 0 ? std::string::npos : line.find_last_not_of(" \t", word_start - 1);
+  bool is_command = previous == std::string::npos || line[previous] == '|' || line[previous] == ';' ||
+                    line[previous] == '&';
+  std::string word = line.substr(word_start, cursor - word_start);
+  if (is_command && word.find('/') == std::string::npos) return completion_.CompleteCommand(word, GetInternalCommands());
+  return completion_.CompletePath(word);
+}
+
+/**
+ * @brief Divide una línea en comandos y los ejecuta en orden
+ * @param line Línea a ejecutar.
+ */
+void Shell::ExecuteLine(const std::string& line) {
+  // Si la linea de entrada está vacía no hay nada que ejecutar
+  if (line.empty()) return;
+  TraceSpan line_span("line", line);
+  try {
+    // Divide la línea en comandos (en modo --profile se mide cuánto tarda)
+    auto parse_start = std::chrono::steady_clock::now();
+    std::vector<Command> commands;
+    {
+      TraceSpan parse_span("parse");
       commands = ParseLine(line);
-      // Si la linea de entrada está vacía va a la siguiente iteacion del bucle
-      if (line.empty()) continue;
-      // Recorre cada uno de los comandos y los ejecuta
-      for (const auto& cmd : commands) {
-        // Se ejecuta el comando y obtenemos el resultado del comando
-        auto [return_value, is_quit_requested] = ExecuteCommand(cmd);
-        // Si se requiere el quit, se sale de la shell
-        if (is_quit_requested) exit(EXIT_SUCCESS);
-        std::cout << std::endl;
-        // Actualiza el estado del ultimo comando
-        last_command_status = return_value;
-        if (return_value != 0) PrintError("ERROR: Executing command failed!");
+    }
+    if (profiler_.IsEnabled()) {
+      std::chrono::duration<double, std::micro> parse_time = std::chrono::steady_clock::now() - parse_start;
+      profiler_.RecordParse(parse_time.count());
+    }
+    // Recorre cada uno de los comandos y los ejecuta
+    for (const auto& cmd : commands) {
+      // Se expanden las variables y los globs (si no queda nada, no hay comando que ejecutar)
+      Command expanded;
+      {
+        TraceSpan expand_span("expand");
+        expanded = ExpandCommand(cmd, last_command_status_);
+      }
+      if (expanded.args.empty()) continue;
+      // Se ejecuta el comando y obtenemos el resultado del comando
+      auto [return_value, is_quit_requested] = ExecuteCommand(expanded);
+      // Si se requiere el quit, se sale de la shell
+      if (is_quit_requested) {
+        event_loop_.Stop();
+        return;
       }
+      StandardOutput().EndCommand();
+      // Actualiza el estado del ultimo comando
+      last_command_status_ = return_value;
+      if (return_value != 0) PrintError("ERROR: Executing command failed!");
+    }
+  } catch (const std::exception& error) {
+    PrintError(error.what());
+    last_command_status_ = 1;
+  }
+}
+
+/**
+ * @brief Escribe los comandos pendientes en el archivo de historial. Si falla (por ejemplo, con
+ *        el disco lleno) se avisa una sola vez y la shell sigue; los comandos se quedan
+ *        pendientes para el siguiente intento.
+ */
+void Shell::FlushHistory() {
+  try {
+    history_.Flush();
+    has_history_error_ = false;
+  } catch (const std::exception& error) {
+    if (!has_history_error_) {
+      PrintError("Saving the history: " + std::string(error.what()));
+      editor_.Redraw();
+    }
+    has_history_error_ = true;
+  }
+}
+
+/**
+ * @brief Ejecuta la shell. El bucle de eventos atiende la entrada estándar y
+ *        la terminación de los procesos hijos sin bloquear el prompt.
+ */
+void Shell::Run() {
+  SetupJobControl();
+  event_loop_.AddFd(STDIN_FILENO, [this] { HandleInput(); });
+  event_loop_.AddFd(signal_fd_, [this] { HandleSignal(); });
+  event_loop_.AddFd(copy_service_.GetEventFd(), [this] { HandleIoCompletions(); });
+  // El historial solo se guarda en las shells interactivas; los lotes pendientes se escriben cada segundo
+  if (is_interactive_) {
+    try {
+      history_.Open(DefaultHistoryPath());
+      event_loop_.AddTimer(std::chrono::seconds(1), [this] { FlushHistory(); }, true);
     } catch (const std::exception& error) {
-      std::cout << std::endl;
       PrintError(error.what());
-      last_command_status = 1;
     }
   }
-}
\ No newline at end of file
+  // En un terminal se edita la línea con historial y completación
+  if (is_interactive_) {
+    editor_.SetHistory(&history_);
+    editor_.SetCompleter([this](const std::string& line, size_t cursor, size_t& word_start) {
+      return CompleteWord(line, cursor, word_start);
+    });
+  }
+  // Imprimir el prompt
+  ShowPrompt();
+  // Bucle principal de la SHELL
+  event_loop_.Run();
+  editor_.Stop();
+  // En modo --profile se vuelcan los histogramas al salir. Cada paso se intenta aunque falle
+  // el anterior, para que un perfil que no se puede escribir no impida guardar la traza
+  auto run_step = [](auto step) {
+    try {
+      step();
+    } catch (const std::exception& error) {
+      PrintError(error.what());
+    }
+  };
+  run_step([] { StandardOutput().Flush(); });
+  run_step([this] { history_.Flush(); });
+  run_step([this] { profiler_.Dump(); });
+  run_step([] { DumpTrace(); });
+}
@@ -13,46 +13,13 @@
  * Enlaces de interés
  */
 
+#include <cerrno>
+#include <system_error>
+
+#include "output_writer.h"
 #include "shell_system.h"
 #include "scope_exit.h"
 
-/**
- * @brief Lee un archivo y devuelve su contenido en un vector de bytes.
- * @param fd Descriptor del archivo.
- * @throw std::system_error Si se produce un error al leer el archivo.
- * @throw std::runtime_error Si se produce un error al leer el archivo.
- * 
- * @return Vector de bytes con el contenido del archivo.
- */
-std::vector<uint8_t> ReadFile(const int fd) {
-  try {
-    std::vector<uint8_t> buffer(16ul * 1024 * 1024);
-    ssize_t bytes_read = read(fd, buffer.data(), buffer.size());
-    if (bytes_read < 0) throw std::system_error(errno, std::system_category());
-    buffer.resize(bytes_read);
-    return buffer;
-  } catch (const std::exception& error) {
-    std::throw_with_nested(std::runtime_error("ERROR: Reading file failed!"));
-  }
-}
-
-/**
- * @brief Escribe un vector de bytes en un archivo.
- * @param fd Descriptor del archivo.
- * @param buffer Vector de bytes a escribir en el archivo.
- * @throw std::runtime_error Si se produce un error al escribir el archivo.
- * 
- * @return Vector de bytes escrito en el archivo.
- */
-std::vector<uint8_t> WriteFile(int fd, std::vector<uint8_t> buffer) {
-  try {
-    write(fd, buffer.data(), buffer.size());
-    return buffer;
-  } catch (const std::exception& error) {
-    std::throw_with_nested(std::runtime_error("ERROR: Writing file failed!"));
-  }
-}
-
 /**
  * @brief Divide una cadena de entrada en un vector de subcadenas, utilizando separadores y tokens especificados.
  * @param input_string Cadena de entrada.
@@ -121,153 +88,219 @@ std::vector<std::string> SplitSpaces(const std::string& input_string) {
   return characters;
 }
 
+/**
+ * @brief Une los argumentos de un comando separándolos por espacios.
+ * @param args Vector con el comando y sus argumentos.
+ *
+ * @return Cadena con el comando tal y como se escribiría en la shell.
+ */
+std::string JoinArgs(const std::vector<std::string>& args) {
+  std::string line;
+  for (const auto& arg : args) {
+    if (!line.empty()) line.push_back(' ');
+    line += arg;
+  }
+  return line;
+}
+
 /**
  * @brief Divide una línea en un vector de comandos, utilizando el carácter '|' 
  *        como separador de pipes y el carácter ';' como separador de sentencias múltiples.
+ *        El carácter '&' también separa comandos y marca el anterior para ejecutarse en segundo plano,
+ *        salvo cuando forma parte de una redirección N>&M.
  * @param line Línea de entrada.
  *
- * @return Vector de vectores de subcadenas, donde cada subvector contiene un comando y sus argumentos.
+ * @return Vector de comandos, donde cada uno contiene sus argumentos y redirecciones.
+ * @throw std::runtime_error Si una redirección no tiene archivo o descriptor de destino, o si
+ *        la línea tiene '&&' (no se admite: ejecutaría el primer comando en segundo plano).
  */
-std::vector<std::vector<std::string>> ParseLine(const std::string& line) {
-  std::vector<std::vector<std::string>> result;
-  auto commands = Split(line, std::vector<char>{'|', ';', '&'}, std::vector<char>());
-  for (const auto& command : commands) {
-    auto token = SplitSpaces(line);
-    result.emplace_back(token);
+std::vector<Command> ParseLine(const std::string& line) {
+  std::vector<Command> result;
+  std::string command_line;
+  auto add_command = [&result, &command_line](bool is_background) {
+    Command command = ParseCommand(command_line);
+    command.is_background = is_background;
+    if (!command.args.empty()) result.emplace_back(std::move(command));
+    command_line.clear();
+  };
+  for (size_t i = 0; i < line.size(); ++i) {
+    char symbol = line[i];
+    bool is_redirection = symbol == '&' && !command_line.empty() && (command_line.back() == '>' || command_line.back() == '<');
+    if (symbol == '&' && !is_redirection && i + 1 < line.size() && line[i + 1] == '&') {
+      throw std::runtime_error("ERROR: '&&' is not supported!");
+    }
+    if ((symbol == '|' || symbol == ';' || symbol == '&') && !is_redirection) {
+      add_command(symbol == '&');
+      continue;
+    }
+    command_line.push_back(symbol);
   }
+  add_command(false);
   return result;  
 }
 
 /**
- * @brief Copia un archivo de una ruta de origen a una ruta de destino.
- * @param source_path Ruta del archivo de origen.
- * @param destination_path Ruta del archivo de destino.
- * @param preserve_all Indica si se deben preservar todas las propiedades del archivo de origen (permisos, propietario, fechas de acceso y modificación).
- * @throw std::system_error Si se produce un error al abrir o cerrar el archivo de origen o destino.
- * @throw std::runtime_error Si se produce un error al copiar el archivo.
+ * @brief Divide un comando en argumentos (separados por espacios o tabuladores) y redirecciones.
+ *        Se reconocen "< archivo", "> archivo", ">> archivo", "N> archivo", "N>> archivo",
+ *        "N< archivo" y "N>&M", con o sin espacios entre el operador y el archivo.
+ * @param command_line Texto de un único comando.
+ *
+ * @return Comando con sus argumentos y redirecciones.
+ * @throw std::runtime_error Si una redirección no tiene archivo o descriptor de destino.
  */
-void CopyFile(const std::string& source_path, const std::string& destination_path, bool preserve_all) {
-  try {
-    // Obtiene el stat del source_path
-    struct stat source_path_stat{};
-    if (stat(source_path.c_str(), &source_path_stat) == -1  || !S_ISREG(source_path_stat.st_mode)) {
-      // Da una excepción si el camino origen no existe
-      std::throw_with_nested(std::runtime_error("ERROR: Source path does not exist or source file is not a regular file!"));
-    }
-    // Obtiene el camino de destino y el nombre de directorio de destino
-    std::string destination_path_copy = destination_path;
-    char* c_destination_path = const_cast<char*>(destination_path.c_str());
-    std::string dst_dir_name = dirname(c_destination_path);
-    struct stat dst_dir_name_stat{};
-    // Comprueba si el directorio de destino existe
-    if (stat(dst_dir_name.c_str(), &dst_dir_name_stat) == -1) {
-      std::throw_with_nested(std::runtime_error("ERROR: Destination path does not exist!"));
+Command ParseCommand(const std::string& command_line) {
+  Command command;
+  std::string token;
+  auto add_token = [&command, &token]() {
+    if (!token.empty()) command.args.emplace_back(std::move(token));
+    token.clear();
+  };
+  size_t i = 0;
+  while (i < command_line.size()) {
+    char symbol = command_line[i];
+    if (symbol == ' ' || symbol == '\t') {
+      add_token();
+      ++i;
+      continue;
     }
-    // Comprueba si el camino de destino es un directorio
-    struct stat destination_path_stat{};
-    destination_path_copy = destination_path;
-    stat(destination_path_copy.c_str(), &destination_path_stat);
-    if (S_ISDIR(destination_path_stat.st_mode)) {
-      std::string source_path_copy = source_path;
-      char* c_source_path = const_cast<char*>(source_path.c_str());
-      std::string src_base_name = basename(c_source_path);
-      destination_path_copy += "/" + src_base_name;
+    if (symbol != '>' && symbol != '<') {
+      token.push_back(symbol);
+      ++i;
+      continue;
     }
-    // Comprueba si el source path y el destination path son iguales
-    if (source_path_stat.st_dev == destination_path_stat.st_dev && source_path_stat.st_ino == destination_path_stat.st_ino) {
-      std::stringstream error;
-      error << "'" << source_path << "' is the same file as '" << destination_path << "'";
-      std::throw_with_nested(std::runtime_error(error.str()));
+    Redirection redirection;
+    redirection.fd = symbol == '>' ? STDOUT_FILENO : STDIN_FILENO;
+    // Un número pegado al operador es el descriptor que se redirige (2> errores)
+    if (!token.empty() && token.size() < 4 && token.find_first_not_of("0123456789") == std::string::npos) {
+      redirection.fd = std::stoi(token);
+      token.clear();
+    } else {
+      add_token();
     }
-
-    int source_fd = open(source_path.c_str(), O_RDONLY);
-    auto close_src = ScopeExit([source_fd]{
-      close(source_fd);
-    });
-    if (source_fd < 0) {
-      throw std::system_error(errno, std::system_category());
+    ++i;
+    if (symbol == '<') {
+      redirection.flags = O_RDONLY;
+    } else if (i < command_line.size() && command_line[i] == '>') {
+      redirection.flags = O_WRONLY | O_CREAT | O_APPEND;
+      ++i;
+    } else {
+      redirection.flags = O_WRONLY | O_CREAT | O_TRUNC;
     }
-
-    int destination_fd = open(destination_path_copy.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
-    auto close_dst = ScopeExit([destination_fd]{
-      close(destination_fd);
-    });
-    if (destination_fd < 0) {
-      throw std::system_error(errno, std::system_category());
+    if (i < command_line.size() && command_line[i] == '&') {
+      size_t end = command_line.find_first_not_of("0123456789", ++i);
+      if (end == std::string::npos) end = command_line.size();
+      if (end == i) throw std::runtime_error("ERROR: Missing file descriptor after '>&'!");
+      redirection.dup_fd = std::stoi(command_line.substr(i, end - i));
+      i = end;
+    } else {
+      while (i < command_line.size() && (command_line[i] == ' ' || command_line[i] == '\t')) ++i;
+      size_t end = command_line.find_first_of(" \t<>", i);
+      if (end == std::string::npos) end = command_line.size();
+      if (end == i) throw std::runtime_error("ERROR: Missing file name after redirection!");
+      redirection.path = command_line.substr(i, end - i);
+      i = end;
     }
+    command.redirections.emplace_back(std::move(redirection));
+  }
+  add_token();
+  return command;
+}
 
-    while (true) {
-      std::vector<uint8_t> buffer = ReadFile(source_fd);
-      if (buffer.empty()) break;
-      WriteFile(destination_fd, buffer);
+/**
+ * @brief Abre los archivos de las redirecciones de un comando (con O_CLOEXEC, para que
+ *        no se hereden salvo en el descriptor al que se duplican).
+ * @param redirections Redirecciones del comando.
+ *
+ * @return Pares (descriptor redirigido, descriptor que hay que duplicar en él), en el mismo orden.
+ * @throw std::system_error Si no se puede abrir alguno de los archivos (se cierran los ya abiertos).
+ */
+std::vector<std::pair<int, int>> OpenRedirections(const std::vector<Redirection>& redirections) {
+  std::vector<std::pair<int, int>> fds;
+  for (const auto& redirection : redirections) {
+    if (redirection.path.empty()) {
+      fds.emplace_back(redirection.fd, redirection.dup_fd);
+      continue;
     }
-
-    if (preserve_all) {
-      chmod(destination_path_copy.c_str(), source_path_stat.st_mode);
-      chown(destination_path_copy.c_str(), source_path_stat.st_uid, source_path_stat.st_gid);
-      struct utimbuf times{};
-      times.actime = source_path_stat.st_atim.tv_sec;
-      times.modtime = source_path_stat.st_mtim.tv_sec;
-      utime(destination_path_copy.c_str(), &times);
+    int fd = open(redirection.path.c_str(), redirection.flags | O_CLOEXEC, 0666);
+    if (fd < 0) {
+      int error = errno;
+      CloseRedirections(redirections, fds);
+      throw std::system_error(error, std::system_category(), redirection.path);
     }
-  } catch (const std::exception& error) {
-    std::throw_with_nested(std::runtime_error("ERROR: Copying the file!"));
+    fds.emplace_back(redirection.fd, fd);
   }
+  return fds;
 }
 
 /**
- * @brief Mueve un archivo de una ruta de origen a una ruta de destino.
- * @param source_path Ruta del archivo de origen.
- * @param destination_path Ruta del archivo de destino.
- * @throw std::runtime_error Si se produce un error al mover el archivo.
+ * @brief Cierra los archivos abiertos por OpenRedirections (no los descriptores duplicados).
+ * @param redirections Redirecciones del comando.
+ * @param fds Pares devueltos por OpenRedirections.
  */
-void MoveFile(const std::string& source_path, const std::string& destination_path) {
-  try {
-    struct stat source_path_stat{};
-    if (stat(source_path.c_str(), &source_path_stat) == -1  || !S_ISREG(source_path_stat.st_mode)) {
-     std::throw_with_nested(std::runtime_error("ERROR: Source path does not exist or source file is not a regular file!"));
-    }
-
-    std::string destination_path_copy = destination_path;
-    char* c_destination_path = const_cast<char*>(destination_path.c_str());
-    std::string dst_dir_name = dirname(c_destination_path);
-    struct stat dst_dir_name_stat{};
-    if (stat(dst_dir_name.c_str(), &dst_dir_name_stat) == -1) {
-      std::throw_with_nested(std::runtime_error("ERROR: Destination path does not exist!"));
-    }
+void CloseRedirections(const std::vector<Redirection>& redirections, const std::vector<std::pair<int, int>>& fds) {
+  for (size_t i = 0; i < fds.size(); ++i) {
+    if (!redirections[i].path.empty()) close(fds[i].second);
+  }
+}
 
-    struct stat destination_path_stat{};
-    destination_path_copy = destination_path;
-    stat(destination_path_copy.c_str(), &destination_path_stat);
-    if (S_ISDIR(destination_path_stat.st_mode)) {
-      std::string source_path_copy = source_path;
-      char* c_source_path = const_cast<char*>(source_path.c_str());
-      std::string src_base_name = basename(c_source_path);
-      destination_path_copy += "/" + src_base_name;
+/**
+ * @brief Aplica las redirecciones sobre los descriptores de la propia shell, para que los
+ *        comandos internos escriban directamente en el archivo de destino sin crear un proceso.
+ * @param redirections Redirecciones del comando.
+ *
+ * @return Pares (descriptor redirigido, copia del descriptor original o -1 si estaba cerrado),
+ *         que hay que pasar a RestoreFds al acabar el comando.
+ * @throw std::system_error Si no se puede abrir un archivo o duplicar un descriptor.
+ */
+std::vector<std::pair<int, int>> RedirectFds(const std::vector<Redirection>& redirections) {
+  std::vector<std::pair<int, int>> saved_fds;
+  if (redirections.empty()) return saved_fds;
+  std::vector<std::pair<int, int>> fds = OpenRedirections(redirections);
+  auto close_fds = ScopeExit([&redirections, &fds] {
+    CloseRedirections(redirections, fds);
+  });
+  StandardOutput().Flush();
+  std::cout.flush();
+  std::cerr.flush();
+  for (const auto& [target_fd, source_fd] : fds) {
+    saved_fds.emplace_back(target_fd, fcntl(target_fd, F_DUPFD_CLOEXEC, 10));
+    if (dup2(source_fd, target_fd) < 0) {
+      int error = errno;
+      RestoreFds(saved_fds);
+      throw std::system_error(error, std::system_category());
     }
+  }
+  return saved_fds;
+}
 
-    if (source_path_stat.st_dev == destination_path_stat.st_dev && source_path_stat.st_ino == destination_path_stat.st_ino) {
-      if (rename(source_path.c_str(), destination_path.c_str()) == -1) {
-        throw std::runtime_error("Error renaming " + source_path + " to " + destination_path);
-      }
-      rename(source_path.c_str(), destination_path.c_str());
-    } else {
-      CopyFile(source_path, destination_path, 1);
-      unlink(source_path.c_str());
+/**
+ * @brief Deshace las redirecciones aplicadas por RedirectFds, en orden inverso.
+ * @param saved_fds Pares devueltos por RedirectFds.
+ */
+void RestoreFds(const std::vector<std::pair<int, int>>& saved_fds) {
+  if (saved_fds.empty()) return;
+  try {
+    StandardOutput().Flush();
+  } catch (const std::exception&) { }
+  std::cout.flush();
+  std::cerr.flush();
+  for (auto it = saved_fds.rbegin(); it != saved_fds.rend(); ++it) {
+    if (it->second < 0) {
+      close(it->first);
+      continue;
     }
-  } catch (const std::exception& error) {
-    std::throw_with_nested(std::runtime_error("ERROR: Moving the file!"));
+    dup2(it->second, it->first);
+    close(it->second);
   }
 }
 
 /**
- * @brief Imprime una cadena en la salida estándar.
+ * @brief Imprime una cadena en la salida estándar (a través del buffer de StandardOutput).
  * @param output_string Cadena de salida.
  * @throw std::system_error Si se produce un error al escribir en la salida estándar.
  */
 void PrintLine(const std::string& output_string) {
-  int bytes_written = write(STDOUT_FILENO, output_string.c_str(), output_string.size());
-  if (bytes_written == -1) throw std::system_error(errno, std::system_category());
+  StandardOutput().Write(output_string);
 }
 
 /**
@@ -276,6 +309,16 @@ void PrintLine(const std::string& output_string) {
  */
 void PrintPrompt(int last_command_status) {
   if (!isatty(STDIN_FILENO)) return;
+  PrintLine(FormatPrompt(last_command_status));
+  StandardOutput().Flush();
+}
+
+/**
+ * @brief Forma el prompt de la shell: usuario, máquina y directorio actual en una línea y la
+ *        flecha en la siguiente.
+ * @param last_command_status Estado del último comando ejecutado (la flecha cambia si no es cero).
+ */
+std::string FormatPrompt(int last_command_status) {
   char* username = getpwuid(getuid())->pw_name;
   char* hostname = new char[1024];
   char* current_work_directory = new char[1024];
@@ -292,47 +335,40 @@ void PrintPrompt(int last_command_status) {
   std::string arrow = last_command_status == 0 ? "► " : "◄ ";
   prompt << username << "@" << hostname << ":/" << work_directory << std::endl;
   prompt << arrow << " ";
-  PrintLine(prompt.str());
+  return prompt.str();
 }
 
 /**
- * @brief Lee una línea de un descriptor de archivo.
+ * @brief Lee los datos disponibles de un descriptor de archivo y los añade a la entrada pendiente.
  * @param fd Descriptor de archivo.
+ * @param pending_input Entrada leída que todavía no forma una línea completa.
  * @throw std::system_error Si se produce un error al leer del descriptor de archivo.
- * @throw std::runtime_error Si se produce un error al procesar la línea leída.
  * 
- * @return Cadena con la línea leída.
+ * @return Número de bytes leídos (0 si se ha llegado al final de la entrada).
  */
-std::string ReadLine(int fd) {
-  std::vector<uint8_t> pending_input;
-  std::regex only_spaces("^[ ]*$");
-  try {
-    while (true) {
-      std::string line;
-      for (const auto& character : pending_input) {
-        if (character == '\n') {
-          if (std::regex_match(line, only_spaces)) return "";
-          else return line;
-        } 
-        line.push_back(character);
-      }
-      std::vector<uint8_t> buffer(1024ul);
-      int bytes_read = read(fd, buffer.data(), buffer.size());
-      if (bytes_read == 0) exit(EXIT_SUCCESS);
-      if (bytes_read < 0) throw std::system_error(errno, std::system_category());
-      if (buffer.empty()) {
-        if (!pending_input.empty()) {
-          for (const auto& character : pending_input) {
-            line.push_back(character);
-          }
-        }
-        pending_input.clear();
-        return line;
-      }
-      pending_input.insert(pending_input.end(), std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
-    }
-  } catch (const std::system_error& error) {
-    std::throw_with_nested(std::runtime_error("ERROR: Reading the input"));
-  }
+ssize_t ReadInput(int fd, std::string& pending_input) {
+  char buffer[4096];
+  ssize_t bytes_read;
+  do {
+    bytes_read = read(fd, buffer, sizeof(buffer));
+  } while (bytes_read < 0 && errno == EINTR);
+  if (bytes_read < 0) throw std::system_error(errno, std::system_category());
+  pending_input.append(buffer, bytes_read);
+  return bytes_read;
 }
 
+/**
+ * @brief Extrae la primera línea completa de la entrada pendiente.
+ * @param pending_input Entrada leída que todavía no se ha procesado.
+ * @param line Cadena donde se guarda la línea extraída (sin el salto de línea).
+ * 
+ * @return Verdadero si había una línea completa en la entrada pendiente.
+ */
+bool PopLine(std::string& pending_input, std::string& line) {
+  size_t end_of_line = pending_input.find('\n');
+  if (end_of_line == std::string::npos) return false;
+  line.assign(pending_input, 0, end_of_line);
+  pending_input.erase(0, end_of_line + 1);
+  if (line.find_first_not_of(" \t") == std::string::npos) line.clear();
+  return true;
+}
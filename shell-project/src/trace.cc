@@ -0,0 +1,218 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Asignatura: Sistemas Operativos
+ * Curso: 2º
+ * Práctica 2: SHELL PROJECT
+ * @autor: Valeria Bosch Pérez (alu0101485287@ull.edu.es)
+ * @date: 19 Oct 2026
+ * @file: trace.cc
+ * @brief: lifecycle tracing of the shell in Chrome trace-event format functions
+ * Referencias:
+ * Enlaces de interés
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+#include <vector>
+
+#include "fastcopy.h"
+#include "profiler.h"
+#include "trace.h"
+#include "unique_handle.h"
+
+std::atomic<bool> tracing_enabled{false};
+
+namespace {
+
+// Eventos de cada bloque del búfer de un hilo
+constexpr size_t kTraceChunkEvents = 1024;
+
+/**
+ * @brief Tramo ya terminado
+ * [+] name = nombre del tramo (una cadena literal)
+ * [+] detail = comando al que se refiere, si lo hay
+ * [+] start_ns = inicio en el reloj monotónico
+ * [+] duration_ns = duración
+ */
+struct TraceEvent {
+  const char* name = nullptr;
+  std::string detail;
+  uint64_t start_ns = 0;
+  uint64_t duration_ns = 0;
+};
+
+/**
+ * @brief Bloque de eventos de un hilo. Solo escribe el hilo dueño; publica cada evento
+ *        aumentando count después de rellenarlo, y cuando se llena encadena otro en next,
+ *        así que quien vuelca la traza puede leerlo a la vez sin cerrojos.
+ */
+struct TraceChunk {
+  std::array<TraceEvent, kTraceChunkEvents> events;
+  std::atomic<size_t> count{0};
+  std::atomic<TraceChunk*> next{nullptr};
+};
+
+/**
+ * @brief Eventos de un hilo
+ * [+] thread_id = identificador del hilo en el sistema (tid en la traza)
+ * [+] thread_name = nombre del hilo al registrarlo
+ * [+] first = primer bloque; los demás cuelgan de él y son del búfer
+ * [+] last = bloque en el que escribe el hilo (solo lo usa el hilo dueño)
+ */
+struct TraceBuffer {
+  pid_t thread_id = 0;
+  std::string thread_name;
+  TraceChunk first;
+  TraceChunk* last = &first;
+
+  ~TraceBuffer() {
+    for (TraceChunk* chunk = first.next.load(); chunk != nullptr;) {
+      TraceChunk* next = chunk->next.load();
+      delete chunk;
+      chunk = next;
+    }
+  }
+};
+
+/**
+ * @brief Estado global de la traza: el archivo de salida, el proceso que la vuelca y los
+ *        búferes de todos los hilos. El cerrojo solo se toma al registrar un hilo nuevo y al
+ *        volcar; los búferes sobreviven a sus hilos para que sus eventos lleguen a la traza.
+ */
+struct TraceRegistry {
+  std::mutex mutex;
+  std::string output_path;
+  pid_t owner_pid = 0;
+  std::vector<std::unique_ptr<TraceBuffer>> buffers;
+};
+
+TraceRegistry& Registry() {
+  static TraceRegistry registry;
+  return registry;
+}
+
+/**
+ * @brief Búfer del hilo actual; lo crea y lo registra la primera vez que el hilo guarda un evento.
+ */
+TraceBuffer& ThreadBuffer() {
+  thread_local TraceBuffer* buffer = nullptr;
+  if (buffer != nullptr) return *buffer;
+  auto new_buffer = std::make_unique<TraceBuffer>();
+  new_buffer->thread_id = gettid();
+  char name[16] = "";
+  pthread_getname_np(pthread_self(), name, sizeof(name));
+  new_buffer->thread_name = name;
+  TraceRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  buffer = new_buffer.get();
+  registry.buffers.push_back(std::move(new_buffer));
+  return *buffer;
+}
+
+/**
+ * @brief Escribe nanosegundos como los microsegundos con decimales que usa el formato de Chrome.
+ */
+void WriteMicroseconds(std::stringstream& json, uint64_t nanoseconds) {
+  json << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0') << nanoseconds % 1000;
+}
+
+}  // namespace
+
+/**
+ * @brief Activa el trazado. Los tramos se guardan en memoria y se escriben al llamar a DumpTrace.
+ * @param output_path Archivo de la traza ("-" para la salida de error).
+ */
+void EnableTracing(const std::string& output_path) {
+  TraceRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.output_path = output_path;
+  registry.owner_pid = getpid();
+  tracing_enabled.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Reloj de la traza: CLOCK_MONOTONIC en nanosegundos, el mismo que usa perf con
+ *        -k CLOCK_MONOTONIC, para poder comparar los tiempos de las dos herramientas.
+ */
+uint64_t TraceClock() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Guarda un tramo terminado en el búfer del hilo actual, sin cerrojos.
+ * @param name Nombre del tramo (una cadena literal, no se copia).
+ * @param detail Comando al que se refiere (puede estar vacío).
+ * @param start_ns Inicio según TraceClock.
+ * @param end_ns Final según TraceClock.
+ */
+void RecordSpan(const char* name, const std::string& detail, uint64_t start_ns, uint64_t end_ns) {
+  if (!IsTracing()) return;
+  TraceBuffer& buffer = ThreadBuffer();
+  TraceChunk* chunk = buffer.last;
+  size_t index = chunk->count.load(std::memory_order_relaxed);
+  if (index == kTraceChunkEvents) {
+    TraceChunk* next = new TraceChunk;
+    chunk->next.store(next, std::memory_order_release);
+    buffer.last = chunk = next;
+    index = 0;
+  }
+  TraceEvent& event = chunk->events[index];
+  event.name = name;
+  event.detail = detail;
+  event.start_ns = start_ns;
+  event.duration_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+  chunk->count.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Escribe los tramos de todos los hilos como JSON de Chrome trace-event (eventos
+ *        completos "X" más el nombre de cada hilo), que se abre directamente en Perfetto o en
+ *        chrome://tracing. Los procesos hijos que no han hecho exec no escriben nada.
+ * @throw std::system_error Si no se puede escribir el archivo.
+ */
+void DumpTrace() {
+  if (!IsTracing()) return;
+  TraceRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (getpid() != registry.owner_pid) return;
+  std::stringstream json;
+  json << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+  json << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << registry.owner_pid
+       << ", \"args\": {\"name\": \"Shell\"}}";
+  for (const auto& buffer : registry.buffers) {
+    json << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << registry.owner_pid
+         << ", \"tid\": " << buffer->thread_id << ", \"args\": {\"name\": \"" << JsonEscape(buffer->thread_name)
+         << "\"}}";
+    for (const TraceChunk* chunk = &buffer->first; chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire)) {
+      size_t count = chunk->count.load(std::memory_order_acquire);
+      for (size_t i = 0; i < count; ++i) {
+        const TraceEvent& event = chunk->events[i];
+        json << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"shell\", \"ph\": \"X\", \"ts\": ";
+        WriteMicroseconds(json, event.start_ns);
+        json << ", \"dur\": ";
+        WriteMicroseconds(json, event.duration_ns);
+        json << ", \"pid\": " << registry.owner_pid << ", \"tid\": " << buffer->thread_id;
+        if (!event.detail.empty()) json << ", \"args\": {\"command\": \"" << JsonEscape(event.detail) << "\"}";
+        json << "}";
+      }
+    }
+  }
+  json << "\n]}\n";
+  std::string trace = json.str();
+  UniqueFd file;
+  if (registry.output_path != "-") file = OpenFile(registry.output_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  WriteFile(file ? file.Get() : STDERR_FILENO, reinterpret_cast<const uint8_t*>(trace.data()), trace.size());
+}
@@ -14,6 +14,7 @@
  */
 
 #include "shell.h"
+#include "trace.h"
 #include "usages.h"
 
 /**
@@ -26,12 +27,19 @@ void Usage(const int argc, const char* argv[]) {
   try {
     if (args.size() > 1 && (args[1] == "--help" || args[1] == "-h")) {
       std::cout << "      -- SHELL --" << std::endl;
-      std::cout << "HOW TO USE: " << args[0] << std::endl;
+      std::cout << "HOW TO USE: " << args[0] << " [--profile[=file]]" << std::endl;
+      std::cout << "\n--profile: Measures every command and writes the histograms as JSON on exit\n";
+      std::cout << "           (to file, or to the standard error if no file is given)" << std::endl;
+      std::cout << "\nSHELL_TRACE=file: Records when every line is read, parsed and expanded and when every\n";
+      std::cout << "                  command is spawned, waited for or run as a builtin, and writes it on\n";
+      std::cout << "                  exit as a Chrome trace (open it in Perfetto or chrome://tracing)" << std::endl;
       std::cout << "\n     --INFORMATION ABOUT THE PROGRAM --" << std::endl;
       std::cout << "It works like a shell, but poorly :)" << std::endl;
       exit(EXIT_SUCCESS);
     } 
-    if (argc > 2 ) {
+    // Solo se admite --profile o --profile=archivo
+    bool is_profile = argc == 2 && (args[1] == "--profile" || (args[1].rfind("--profile=", 0) == 0 && args[1].size() > 10));
+    if (argc > 2 || (argc == 2 && !is_profile)) {
       std::filesystem::path exe_path = args[0];
       std::stringstream error_message;
       error_message << exe_path.filename().generic_string() << ": Invalid number of arguments!";
@@ -67,6 +75,10 @@ void Program(const int argc, const char* argv[]) {
   try {
     system("clear");
     Shell shell(0);
+    if (const char* trace_path = getenv("SHELL_TRACE"); trace_path != nullptr && *trace_path != '\0') {
+      EnableTracing(trace_path);
+    }
+    if (args.size() == 2) shell.EnableProfiling(args[1] == "--profile" ? "-" : args[1].substr(10));
     shell.Run();
   } catch(...) {
     std::stringstream error;